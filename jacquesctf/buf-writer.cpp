@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <unistd.h>
+
+#include "buf-writer.hpp"
+#include "io-error.hpp"
+
+namespace jacques {
+
+BufWriter::BufWriter(const int fd, boost::filesystem::path path, const Size bufSize) :
+    _fd {fd},
+    _path {std::move(path)},
+    _buf(bufSize)
+{
+}
+
+BufWriter::~BufWriter()
+{
+    try {
+        this->flush();
+    } catch (...) {
+    }
+}
+
+void BufWriter::flush()
+{
+    const auto len = _len;
+
+    // reset first so that a failed flush isn't retried on destruction
+    _len = 0;
+    this->_writeAll(_buf.data(), len);
+}
+
+void BufWriter::_writeSlow(const char * const data, const Size size)
+{
+    this->flush();
+
+    if (size >= _buf.size()) {
+        // larger than the buffer: no need to copy
+        this->_writeAll(data, size);
+        return;
+    }
+
+    std::memcpy(_buf.data(), data, size);
+    _len = size;
+}
+
+void BufWriter::_writeAll(const char *data, Size size)
+{
+    while (size > 0) {
+        const auto ret = ::write(_fd, data, size);
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            std::ostringstream ss;
+
+            ss << "Cannot write to `" << _path.string() << "`: " << std::strerror(errno) << ".";
+            throw IOError {_path, ss.str()};
+        }
+
+        data += ret;
+        size -= static_cast<Size>(ret);
+    }
+}
+
+} // namespace jacques
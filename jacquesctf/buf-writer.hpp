@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_BUF_WRITER_HPP
+#define _JACQUES_BUF_WRITER_HPP
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <boost/filesystem.hpp>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Large buffered writer to a file descriptor.
+ *
+ * A buffered writer only calls write(2) when its buffer is full, or
+ * on flush(), instead of formatting through `std::cout` and flushing
+ * at each `std::endl`.
+ *
+ * `path` is only used to report errors (see IOError).
+ */
+class BufWriter final :
+    boost::noncopyable
+{
+public:
+    explicit BufWriter(int fd, boost::filesystem::path path, Size bufSize = 1 << 20);
+
+    // flushes, ignoring any error: call flush() to catch errors
+    ~BufWriter();
+
+    void write(const char *data, Size size)
+    {
+        if (_buf.size() - _len < size) {
+            this->_writeSlow(data, size);
+            return;
+        }
+
+        std::memcpy(_buf.data() + _len, data, size);
+        _len += size;
+    }
+
+    void write(const std::string& str)
+    {
+        this->write(str.data(), str.size());
+    }
+
+    void flush();
+
+private:
+    void _writeSlow(const char *data, Size size);
+    void _writeAll(const char *data, Size size);
+
+private:
+    const int _fd;
+    const boost::filesystem::path _path;
+    std::vector<char> _buf;
+    Size _len = 0;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_BUF_WRITER_HPP
@@ -15,9 +15,12 @@
 #include <unordered_set>
 #include <iostream>
 #include <cassert>
+#include <limits>
+#include <utility>
 
 #include "cfg.hpp"
 #include "utils.hpp"
+#include "pkt-filter.hpp"
 
 namespace jacques {
 
@@ -44,10 +47,22 @@ PrintMetadataTextCfg::PrintMetadataTextCfg(bfs::path path) :
 {
 }
 
-ListPktsCfg::ListPktsCfg(bfs::path path, Fmt fmt, bool withHeader) :
-    SinglePathCfg {std::move(path)},
+ListPktsCfg::ListPktsCfg(std::vector<bfs::path> paths, Fmt fmt, bool withHeader,
+                         boost::optional<std::string> whereExpr) :
+    _paths {std::move(paths)},
     _fmt {fmt},
-    _withHeader {withHeader}
+    _withHeader {withHeader},
+    _whereExpr {std::move(whereExpr)}
+{
+}
+
+ListErsCfg::ListErsCfg(std::vector<bfs::path> paths, const Fmt fmt, const bool withHeader,
+                       const bool withPayload, const bool timeOrder) :
+    _paths {std::move(paths)},
+    _fmt {fmt},
+    _withHeader {withHeader},
+    _withPayload {withPayload},
+    _timeOrder {timeOrder}
 {
 }
 
@@ -58,8 +73,82 @@ CopyPktsCfg::CopyPktsCfg(bfs::path srcPath, std::string pktIndexes, bfs::path ds
 {
 }
 
-CreateLttngIndexCfg::CreateLttngIndexCfg(std::vector<bfs::path> paths) :
-    _paths {std::move(paths)}
+StatsCfg::StatsCfg(std::vector<bfs::path> paths, const Fmt fmt, const Size sampleStep) :
+    _paths {std::move(paths)},
+    _fmt {fmt},
+    _sampleStep {sampleStep}
+{
+}
+
+CheckCfg::CheckCfg(std::vector<bfs::path> paths, const Fmt fmt, const bool failFast) :
+    _paths {std::move(paths)},
+    _fmt {fmt},
+    _failFast {failFast}
+{
+}
+
+DiffPktsCfg::DiffPktsCfg(bfs::path pathA, bfs::path pathB, const Align align, const Fmt fmt) :
+    _pathA {std::move(pathA)},
+    _pathB {std::move(pathB)},
+    _align {align},
+    _fmt {fmt}
+{
+}
+
+MergePktsCfg::MergePktsCfg(std::vector<bfs::path> srcPaths, const Order order,
+                           const bool dropDups, bfs::path dstPath) :
+    _srcPaths {std::move(srcPaths)},
+    _order {order},
+    _dropDups {dropDups},
+    _dstPath {std::move(dstPath)}
+{
+}
+
+QueryCfg::QueryCfg(std::vector<bfs::path> paths, std::vector<std::string> queries,
+                   const Fmt fmt, const bool findAll) :
+    _paths {std::move(paths)},
+    _queries {std::move(queries)},
+    _fmt {fmt},
+    _findAll {findAll}
+{
+}
+
+ServeCfg::ServeCfg(std::vector<bfs::path> paths, bfs::path socketPath, const Size memBudget) :
+    _paths {std::move(paths)},
+    _socketPath {std::move(socketPath)},
+    _memBudget {memBudget}
+{
+}
+
+ExportColumnarCfg::ExportColumnarCfg(std::vector<bfs::path> paths, bfs::path dstDirPath) :
+    _paths {std::move(paths)},
+    _dstDirPath {std::move(dstDirPath)}
+{
+}
+
+SplitCfg::SplitCfg(bfs::path srcPath, bfs::path dstDir, boost::optional<Size> maxSizeBytes,
+                   boost::optional<Size> maxPktCount, boost::optional<long long> maxDurationNs) :
+    _srcPath {std::move(srcPath)},
+    _dstDir {std::move(dstDir)},
+    _maxSizeBytes {std::move(maxSizeBytes)},
+    _maxPktCount {std::move(maxPktCount)},
+    _maxDurationNs {std::move(maxDurationNs)}
+{
+}
+
+SliceCfg::SliceCfg(std::vector<bfs::path> paths, const Unit unit, const long long begin,
+                   const long long end, bfs::path dstDir) :
+    _paths {std::move(paths)},
+    _unit {unit},
+    _begin {begin},
+    _end {end},
+    _dstDir {std::move(dstDir)}
+{
+}
+
+CreateLttngIndexCfg::CreateLttngIndexCfg(std::vector<bfs::path> paths, const bool force) :
+    _paths {std::move(paths)},
+    _force {force}
 {
 }
 
@@ -207,6 +296,7 @@ std::unique_ptr<const Cfg> createLttngIndexCfgFromArgs(const std::vector<std::st
     bpo::options_description optDescr {""};
 
     optDescr.add_options()
+        ("force", "")
         ("paths", bpo::value<std::vector<std::string>>(), "");
 
     bpo::positional_options_description posDesc;
@@ -225,7 +315,8 @@ std::unique_ptr<const Cfg> createLttngIndexCfgFromArgs(const std::vector<std::st
 
     auto expandedPaths = getExpandedPaths(vm["paths"].as<std::vector<std::string>>());
 
-    return std::make_unique<CreateLttngIndexCfg>(std::move(expandedPaths));
+    return std::make_unique<CreateLttngIndexCfg>(std::move(expandedPaths),
+                                                 vm.count("force") == 1);
 }
 
 void checkLooksLikeDsFile(const bfs::path& path)
@@ -251,12 +342,15 @@ std::unique_ptr<const Cfg> listPktsCfgFromArgs(const std::vector<std::string>& a
 
     optDescr.add_options()
         ("machine,m", "")
+        ("json", "")
+        ("binary", "")
         ("header", "")
-        ("path", bpo::value<std::string>(), "");
+        ("where", bpo::value<std::string>(), "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
 
     bpo::positional_options_description posDesc;
 
-    posDesc.add("path", 1);
+    posDesc.add("paths", -1);
 
     bpo::variables_map vm;
 
@@ -268,21 +362,105 @@ std::unique_ptr<const Cfg> listPktsCfgFromArgs(const std::vector<std::string>& a
         std::abort();
     }
 
-    if (vm.count("machine") == 0) {
+    const auto fmtCount = vm.count("machine") + vm.count("json") + vm.count("binary");
+
+    if (fmtCount == 0) {
         throw CliError {
-            "Missing --machine option (required by this version)."
+            "Missing --machine, --json, or --binary option (required by this version)."
         };
     }
 
-    if (vm.count("path") == 0) {
-        throw CliError {"Missing data stream file path."};
+    if (fmtCount > 1) {
+        throw CliError {"Can only specify one of --machine, --json, and --binary."};
+    }
+
+    auto fmt = ListPktsCfg::Fmt::MACHINE;
+
+    if (vm.count("json") == 1) {
+        fmt = ListPktsCfg::Fmt::JSON_LINES;
+    } else if (vm.count("binary") == 1) {
+        fmt = ListPktsCfg::Fmt::BINARY;
+    }
+
+    if (fmt != ListPktsCfg::Fmt::MACHINE && vm.count("header") == 1) {
+        throw CliError {"Can only specify --header with --machine."};
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
+
+    for (const auto& path : expandedPaths) {
+        checkLooksLikeDsFile(path);
+    }
+
+    boost::optional<std::string> whereExpr;
+
+    if (vm.count("where") == 1) {
+        whereExpr = vm["where"].as<std::string>();
+
+        // validate now
+        try {
+            PktFilter {*whereExpr};
+        } catch (const PktFilterError& exc) {
+            std::ostringstream ss;
+
+            ss << "Invalid --where expression: " << exc.what();
+            throw CliError {ss.str()};
+        }
+    }
+
+    return std::make_unique<ListPktsCfg>(std::move(expandedPaths), fmt, vm.count("header") == 1,
+                                         std::move(whereExpr));
+}
+
+std::unique_ptr<const Cfg> listErsCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("json", "")
+        ("header", "")
+        ("payload", "")
+        ("time-order", "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    const auto fmt = vm.count("json") == 1 ? ListErsCfg::Fmt::JSON_LINES : ListErsCfg::Fmt::CSV;
+
+    if (fmt == ListErsCfg::Fmt::JSON_LINES && vm.count("header") == 1) {
+        throw CliError {"Cannot specify --header with --json."};
+    }
+
+    if (vm.count("payload") == 1 && vm.count("time-order") == 1) {
+        throw CliError {"Cannot specify --payload with --time-order."};
     }
 
-    auto path = bfs::path {vm["path"].as<std::string>()};
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
 
-    checkLooksLikeDsFile(path);
-    return std::make_unique<ListPktsCfg>(std::move(path), ListPktsCfg::Fmt::MACHINE,
-                                         vm.count("header") == 1);
+    return std::make_unique<ListErsCfg>(std::move(expandedPaths), fmt, vm.count("header") == 1,
+                                        vm.count("payload") == 1, vm.count("time-order") == 1);
 }
 
 std::unique_ptr<const Cfg> copyPktsCfgFromArgs(const std::vector<std::string>& args)
@@ -342,6 +520,569 @@ std::unique_ptr<const Cfg> copyPktsCfgFromArgs(const std::vector<std::string>& a
                                          std::move(dstPath));
 }
 
+std::unique_ptr<const Cfg> statsCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("csv", "")
+        ("sample", bpo::value<unsigned long long>(), "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    Size sampleStep = 1;
+
+    if (vm.count("sample") == 1) {
+        sampleStep = vm["sample"].as<unsigned long long>();
+
+        if (sampleStep == 0) {
+            throw CliError {"Packet sampling step must be greater than 0."};
+        }
+    }
+
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
+
+    return std::make_unique<StatsCfg>(std::move(expandedPaths),
+                                      vm.count("csv") == 1 ? StatsCfg::Fmt::CSV :
+                                      StatsCfg::Fmt::TEXT, sampleStep);
+}
+
+std::unique_ptr<const Cfg> checkCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("json", "")
+        ("fail-fast", "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
+
+    return std::make_unique<CheckCfg>(std::move(expandedPaths),
+                                      vm.count("json") == 1 ? CheckCfg::Fmt::JSON_LINES :
+                                      CheckCfg::Fmt::CSV, vm.count("fail-fast") == 1);
+}
+
+std::unique_ptr<const Cfg> diffPktsCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("align", bpo::value<std::string>(), "")
+        ("json", "")
+        ("path-a", bpo::value<std::string>(), "")
+        ("path-b", bpo::value<std::string>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("path-a", 1).add("path-b", 1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("path-a") == 0 || vm.count("path-b") == 0) {
+        throw CliError {"Missing data stream file paths."};
+    }
+
+    auto align = DiffPktsCfg::Align::AUTO;
+
+    if (vm.count("align") == 1) {
+        const auto& alignStr = vm["align"].as<std::string>();
+
+        if (alignStr == "seq-num") {
+            align = DiffPktsCfg::Align::SEQ_NUM;
+        } else if (alignStr == "ts") {
+            align = DiffPktsCfg::Align::TS;
+        } else if (alignStr == "index") {
+            align = DiffPktsCfg::Align::INDEX;
+        } else {
+            std::ostringstream ss;
+
+            ss << "Invalid packet alignment `" << alignStr << "` (expecting `seq-num`, " <<
+                  "`ts`, or `index`).";
+            throw CliError {ss.str()};
+        }
+    }
+
+    auto pathA = bfs::path {vm["path-a"].as<std::string>()};
+    auto pathB = bfs::path {vm["path-b"].as<std::string>()};
+
+    checkLooksLikeDsFile(pathA);
+    checkLooksLikeDsFile(pathB);
+
+    return std::make_unique<DiffPktsCfg>(std::move(pathA), std::move(pathB), align,
+                                         vm.count("json") == 1 ?
+                                         DiffPktsCfg::Fmt::JSON_LINES : DiffPktsCfg::Fmt::CSV);
+}
+
+std::unique_ptr<const Cfg> mergePktsCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("order", bpo::value<std::string>(), "")
+        ("drop-duplicates", "")
+        ("dst-path", bpo::value<std::string>(), "")
+        ("src-paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("dst-path", 1).add("src-paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("dst-path") == 0) {
+        throw CliError {"Missing destination data stream file path."};
+    }
+
+    if (vm.count("src-paths") == 0) {
+        throw CliError {"Missing source data stream file paths."};
+    }
+
+    auto order = MergePktsCfg::Order::AUTO;
+
+    if (vm.count("order") == 1) {
+        const auto& orderStr = vm["order"].as<std::string>();
+
+        if (orderStr == "seq-num") {
+            order = MergePktsCfg::Order::SEQ_NUM;
+        } else if (orderStr == "ts") {
+            order = MergePktsCfg::Order::TS;
+        } else {
+            std::ostringstream ss;
+
+            ss << "Invalid packet order `" << orderStr << "` (expecting `seq-num` or `ts`).";
+            throw CliError {ss.str()};
+        }
+    }
+
+    auto dstPath = bfs::path {vm["dst-path"].as<std::string>()};
+    std::vector<bfs::path> srcPaths;
+
+    if (bfs::exists(dstPath)) {
+        checkLooksLikeDsFile(dstPath);
+    }
+
+    for (const auto& srcPathStr : vm["src-paths"].as<std::vector<std::string>>()) {
+        auto srcPath = bfs::path {srcPathStr};
+
+        checkLooksLikeDsFile(srcPath);
+
+        if (bfs::exists(dstPath) && bfs::equivalent(srcPath, dstPath)) {
+            std::ostringstream ss;
+
+            ss << "Source and destination data stream files are the same: `" <<
+                  srcPath.string() << "`.";
+            throw CliError {ss.str()};
+        }
+
+        srcPaths.push_back(std::move(srcPath));
+    }
+
+    return std::make_unique<MergePktsCfg>(std::move(srcPaths), order,
+                                          vm.count("drop-duplicates") == 1, std::move(dstPath));
+}
+
+std::unique_ptr<const Cfg> queryCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("query,e", bpo::value<std::vector<std::string>>(), "")
+        ("all", "")
+        ("json", "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    std::vector<std::string> queries;
+
+    if (vm.count("query") == 1) {
+        queries = vm["query"].as<std::vector<std::string>>();
+    }
+
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
+
+    return std::make_unique<QueryCfg>(std::move(expandedPaths), std::move(queries),
+                                      vm.count("json") == 1 ? QueryCfg::Fmt::JSON_LINES :
+                                      QueryCfg::Fmt::CSV, vm.count("all") == 1);
+}
+
+std::unique_ptr<const Cfg> serveCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("mem-budget", bpo::value<unsigned long long>(), "")
+        ("socket-path", bpo::value<std::string>(), "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("socket-path", 1).add("paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("socket-path") == 0) {
+        throw CliError {"Missing socket path."};
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    // MiB
+    Size memBudget = 512;
+
+    if (vm.count("mem-budget") == 1) {
+        memBudget = vm["mem-budget"].as<unsigned long long>();
+    }
+
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
+
+    return std::make_unique<ServeCfg>(std::move(expandedPaths),
+                                      vm["socket-path"].as<std::string>(),
+                                      memBudget * 1024 * 1024);
+}
+
+std::unique_ptr<const Cfg> exportColumnarCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("dst-dir-path", bpo::value<std::string>(), "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("dst-dir-path", 1).add("paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("dst-dir-path") == 0) {
+        throw CliError {"Missing output directory path."};
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
+
+    return std::make_unique<ExportColumnarCfg>(std::move(expandedPaths),
+                                               vm["dst-dir-path"].as<std::string>());
+}
+
+/*
+ * Parses the split limit `str`, an unsigned integer optionally
+ * followed by one of the suffixes of `suffixes`, multiplying it by the
+ * factor of its suffix.
+ */
+unsigned long long parseSplitLimit(const std::string& str, const std::string& what,
+                                   const std::vector<std::pair<std::string,
+                                                               unsigned long long>>& suffixes)
+{
+    std::size_t pos = 0;
+    unsigned long long val = 0;
+
+    try {
+        if (str.find('-') == std::string::npos) {
+            val = std::stoull(str, &pos);
+        }
+    } catch (const std::logic_error&) {
+        pos = 0;
+    }
+
+    if (pos > 0 && pos < str.size()) {
+        const auto suffix = str.substr(pos);
+        const auto it = std::find_if(suffixes.begin(), suffixes.end(),
+                                     [&suffix](const auto& pair) {
+            return pair.first == suffix;
+        });
+
+        if (it == suffixes.end() ||
+                val > std::numeric_limits<long long>::max() / it->second) {
+            pos = 0;
+        } else {
+            val *= it->second;
+            pos = str.size();
+        }
+    }
+
+    if (pos == 0 || pos != str.size() || val == 0 ||
+            val > static_cast<unsigned long long>(std::numeric_limits<long long>::max())) {
+        std::ostringstream ss;
+
+        ss << "Invalid " << what << ": `" << str << "`.";
+        throw CliError {ss.str()};
+    }
+
+    return val;
+}
+
+std::unique_ptr<const Cfg> splitCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("max-size", bpo::value<std::string>(), "")
+        ("max-packets", bpo::value<std::string>(), "")
+        ("max-duration", bpo::value<std::string>(), "")
+        ("dst-dir", bpo::value<std::string>(), "")
+        ("src-path", bpo::value<std::string>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("dst-dir", 1).add("src-path", 1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("max-size") == 0 && vm.count("max-packets") == 0 &&
+            vm.count("max-duration") == 0) {
+        throw CliError {"Missing --max-size, --max-packets, or --max-duration option."};
+    }
+
+    if (vm.count("dst-dir") == 0) {
+        throw CliError {"Missing destination directory path."};
+    }
+
+    if (vm.count("src-path") == 0) {
+        throw CliError {"Missing source data stream file path."};
+    }
+
+    boost::optional<Size> maxSizeBytes;
+    boost::optional<Size> maxPktCount;
+    boost::optional<long long> maxDurationNs;
+
+    if (vm.count("max-size") == 1) {
+        maxSizeBytes = parseSplitLimit(vm["max-size"].as<std::string>(), "maximum size", {
+            {"K", 1ULL << 10}, {"M", 1ULL << 20}, {"G", 1ULL << 30},
+        });
+    }
+
+    if (vm.count("max-packets") == 1) {
+        maxPktCount = parseSplitLimit(vm["max-packets"].as<std::string>(),
+                                      "maximum packet count", {});
+    }
+
+    if (vm.count("max-duration") == 1) {
+        maxDurationNs = parseSplitLimit(vm["max-duration"].as<std::string>(),
+                                        "maximum duration", {
+            {"ns", 1ULL}, {"us", 1000ULL}, {"ms", 1000000ULL}, {"s", 1000000000ULL},
+        });
+    }
+
+    auto srcPath = bfs::path {vm["src-path"].as<std::string>()};
+    auto dstDir = bfs::path {vm["dst-dir"].as<std::string>()};
+
+    checkLooksLikeDsFile(srcPath);
+
+    if (bfs::exists(dstDir) && (!bfs::is_directory(dstDir) || !bfs::is_empty(dstDir))) {
+        std::ostringstream ss;
+
+        ss << "Destination `" << dstDir.string() << "` exists and is not an empty directory.";
+        throw CliError {ss.str()};
+    }
+
+    return std::make_unique<SplitCfg>(std::move(srcPath), std::move(dstDir), maxSizeBytes,
+                                      maxPktCount, maxDurationNs);
+}
+
+long long parseSliceTime(const std::string& str, const SliceCfg::Unit unit)
+{
+    std::size_t pos;
+    long long val;
+
+    try {
+        if (unit == SliceCfg::Unit::CYCLES) {
+            if (str.find('-') != std::string::npos) {
+                throw std::invalid_argument {str};
+            }
+
+            const auto cycles = std::stoull(str, &pos);
+
+            if (cycles > static_cast<unsigned long long>(std::numeric_limits<long long>::max())) {
+                throw std::out_of_range {str};
+            }
+
+            val = static_cast<long long>(cycles);
+        } else {
+            val = std::stoll(str, &pos);
+        }
+    } catch (const std::logic_error&) {
+        pos = 0;
+    }
+
+    if (pos == 0 || pos != str.size()) {
+        std::ostringstream ss;
+
+        ss << "Invalid time: `" << str << "`.";
+        throw CliError {ss.str()};
+    }
+
+    return val;
+}
+
+std::unique_ptr<const Cfg> sliceCfgFromArgs(const std::vector<std::string>& args)
+{
+    bpo::options_description optDescr {""};
+
+    optDescr.add_options()
+        ("cycles", "")
+        ("begin", bpo::value<std::string>(), "")
+        ("end", bpo::value<std::string>(), "")
+        ("dst-dir", bpo::value<std::string>(), "")
+        ("paths", bpo::value<std::vector<std::string>>(), "");
+
+    bpo::positional_options_description posDesc;
+
+    posDesc.add("begin", 1).add("end", 1).add("dst-dir", 1).add("paths", -1);
+
+    bpo::variables_map vm;
+
+    try {
+        bpo::store(bpo::command_line_parser(args).options(optDescr).positional(posDesc).run(), vm);
+    } catch (const bpo::error& exc) {
+        throw CliError {exc.what()};
+    } catch (...) {
+        std::abort();
+    }
+
+    if (vm.count("begin") == 0) {
+        throw CliError {"Missing beginning time."};
+    }
+
+    if (vm.count("end") == 0) {
+        throw CliError {"Missing end time."};
+    }
+
+    if (vm.count("dst-dir") == 0) {
+        throw CliError {"Missing destination directory path."};
+    }
+
+    if (vm.count("paths") == 0) {
+        throw CliError {"Missing trace directory path or data stream file path."};
+    }
+
+    const auto unit = vm.count("cycles") == 1 ? SliceCfg::Unit::CYCLES : SliceCfg::Unit::NS;
+    const auto begin = parseSliceTime(vm["begin"].as<std::string>(), unit);
+    const auto end = parseSliceTime(vm["end"].as<std::string>(), unit);
+
+    if (begin > end) {
+        throw CliError {"Beginning time is greater than end time."};
+    }
+
+    auto dstDir = bfs::path {vm["dst-dir"].as<std::string>()};
+
+    if (bfs::exists(dstDir) && (!bfs::is_directory(dstDir) || !bfs::is_empty(dstDir))) {
+        std::ostringstream ss;
+
+        ss << "Destination `" << dstDir.string() << "` exists and is not an empty directory.";
+        throw CliError {ss.str()};
+    }
+
+    const auto& pathArgs = vm["paths"].as<std::vector<std::string>>();
+    auto expandedPaths = expandPaths({pathArgs.begin(), pathArgs.end()}, false);
+
+    return std::make_unique<SliceCfg>(std::move(expandedPaths), unit, begin, end,
+                                      std::move(dstDir));
+}
+
 } // namespace
 
 std::unique_ptr<const Cfg> cfgFromArgs(const int argc, const char *argv[])
@@ -383,11 +1124,26 @@ std::unique_ptr<const Cfg> cfgFromArgs(const int argc, const char *argv[])
 
         auto removeCmdName = false;
         constexpr const char *listPktsCmdName = "list-packets";
+        constexpr const char *listErsCmdName = "list-events";
         constexpr const char *copyPktsCmdName = "copy-packets";
         constexpr const char *createLttngIndexCmdName = "create-lttng-index";
-
-        if (args[0] == "inspect" || args[0] == listPktsCmdName ||
-                args[0] == copyPktsCmdName || args[0] == createLttngIndexCmdName) {
+        constexpr const char *sliceCmdName = "slice";
+        constexpr const char *statsCmdName = "stats";
+        constexpr const char *checkCmdName = "check";
+        constexpr const char *diffPktsCmdName = "diff-packets";
+        constexpr const char *mergePktsCmdName = "merge-packets";
+        constexpr const char *queryCmdName = "query";
+        constexpr const char *serveCmdName = "serve";
+        constexpr const char *exportColumnarCmdName = "export-columnar";
+        constexpr const char *splitCmdName = "split";
+
+        if (args[0] == "inspect" || args[0] == listPktsCmdName || args[0] == listErsCmdName ||
+                args[0] == copyPktsCmdName || args[0] == createLttngIndexCmdName ||
+                args[0] == sliceCmdName || args[0] == statsCmdName ||
+                args[0] == checkCmdName || args[0] == diffPktsCmdName ||
+                args[0] == mergePktsCmdName || args[0] == queryCmdName ||
+                args[0] == serveCmdName || args[0] == exportColumnarCmdName ||
+                args[0] == splitCmdName) {
             removeCmdName = true;
         }
 
@@ -400,10 +1156,30 @@ std::unique_ptr<const Cfg> cfgFromArgs(const int argc, const char *argv[])
 
         if (args[0] == listPktsCmdName) {
             return listPktsCfgFromArgs(extraArgs);
+        } else if (args[0] == listErsCmdName) {
+            return listErsCfgFromArgs(extraArgs);
         } else if (args[0] == copyPktsCmdName) {
             return copyPktsCfgFromArgs(extraArgs);
         } else if (args[0] == createLttngIndexCmdName) {
             return createLttngIndexCfgFromArgs(extraArgs);
+        } else if (args[0] == sliceCmdName) {
+            return sliceCfgFromArgs(extraArgs);
+        } else if (args[0] == statsCmdName) {
+            return statsCfgFromArgs(extraArgs);
+        } else if (args[0] == checkCmdName) {
+            return checkCfgFromArgs(extraArgs);
+        } else if (args[0] == diffPktsCmdName) {
+            return diffPktsCfgFromArgs(extraArgs);
+        } else if (args[0] == mergePktsCmdName) {
+            return mergePktsCfgFromArgs(extraArgs);
+        } else if (args[0] == queryCmdName) {
+            return queryCfgFromArgs(extraArgs);
+        } else if (args[0] == serveCmdName) {
+            return serveCfgFromArgs(extraArgs);
+        } else if (args[0] == exportColumnarCmdName) {
+            return exportColumnarCfgFromArgs(extraArgs);
+        } else if (args[0] == splitCmdName) {
+            return splitCfgFromArgs(extraArgs);
         }
 
         // `inspect` command is the default
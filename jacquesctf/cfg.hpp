@@ -13,6 +13,9 @@
 #include <memory>
 #include <stdexcept>
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include "aliases.hpp"
 
 namespace jacques {
 
@@ -78,15 +81,67 @@ public:
 };
 
 class ListPktsCfg final :
-    public SinglePathCfg
+    public Cfg
 {
 public:
     enum class Fmt {
         MACHINE,
+        JSON_LINES,
+        BINARY,
+    };
+
+public:
+    /*
+     * If `whereExpr` is set, only list the packets satisfying this
+     * packet filter expression (see `PktFilter`).
+     */
+    explicit ListPktsCfg(std::vector<boost::filesystem::path> paths, Fmt format,
+                         bool withHeader, boost::optional<std::string> whereExpr = boost::none);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    Fmt format() const noexcept
+    {
+        return _fmt;
+    }
+
+    bool withHeader() const noexcept
+    {
+        return _withHeader;
+    }
+
+    const boost::optional<std::string>& whereExpr() const noexcept
+    {
+        return _whereExpr;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _paths;
+    Fmt _fmt;
+    bool _withHeader;
+    boost::optional<std::string> _whereExpr;
+};
+
+class ListErsCfg final :
+    public Cfg
+{
+public:
+    enum class Fmt {
+        CSV,
+        JSON_LINES,
     };
 
 public:
-    explicit ListPktsCfg(boost::filesystem::path path, Fmt format, bool withHeader);
+    explicit ListErsCfg(std::vector<boost::filesystem::path> paths, Fmt fmt, bool withHeader,
+                        bool withPayload, bool timeOrder);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
 
     Fmt format() const noexcept
     {
@@ -98,9 +153,22 @@ public:
         return _withHeader;
     }
 
+    bool withPayload() const noexcept
+    {
+        return _withPayload;
+    }
+
+    bool timeOrder() const noexcept
+    {
+        return _timeOrder;
+    }
+
 private:
+    const std::vector<boost::filesystem::path> _paths;
     Fmt _fmt;
     bool _withHeader;
+    bool _withPayload;
+    bool _timeOrder;
 };
 
 class CopyPktsCfg final :
@@ -131,19 +199,401 @@ private:
     boost::filesystem::path _dstPath;
 };
 
+class StatsCfg final :
+    public Cfg
+{
+public:
+    enum class Fmt {
+        TEXT,
+        CSV,
+    };
+
+public:
+    /*
+     * `sampleStep` is 1 to decode all the packets, or N to only decode
+     * one packet out of N of each data stream file and extrapolate.
+     */
+    explicit StatsCfg(std::vector<boost::filesystem::path> paths, Fmt fmt, Size sampleStep);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    Fmt format() const noexcept
+    {
+        return _fmt;
+    }
+
+    Size sampleStep() const noexcept
+    {
+        return _sampleStep;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _paths;
+    Fmt _fmt;
+    Size _sampleStep;
+};
+
+class CheckCfg final :
+    public Cfg
+{
+public:
+    enum class Fmt {
+        CSV,
+        JSON_LINES,
+    };
+
+public:
+    explicit CheckCfg(std::vector<boost::filesystem::path> paths, Fmt fmt, bool failFast);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    Fmt format() const noexcept
+    {
+        return _fmt;
+    }
+
+    bool failFast() const noexcept
+    {
+        return _failFast;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _paths;
+    Fmt _fmt;
+    bool _failFast;
+};
+
+class DiffPktsCfg final :
+    public Cfg
+{
+public:
+    // how to pair the packets of both data stream files
+    enum class Align {
+        // sequence number if available, otherwise beginning timestamp, otherwise index
+        AUTO,
+        SEQ_NUM,
+        TS,
+        INDEX,
+    };
+
+    enum class Fmt {
+        CSV,
+        JSON_LINES,
+    };
+
+public:
+    explicit DiffPktsCfg(boost::filesystem::path pathA, boost::filesystem::path pathB,
+                         Align align, Fmt fmt);
+
+    const boost::filesystem::path& pathA() const noexcept
+    {
+        return _pathA;
+    }
+
+    const boost::filesystem::path& pathB() const noexcept
+    {
+        return _pathB;
+    }
+
+    Align align() const noexcept
+    {
+        return _align;
+    }
+
+    Fmt format() const noexcept
+    {
+        return _fmt;
+    }
+
+private:
+    boost::filesystem::path _pathA;
+    boost::filesystem::path _pathB;
+    Align _align;
+    Fmt _fmt;
+};
+
+class MergePktsCfg final :
+    public Cfg
+{
+public:
+    // how to order the packets
+    enum class Order {
+        // sequence number if available, otherwise beginning timestamp
+        AUTO,
+        SEQ_NUM,
+        TS,
+    };
+
+public:
+    explicit MergePktsCfg(std::vector<boost::filesystem::path> srcPaths, Order order,
+                          bool dropDups, boost::filesystem::path dstPath);
+
+    const std::vector<boost::filesystem::path>& srcPaths() const noexcept
+    {
+        return _srcPaths;
+    }
+
+    Order order() const noexcept
+    {
+        return _order;
+    }
+
+    /*
+     * `true` to only keep the first packet having a given sequence
+     * number instead of failing.
+     */
+    bool dropDups() const noexcept
+    {
+        return _dropDups;
+    }
+
+    const boost::filesystem::path& dstPath() const noexcept
+    {
+        return _dstPath;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _srcPaths;
+    Order _order;
+    bool _dropDups;
+    boost::filesystem::path _dstPath;
+};
+
+class QueryCfg final :
+    public Cfg
+{
+public:
+    enum class Fmt {
+        CSV,
+        JSON_LINES,
+    };
+
+public:
+    /*
+     * If `queries` is empty, the command reads the queries from the
+     * standard input, one per line.
+     */
+    explicit QueryCfg(std::vector<boost::filesystem::path> paths, std::vector<std::string> queries,
+                      Fmt fmt, bool findAll);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    const std::vector<std::string>& queries() const noexcept
+    {
+        return _queries;
+    }
+
+    Fmt format() const noexcept
+    {
+        return _fmt;
+    }
+
+    /*
+     * `true` to print all the event records matching each query
+     * instead of going to the next match.
+     */
+    bool findAll() const noexcept
+    {
+        return _findAll;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _paths;
+    const std::vector<std::string> _queries;
+    Fmt _fmt;
+    bool _findAll;
+};
+
+class ServeCfg final :
+    public Cfg
+{
+public:
+    /*
+     * `memBudget` is the maximum total size (bytes) of the packets
+     * which the server keeps decoded in memory.
+     */
+    explicit ServeCfg(std::vector<boost::filesystem::path> paths,
+                      boost::filesystem::path socketPath, Size memBudget);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    const boost::filesystem::path& socketPath() const noexcept
+    {
+        return _socketPath;
+    }
+
+    Size memBudget() const noexcept
+    {
+        return _memBudget;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _paths;
+    boost::filesystem::path _socketPath;
+    Size _memBudget;
+};
+
+class ExportColumnarCfg final :
+    public Cfg
+{
+public:
+    explicit ExportColumnarCfg(std::vector<boost::filesystem::path> paths,
+                               boost::filesystem::path dstDirPath);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    const boost::filesystem::path& dstDirPath() const noexcept
+    {
+        return _dstDirPath;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _paths;
+    boost::filesystem::path _dstDirPath;
+};
+
+class SplitCfg final :
+    public Cfg
+{
+public:
+    /*
+     * At least one of `maxSizeBytes`, `maxPktCount`, and
+     * `maxDurationNs` must be set.
+     */
+    explicit SplitCfg(boost::filesystem::path srcPath, boost::filesystem::path dstDir,
+                      boost::optional<Size> maxSizeBytes, boost::optional<Size> maxPktCount,
+                      boost::optional<long long> maxDurationNs);
+
+    const boost::filesystem::path& srcPath() const noexcept
+    {
+        return _srcPath;
+    }
+
+    const boost::filesystem::path& dstDir() const noexcept
+    {
+        return _dstDir;
+    }
+
+    /*
+     * Maximum size of an output data stream file, unless a single
+     * packet is larger.
+     */
+    const boost::optional<Size>& maxSizeBytes() const noexcept
+    {
+        return _maxSizeBytes;
+    }
+
+    // maximum packet count of an output data stream file
+    const boost::optional<Size>& maxPktCount() const noexcept
+    {
+        return _maxPktCount;
+    }
+
+    /*
+     * Maximum duration between the beginning of the first packet and
+     * the end of the last packet of an output data stream file.
+     */
+    const boost::optional<long long>& maxDurationNs() const noexcept
+    {
+        return _maxDurationNs;
+    }
+
+private:
+    const boost::filesystem::path _srcPath;
+    const boost::filesystem::path _dstDir;
+    const boost::optional<Size> _maxSizeBytes;
+    const boost::optional<Size> _maxPktCount;
+    const boost::optional<long long> _maxDurationNs;
+};
+
+class SliceCfg final :
+    public Cfg
+{
+public:
+    enum class Unit {
+        NS,
+        CYCLES,
+    };
+
+public:
+    /*
+     * `begin` and `end` (inclusive) are nanoseconds from origin if
+     * `unit` is `Unit::NS`, or clock cycles if `unit` is `Unit::CYCLES`.
+     */
+    explicit SliceCfg(std::vector<boost::filesystem::path> paths, Unit unit, long long begin,
+                      long long end, boost::filesystem::path dstDir);
+
+    const std::vector<boost::filesystem::path>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    Unit unit() const noexcept
+    {
+        return _unit;
+    }
+
+    long long begin() const noexcept
+    {
+        return _begin;
+    }
+
+    long long end() const noexcept
+    {
+        return _end;
+    }
+
+    const boost::filesystem::path& dstDir() const noexcept
+    {
+        return _dstDir;
+    }
+
+private:
+    const std::vector<boost::filesystem::path> _paths;
+    Unit _unit;
+    long long _begin;
+    long long _end;
+    const boost::filesystem::path _dstDir;
+};
+
 class CreateLttngIndexCfg final :
     public Cfg
 {
 public:
-    explicit CreateLttngIndexCfg(std::vector<boost::filesystem::path> paths);
+    explicit CreateLttngIndexCfg(std::vector<boost::filesystem::path> paths, bool force);
 
     const std::vector<boost::filesystem::path>& paths() const noexcept
     {
         return _paths;
     }
 
+    /*
+     * True to create the LTTng index files even if they're up to
+     * date.
+     */
+    bool force() const noexcept
+    {
+        return _force;
+    }
+
 private:
     const std::vector<boost::filesystem::path> _paths;
+    bool _force;
 };
 
 class PrintCliUsageCfg final :
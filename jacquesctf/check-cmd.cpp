@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "cfg.hpp"
+#include "check-cmd.hpp"
+#include "ds-file-set.hpp"
+#include "worker-pool.hpp"
+#include "utils.hpp"
+#include "data/ds-file.hpp"
+#include "data/pkt-decoder.hpp"
+
+namespace jacques {
+namespace {
+
+struct InvalidPkt
+{
+    Index dsFileIndex;
+    Index pktIndex;
+    Index offsetInDsFileBytes;
+
+    // offset of the error within the data stream file
+    boost::optional<Index> errorOffsetInDsFileBits;
+
+    std::string reason;
+};
+
+/*
+ * Fully decodes the packets of `dsFiles` in parallel and returns the
+ * invalid ones, sorted by data stream file and packet index.
+ *
+ * If `failFast` is true, this function returns only the first invalid
+ * packet: it stops decoding the packets following the first invalid
+ * one found so far, but keeps decoding the preceding ones, which
+ * could also be invalid.
+ */
+std::vector<InvalidPkt> findInvalidPkts(const std::vector<DsFile *>& dsFiles, const bool failFast)
+{
+    struct Unit
+    {
+        Index dsFileIndex;
+        Index pktIndex;
+    };
+
+    std::vector<Unit> units;
+
+    for (Index dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+        for (Index pktIndex = 0; pktIndex < dsFiles[dsFileIndex]->pktCount(); ++pktIndex) {
+            units.push_back({dsFileIndex, pktIndex});
+        }
+    }
+
+    std::vector<InvalidPkt> invalidPkts;
+    std::mutex invalidPktsMutex;
+    std::atomic<Index> nextUnitIndex {0};
+
+    // unit index of the first invalid packet found so far
+    std::atomic<Index> firstInvalidUnitIndex {units.size()};
+
+    WorkerPool {}.run([&](Index) {
+        /*
+         * Units are ordered by data stream file, so a worker mostly
+         * gets consecutive packets of the same data stream file: only
+         * keep the decoder of the current one.
+         */
+        std::unique_ptr<PktDecoder> decoder;
+
+        while (true) {
+            const auto unitIndex = nextUnitIndex++;
+
+            /*
+             * Units are given in order: once a worker gets a unit
+             * following the first invalid packet, all the preceding
+             * ones are being or were decoded.
+             */
+            if (unitIndex >= units.size() || unitIndex > firstInvalidUnitIndex) {
+                break;
+            }
+
+            const auto& unit = units[unitIndex];
+            const auto& dsf = *dsFiles[unit.dsFileIndex];
+            const auto& indexEntry = dsf.pktIndexEntries()[unit.pktIndex];
+
+            if (!decoder || &decoder->dsFile() != &dsf) {
+                decoder = std::make_unique<PktDecoder>(dsf);
+            }
+
+            decoder->forEachElem(indexEntry, [](const auto&) {
+                return true;
+            });
+
+            const auto& decodingError = decoder->lastDecodingError();
+
+            if (!decodingError && !indexEntry.isInvalid()) {
+                continue;
+            }
+
+            InvalidPkt invalidPkt {unit.dsFileIndex, unit.pktIndex,
+                                   indexEntry.offsetInDsFileBytes(), boost::none, {}};
+
+            if (decodingError) {
+                invalidPkt.errorOffsetInDsFileBits = decodingError->offset();
+                invalidPkt.reason = decodingError->reason();
+            } else {
+                // the index builder failed, but not a full decoding
+                invalidPkt.reason = "Cannot index packet.";
+            }
+
+            std::lock_guard<std::mutex> lock {invalidPktsMutex};
+
+            invalidPkts.push_back(std::move(invalidPkt));
+
+            if (failFast && unitIndex < firstInvalidUnitIndex) {
+                firstInvalidUnitIndex = unitIndex;
+            }
+        }
+    }, units.size());
+
+    std::sort(invalidPkts.begin(), invalidPkts.end(), [](const auto& a, const auto& b) {
+        if (a.dsFileIndex != b.dsFileIndex) {
+            return a.dsFileIndex < b.dsFileIndex;
+        }
+
+        return a.pktIndex < b.pktIndex;
+    });
+
+    if (failFast && invalidPkts.size() > 1) {
+        // other workers possibly found following ones before stopping
+        invalidPkts.resize(1);
+    }
+
+    return invalidPkts;
+}
+
+void appendCsvLine(std::string& out, const DsFile& dsf, const InvalidPkt& invalidPkt)
+{
+    utils::appendCsvField(out, dsf.path().string());
+    out += ',';
+    utils::appendUInt(out, invalidPkt.pktIndex + 1);
+    out += ',';
+    utils::appendUInt(out, invalidPkt.offsetInDsFileBytes);
+    out += ',';
+
+    if (invalidPkt.errorOffsetInDsFileBits) {
+        utils::appendUInt(out, *invalidPkt.errorOffsetInDsFileBits);
+    }
+
+    out += ',';
+    utils::appendCsvField(out, invalidPkt.reason);
+    out += '\n';
+}
+
+void appendJsonLine(std::string& out, const DsFile& dsf, const InvalidPkt& invalidPkt)
+{
+    out += "{\"path\":";
+    utils::appendJsonStr(out, dsf.path().string());
+    out += ",\"packet-index\":";
+    utils::appendUInt(out, invalidPkt.pktIndex + 1);
+    out += ",\"offset-bytes\":";
+    utils::appendUInt(out, invalidPkt.offsetInDsFileBytes);
+    out += ",\"error-offset-bits\":";
+
+    if (invalidPkt.errorOffsetInDsFileBits) {
+        utils::appendUInt(out, *invalidPkt.errorOffsetInDsFileBits);
+    } else {
+        out += "null";
+    }
+
+    out += ",\"reason\":";
+    utils::appendJsonStr(out, invalidPkt.reason);
+    out += "}\n";
+}
+
+} // namespace
+
+bool checkCmd(const CheckCfg& cfg)
+{
+    DsFileSet dsFileSet {cfg.paths()};
+
+    dsFileSet.buildIndexes();
+
+    const auto& dsFiles = dsFileSet.dsFiles();
+    const auto invalidPkts = findInvalidPkts(dsFiles, cfg.failFast());
+    std::string out;
+
+    for (const auto& invalidPkt : invalidPkts) {
+        const auto& dsf = *dsFiles[invalidPkt.dsFileIndex];
+
+        if (cfg.format() == CheckCfg::Fmt::JSON_LINES) {
+            appendJsonLine(out, dsf, invalidPkt);
+        } else {
+            appendCsvLine(out, dsf, invalidPkt);
+        }
+    }
+
+    std::cout << out;
+    std::cout.flush();
+    return invalidPkts.empty();
+}
+
+} // namespace jacques
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_CHECK_CMD_HPP
+#define _JACQUES_CHECK_CMD_HPP
+
+#include "cfg.hpp"
+
+namespace jacques {
+
+/*
+ * Returns `true` if all the packets are valid.
+ */
+bool checkCmd(const CheckCfg& cfg);
+
+} // namespace jacques
+
+#endif // _JACQUES_CHECK_CMD_HPP
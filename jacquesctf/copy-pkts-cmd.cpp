@@ -10,14 +10,13 @@
 #include <regex>
 #include <string>
 #include <sstream>
-#include <fstream>
 #include <algorithm>
 #include <vector>
 
 #include "cfg.hpp"
 #include "copy-pkts-cmd.hpp"
 #include "cmd-error.hpp"
-#include "io-error.hpp"
+#include "file-range-copier.hpp"
 #include "data/trace.hpp"
 #include "data/ds-file.hpp"
 #include "data/time-ops.hpp"
@@ -109,24 +108,6 @@ std::vector<Index> parsePktIndexSpecList(const std::string& pktIndexSpecList, co
     return indexes;
 }
 
-void copyPkt(std::ifstream& srcStream, const PktIndexEntry& indexEntry, std::ofstream& dstStream,
-             std::vector<char>& buf)
-{
-    const auto offset = indexEntry.offsetInDsFileBytes();
-    const auto size = indexEntry.effectiveTotalLen().bytes();
-    auto remSize = size;
-
-    srcStream.seekg(offset);
-
-    while (remSize > 0) {
-        const auto readSize = std::min(static_cast<Size>(buf.size()), remSize);
-
-        srcStream.read(buf.data(), readSize);
-        remSize -= readSize;
-        dstStream.write(buf.data(), readSize);
-    }
-}
-
 std::vector<Index> tryParsePktIndexSpecList(const std::string& pktIndexSpecList,
                                             const Size pktCount)
 {
@@ -154,25 +135,22 @@ void copyPktsCmd(const CopyPktsCfg& cfg)
     }
 
     const auto indexes = tryParsePktIndexSpecList(cfg.pktIndexes(), dsf.pktCount());
-    std::ifstream srcStream {cfg.srcPath().c_str(), std::ios::binary};
-    std::ofstream dstStream;
-
-    srcStream.exceptions(std::ios::badbit | std::ios::failbit);
-    dstStream.exceptions(std::ios::badbit | std::ios::failbit);
 
-    try {
-        dstStream.open(cfg.dstPath().c_str(), std::ios::binary);
-        std::vector<char> buf(64 * 1024);
+    // coalesce adjacent packets to copy them with as few calls as possible
+    std::vector<FileRange> ranges;
 
-        for (const auto index : indexes) {
-            copyPkt(srcStream, dsf.pktIndexEntry(index), dstStream, buf);
-        }
+    for (const auto index : indexes) {
+        const auto& indexEntry = dsf.pktIndexEntry(index);
 
-        srcStream.close();
-        dstStream.close();
-    } catch (const std::ios_base::failure& exc) {
-        throw CmdError {exc.what()};
+        appendFileRange(ranges, {
+            indexEntry.offsetInDsFileBytes(), indexEntry.effectiveTotalLen().bytes()
+        });
     }
+
+    FileRangeCopier copier {cfg.dstPath()};
+
+    copier.copy(cfg.srcPath(), ranges);
+    copier.close();
 }
 
 } // namespace jacques
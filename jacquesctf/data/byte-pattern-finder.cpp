@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <algorithm>
+#include <limits>
+
+#include "byte-pattern-finder.hpp"
+#include "mem-mapped-file.hpp"
+#include "mem-find.hpp"
+
+namespace jacques {
+
+constexpr Size BytePatternFinder::_chunkLenBytes;
+
+namespace {
+
+/*
+ * Scans the chunk of which the first candidate offset is
+ * `beginOffsetBytes` and the last candidate offset is
+ * `endOffsetBytes - 1`, calling `func` with the offset, within the
+ * data stream file, of each match until it returns false.
+ *
+ * Returns false if `func` returned false.
+ */
+template <typename FuncT>
+bool scanChunk(MemMappedFile& mmapFile, const std::vector<std::uint8_t>& pattern,
+               const Index beginOffsetBytes, const Index endOffsetBytes, FuncT&& func)
+{
+    assert(endOffsetBytes > beginOffsetBytes);
+
+    // include the bytes of a match starting at the last candidate offset
+    mmapFile.map(beginOffsetBytes,
+                 DataLen::fromBytes(endOffsetBytes - beginOffsetBytes + pattern.size() - 1));
+
+    const auto hay = mmapFile.addr();
+    const auto hayLen = mmapFile.len().bytes();
+    Index pos = 0;
+
+    while (pos < hayLen) {
+        const auto match = memFind(hay + pos, hayLen - pos, pattern.data(), pattern.size());
+
+        if (!match) {
+            break;
+        }
+
+        if (!func(beginOffsetBytes + static_cast<Index>(match - hay))) {
+            return false;
+        }
+
+        // overlapping matches are distinct matches
+        pos = static_cast<Index>(match - hay) + 1;
+    }
+
+    return true;
+}
+
+} // namespace
+
+BytePatternFinder::BytePatternFinder(const DsFile& dsFile, Pattern pattern,
+                                     const Size workerCount) :
+    _dsFile {&dsFile},
+    _pattern {std::move(pattern)},
+    _workerPool {workerCount}
+{
+    assert(!_pattern.empty());
+}
+
+boost::optional<Index> BytePatternFinder::findFirst(const Index startOffsetBytes,
+                                                    const std::atomic_bool * const cancel) const
+{
+    const auto fileLenBytes = _dsFile->fileLen().bytes();
+
+    if (startOffsetBytes + _pattern.size() > fileLenBytes) {
+        return boost::none;
+    }
+
+    // one past the last offset at which a match may start
+    const auto endOffsetBytes = fileLenBytes - _pattern.size() + 1;
+    const auto chunkCount = (endOffsetBytes - startOffsetBytes + _chunkLenBytes - 1) /
+                            _chunkLenBytes;
+    const auto isCanceled = [cancel] {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    };
+
+    std::atomic<Index> nextChunkIndex {0};
+
+    // earliest match so far
+    std::atomic<Index> bestOffsetBytes {std::numeric_limits<Index>::max()};
+
+    _workerPool.run([&](Index) {
+        MemMappedFile mmapFile {_dsFile->path()};
+
+        mmapFile.advice(MemMappedFile::Advice::SEQUENTIAL);
+
+        while (!isCanceled()) {
+            const auto chunkIndex = nextChunkIndex.fetch_add(1);
+            const auto chunkBeginOffsetBytes = startOffsetBytes + chunkIndex * _chunkLenBytes;
+
+            if (chunkIndex >= chunkCount || chunkBeginOffsetBytes >= bestOffsetBytes.load()) {
+                // no more chunks, or any match would be too late
+                return;
+            }
+
+            const auto chunkEndOffsetBytes = std::min(chunkBeginOffsetBytes + _chunkLenBytes,
+                                                      endOffsetBytes);
+
+            scanChunk(mmapFile, _pattern, chunkBeginOffsetBytes, chunkEndOffsetBytes,
+                      [&](const Index offsetBytes) {
+                if (offsetBytes >= chunkEndOffsetBytes) {
+                    // belongs to the next chunk
+                    return false;
+                }
+
+                auto curBestOffsetBytes = bestOffsetBytes.load();
+
+                while (offsetBytes < curBestOffsetBytes &&
+                        !bestOffsetBytes.compare_exchange_weak(curBestOffsetBytes,
+                                                               offsetBytes));
+
+                // first match of this chunk: done with it
+                return false;
+            });
+        }
+    }, chunkCount);
+
+    if (isCanceled()) {
+        return boost::none;
+    }
+
+    const auto offsetBytes = bestOffsetBytes.load();
+
+    if (offsetBytes == std::numeric_limits<Index>::max()) {
+        return boost::none;
+    }
+
+    return offsetBytes;
+}
+
+bool BytePatternFinder::forEachMatch(const Index startOffsetBytes, const MatchFunc& func,
+                                     const std::atomic_bool * const cancel) const
+{
+    const auto fileLenBytes = _dsFile->fileLen().bytes();
+
+    if (startOffsetBytes + _pattern.size() > fileLenBytes) {
+        return true;
+    }
+
+    const auto endOffsetBytes = fileLenBytes - _pattern.size() + 1;
+    MemMappedFile mmapFile {_dsFile->path()};
+
+    mmapFile.advice(MemMappedFile::Advice::SEQUENTIAL);
+
+    for (auto chunkBeginOffsetBytes = startOffsetBytes; chunkBeginOffsetBytes < endOffsetBytes;
+            chunkBeginOffsetBytes += _chunkLenBytes) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        const auto chunkEndOffsetBytes = std::min(chunkBeginOffsetBytes + _chunkLenBytes,
+                                                  endOffsetBytes);
+        bool stopped = false;
+
+        scanChunk(mmapFile, _pattern, chunkBeginOffsetBytes, chunkEndOffsetBytes,
+                  [&](const Index offsetBytes) {
+            if (offsetBytes >= chunkEndOffsetBytes) {
+                // belongs to the next chunk
+                return false;
+            }
+
+            if (!func(offsetBytes)) {
+                stopped = true;
+                return false;
+            }
+
+            return true;
+        });
+
+        if (stopped) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace jacques
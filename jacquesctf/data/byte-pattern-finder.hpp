@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_BYTE_PATTERN_FINDER_HPP
+#define _JACQUES_DATA_BYTE_PATTERN_FINDER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <boost/optional.hpp>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+#include "ds-file.hpp"
+#include "worker-pool.hpp"
+
+namespace jacques {
+
+/*
+ * Finds a byte pattern within the raw data of a data stream file,
+ * whatever the packet and region boundaries.
+ *
+ * The finder memory-maps the data stream file chunk by chunk (two
+ * consecutive chunks overlap by the pattern length minus one byte so
+ * that no match is missed) and scans each chunk with memFind().
+ *
+ * All the offsets are offsets, in bytes, within the data stream file:
+ * use DsFile::pktIndexEntryContainingOffsetBits() to find the packet
+ * containing a match.
+ */
+class BytePatternFinder final :
+    boost::noncopyable
+{
+public:
+    using Pattern = std::vector<std::uint8_t>;
+
+    /*
+     * Called for each match; returns false to stop.
+     */
+    using MatchFunc = std::function<bool (Index offsetInDsFileBytes)>;
+
+public:
+    explicit BytePatternFinder(const DsFile& dsFile, Pattern pattern, Size workerCount = 0);
+
+    /*
+     * Finds the first occurrence of the pattern starting at or after
+     * `startOffsetBytes`.
+     *
+     * The workers of the worker pool scan distinct chunks: the earliest
+     * chunk containing a match always wins.
+     *
+     * The search stops as soon as possible when `cancel` becomes true;
+     * in that case this method returns `boost::none`.
+     */
+    boost::optional<Index> findFirst(Index startOffsetBytes,
+                                     const std::atomic_bool *cancel = nullptr) const;
+
+    /*
+     * Calls `func` for each occurrence (overlapping ones included) of
+     * the pattern starting at or after `startOffsetBytes`, in
+     * increasing offset order, from the calling thread.
+     *
+     * Returns false if `func` stopped the iteration or if `cancel`
+     * became true.
+     */
+    bool forEachMatch(Index startOffsetBytes, const MatchFunc& func,
+                      const std::atomic_bool *cancel = nullptr) const;
+
+    const Pattern& pattern() const noexcept
+    {
+        return _pattern;
+    }
+
+private:
+    // length of a scanned chunk (excluding the overlap)
+    static constexpr Size _chunkLenBytes = 16 << 20;
+
+private:
+    const DsFile *_dsFile;
+    const Pattern _pattern;
+    WorkerPool _workerPool;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_BYTE_PATTERN_FINDER_HPP
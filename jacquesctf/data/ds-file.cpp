@@ -403,4 +403,11 @@ Pkt& DsFile::pktAtIndex(const Index index, PktCheckpointsBuildListener& buildLis
     return *_pkts[index];
 }
 
+void DsFile::discardPkt(const Index index) noexcept
+{
+    assert(_isIndexBuilt);
+    assert(index < _index.size());
+    _pkts[index].reset();
+}
+
 } // namespace jacques
@@ -44,6 +44,14 @@ public:
     void buildIndex(const BuildIndexProgressFunc& progressFunc, Size step = 1);
     bool hasOffsetBits(Index offsetBits) const noexcept;
     Pkt& pktAtIndex(Index index, PktCheckpointsBuildListener& buildListener);
+
+    /*
+     * Destroys the packet at index `index` which pktAtIndex() created,
+     * if any: the next pktAtIndex() call with this index creates it
+     * again.
+     */
+    void discardPkt(Index index) noexcept;
+
     const PktIndexEntry& pktIndexEntryContainingOffsetBits(Index offsetBits) const noexcept;
     const PktIndexEntry *pktIndexEntryWithSeqNum(Index seqNum) const noexcept;
     const PktIndexEntry *pktIndexEntryContainingNsFromOrigin(long long nsFromOrigin) const noexcept;
@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include "er-field-pred.hpp"
+#include "dt-path.hpp"
+
+namespace jacques {
+
+ErFieldPred::ErFieldPred(const Metadata& metadata, Path path, Cond cond) :
+    _path {std::move(path)},
+    _cond {std::move(cond)}
+{
+    this->_resolve(metadata);
+}
+
+namespace {
+
+/*
+ * Returns the names of the items of `dtPath`, skipping array elements
+ * and optional data, or `boost::none` if any variant type option has no
+ * name.
+ */
+boost::optional<std::vector<std::string>> dtPathNames(const DtPath& dtPath)
+{
+    std::vector<std::string> names;
+
+    for (const auto& item : dtPath.items()) {
+        if (const auto structMemberItem = boost::get<DtPath::StructMemberItem>(&item)) {
+            names.push_back(structMemberItem->name);
+        } else if (const auto varOptItem = boost::get<DtPath::VarOptItem>(&item)) {
+            if (!varOptItem->name) {
+                return boost::none;
+            }
+
+            names.push_back(*varOptItem->name);
+        }
+    }
+
+    return names;
+}
+
+bool isComparableDt(const yactfr::DataType& dt) noexcept
+{
+    return dt.isFixedLengthBitArrayType() || dt.isVariableLengthIntegerType() ||
+           dt.isNullTerminatedStringType() || dt.isStaticLengthStringType() ||
+           dt.isDynamicLengthStringType();
+}
+
+} // namespace
+
+void ErFieldPred::_resolve(const Metadata& metadata)
+{
+    for (const auto& dtDtPathPair : metadata.dtPaths()) {
+        const auto& dt = *dtDtPathPair.first;
+        const auto& dtPath = dtDtPathPair.second;
+
+        if (dtPath.scope() != _path.scope || !isComparableDt(dt)) {
+            continue;
+        }
+
+        const auto names = dtPathNames(dtPath);
+
+        if (names && *names == _path.names) {
+            _dts.insert(&dt);
+        }
+    }
+}
+
+bool ErFieldPred::_cmpResultSatisfies(const int cmpResult) const noexcept
+{
+    switch (_cond.op) {
+    case Op::EQ:
+        return cmpResult == 0;
+
+    case Op::NE:
+        return cmpResult != 0;
+
+    case Op::LT:
+        return cmpResult < 0;
+
+    case Op::LE:
+        return cmpResult <= 0;
+
+    case Op::GT:
+        return cmpResult > 0;
+
+    case Op::GE:
+        return cmpResult >= 0;
+
+    default:
+        std::abort();
+    }
+}
+
+namespace {
+
+template <typename ValT>
+int cmpVals(const ValT left, const ValT right) noexcept
+{
+    if (left < right) {
+        return -1;
+    } else if (left > right) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int cmpNumVal(const long long val, const long long operand) noexcept
+{
+    return cmpVals(val, operand);
+}
+
+int cmpNumVal(const unsigned long long val, const long long operand) noexcept
+{
+    if (operand < 0) {
+        return 1;
+    }
+
+    return cmpVals(val, static_cast<unsigned long long>(operand));
+}
+
+int cmpNumVal(const double val, const long long operand) noexcept
+{
+    return cmpVals(val, static_cast<double>(operand));
+}
+
+} // namespace
+
+template <typename ValT>
+bool ErFieldPred::_numValSatisfies(const ValT val) const noexcept
+{
+    const auto operand = boost::get<long long>(&_cond.val);
+
+    if (!operand) {
+        // string operand
+        return false;
+    }
+
+    if (_cond.op == Op::IN) {
+        return cmpNumVal(val, *operand) >= 0 && cmpNumVal(val, _cond.upperVal) <= 0;
+    }
+
+    return this->_cmpResultSatisfies(cmpNumVal(val, *operand));
+}
+
+bool ErFieldPred::valSatisfies(const long long val) const noexcept
+{
+    return this->_numValSatisfies(val);
+}
+
+bool ErFieldPred::valSatisfies(const unsigned long long val) const noexcept
+{
+    return this->_numValSatisfies(val);
+}
+
+bool ErFieldPred::valSatisfies(const double val) const noexcept
+{
+    return this->_numValSatisfies(val);
+}
+
+bool ErFieldPred::valSatisfies(const std::string& val) const noexcept
+{
+    const auto operand = boost::get<std::string>(&_cond.val);
+
+    if (!operand || _cond.op == Op::IN) {
+        return false;
+    }
+
+    return this->_cmpResultSatisfies(val.compare(*operand));
+}
+
+ErFieldPred::Evaluator::Evaluator(const ErFieldPred& pred) :
+    _pred {&pred}
+{
+}
+
+void ErFieldPred::Evaluator::reset()
+{
+    _inStr = false;
+}
+
+void ErFieldPred::Evaluator::_beginStr(const yactfr::DataType& dt)
+{
+    _inStr = _pred->hasDt(dt);
+    _str.clear();
+    _strEnded = false;
+}
+
+bool ErFieldPred::Evaluator::feed(const yactfr::Element& elem)
+{
+    using ElemKind = yactfr::Element::Kind;
+
+    switch (elem.kind()) {
+    case ElemKind::FIXED_LENGTH_BIT_ARRAY:
+    {
+        auto& bitArrayElem = elem.asFixedLengthBitArrayElement();
+
+        return _pred->hasDt(bitArrayElem.type()) &&
+               _pred->valSatisfies(bitArrayElem.unsignedIntegerValue());
+    }
+
+    case ElemKind::FIXED_LENGTH_BOOLEAN:
+    {
+        auto& boolElem = static_cast<const yactfr::FixedLengthBooleanElement&>(elem);
+
+        return _pred->hasDt(boolElem.type()) &&
+               _pred->valSatisfies(static_cast<unsigned long long>(boolElem.value()));
+    }
+
+    case ElemKind::FIXED_LENGTH_SIGNED_INTEGER:
+    case ElemKind::FIXED_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::FixedLengthSignedIntegerElement&>(elem);
+
+        return _pred->hasDt(intElem.type()) && _pred->valSatisfies(intElem.value());
+    }
+
+    case ElemKind::FIXED_LENGTH_UNSIGNED_INTEGER:
+    case ElemKind::FIXED_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::FixedLengthUnsignedIntegerElement&>(elem);
+
+        return _pred->hasDt(intElem.type()) && _pred->valSatisfies(intElem.value());
+    }
+
+    case ElemKind::FIXED_LENGTH_FLOATING_POINT_NUMBER:
+    {
+        auto& fltElem = static_cast<const yactfr::FixedLengthFloatingPointNumberElement&>(elem);
+
+        return _pred->hasDt(fltElem.type()) && _pred->valSatisfies(fltElem.value());
+    }
+
+    case ElemKind::VARIABLE_LENGTH_SIGNED_INTEGER:
+    case ElemKind::VARIABLE_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::VariableLengthSignedIntegerElement&>(elem);
+
+        return _pred->hasDt(intElem.type()) && _pred->valSatisfies(intElem.value());
+    }
+
+    case ElemKind::VARIABLE_LENGTH_UNSIGNED_INTEGER:
+    case ElemKind::VARIABLE_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::VariableLengthUnsignedIntegerElement&>(elem);
+
+        return _pred->hasDt(intElem.type()) && _pred->valSatisfies(intElem.value());
+    }
+
+    case ElemKind::NULL_TERMINATED_STRING_BEGINNING:
+        this->_beginStr(elem.asNullTerminatedStringBeginningElement().type());
+        break;
+
+    case ElemKind::STATIC_LENGTH_STRING_BEGINNING:
+        this->_beginStr(elem.asStaticLengthStringBeginningElement().type());
+        break;
+
+    case ElemKind::DYNAMIC_LENGTH_STRING_BEGINNING:
+        this->_beginStr(elem.asDynamicLengthStringBeginningElement().type());
+        break;
+
+    case ElemKind::SUBSTRING:
+    {
+        if (!_inStr || _strEnded) {
+            break;
+        }
+
+        auto& substrElem = elem.asSubstringElement();
+        const auto end = substrElem.begin() + substrElem.size();
+        const auto strEnd = std::find(substrElem.begin(), end, '\0');
+
+        _str.append(substrElem.begin(), strEnd);
+        _strEnded = strEnd != end;
+        break;
+    }
+
+    case ElemKind::NULL_TERMINATED_STRING_END:
+    case ElemKind::STATIC_LENGTH_STRING_END:
+    case ElemKind::DYNAMIC_LENGTH_STRING_END:
+    {
+        if (!_inStr) {
+            break;
+        }
+
+        _inStr = false;
+        return _pred->valSatisfies(_str);
+    }
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+} // namespace jacques
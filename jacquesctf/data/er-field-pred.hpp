@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_ER_FIELD_PRED_HPP
+#define _JACQUES_DATA_ER_FIELD_PRED_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <boost/variant.hpp>
+#include <boost/core/noncopyable.hpp>
+#include <yactfr/yactfr.hpp>
+
+#include "aliases.hpp"
+#include "metadata.hpp"
+
+namespace jacques {
+
+/*
+ * Event record field predicate, for example "the `fd` member of the
+ * event record payload is 17".
+ *
+ * An event record field predicate resolves its path once, on
+ * construction, to the set of matching data types of a given metadata
+ * object. Then, an evaluator (see ErFieldPred::Evaluator) checks the
+ * elements of a decoded event record, comparing the value of an
+ * element only if its data type is part of this set. This means that
+ * evaluating an event record field predicate doesn't need any packet
+ * region.
+ *
+ * An event record field predicate is immutable, therefore you may share
+ * it between threads, each thread having its own evaluator.
+ */
+class ErFieldPred final :
+    boost::noncopyable
+{
+public:
+    /*
+     * Path to a field within an event record scope.
+     *
+     * Each name is the (display) name of a structure member or of a
+     * variant type option. Array elements and optional data are
+     * transparent: `payload.arr.x` targets the `x` member of all the
+     * elements of the `arr` array.
+     */
+    struct Path
+    {
+        yactfr::Scope scope;
+        std::vector<std::string> names;
+    };
+
+    enum class Op
+    {
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+
+        // inclusive range
+        IN,
+    };
+
+    using Operand = boost::variant<long long, std::string>;
+
+    struct Cond
+    {
+        Op op;
+        Operand val;
+
+        // upper value of range (`Op::IN` only)
+        long long upperVal;
+    };
+
+    /*
+     * Per-thread event record field predicate evaluator.
+     *
+     * Feed all the elements of an event record, in order, to feed(),
+     * which returns true when the element completes a field value which
+     * satisfies the predicate.
+     */
+    class Evaluator final
+    {
+    public:
+        explicit Evaluator(const ErFieldPred& pred);
+        bool feed(const yactfr::Element& elem);
+        void reset();
+
+    private:
+        void _beginStr(const yactfr::DataType& dt);
+
+    private:
+        const ErFieldPred *_pred;
+        bool _inStr = false;
+        bool _strEnded = false;
+        std::string _str;
+    };
+
+public:
+    explicit ErFieldPred(const Metadata& metadata, Path path, Cond cond);
+
+    /*
+     * True if the path of this predicate matches at least one data type
+     * of the metadata.
+     */
+    bool isResolved() const noexcept
+    {
+        return !_dts.empty();
+    }
+
+    const Path& path() const noexcept
+    {
+        return _path;
+    }
+
+    const Cond& cond() const noexcept
+    {
+        return _cond;
+    }
+
+    bool hasDt(const yactfr::DataType& dt) const noexcept
+    {
+        return _dts.find(&dt) != _dts.end();
+    }
+
+    bool valSatisfies(long long val) const noexcept;
+    bool valSatisfies(unsigned long long val) const noexcept;
+    bool valSatisfies(double val) const noexcept;
+    bool valSatisfies(const std::string& val) const noexcept;
+
+private:
+    void _resolve(const Metadata& metadata);
+    bool _cmpResultSatisfies(int cmpResult) const noexcept;
+
+    template <typename ValT>
+    bool _numValSatisfies(ValT val) const noexcept;
+
+private:
+    const Path _path;
+    const Cond _cond;
+    std::unordered_set<const yactfr::DataType *> _dts;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_ER_FIELD_PRED_HPP
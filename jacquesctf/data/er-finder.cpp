@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <limits>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <vector>
+
+#include "er-finder.hpp"
+#include "pkt-decoder.hpp"
+
+namespace jacques {
+
+namespace {
+
+/*
+ * Per-worker event record matcher: packet decoder and state of the
+ * field predicate.
+ */
+class ErMatcher final :
+    boost::noncopyable
+{
+public:
+    explicit ErMatcher(const DsFile& dsFile, const ErFinder::Pred& pred,
+                       const ErFieldPred * const fieldPred) :
+        _decoder {dsFile},
+        _pred {&pred}
+    {
+        if (fieldPred) {
+            _fieldPredEvaluator.emplace(*fieldPred);
+        }
+    }
+
+    /*
+     * Calls `func` with each event record of the packet having the
+     * index entry `pktIndexEntry` and a function which returns whether
+     * or not it satisfies the predicates, until `func` returns false.
+     */
+    template <typename FuncT>
+    void forEachEr(const PktIndexEntry& pktIndexEntry, FuncT&& func)
+    {
+        PktDecoder::ErElemFunc erElemFunc;
+
+        if (_fieldPredEvaluator) {
+            _fieldPredEvaluator->reset();
+            erElemFunc = [this](const yactfr::Element& elem) {
+                if (!_fieldPredSatisfied && _fieldPredEvaluator->feed(elem)) {
+                    _fieldPredSatisfied = true;
+                }
+            };
+        }
+
+        _fieldPredSatisfied = false;
+        _decoder.forEachEr(pktIndexEntry, [this, &pktIndexEntry, &func](const Er& er) {
+            const auto satisfiesFieldPred = !_fieldPredEvaluator || _fieldPredSatisfied;
+
+            _fieldPredSatisfied = false;
+
+            const auto matches = [this, &pktIndexEntry, &er, satisfiesFieldPred] {
+                return satisfiesFieldPred && (!*_pred || (*_pred)(pktIndexEntry, er));
+            };
+
+            return func(er, matches);
+        }, erElemFunc);
+    }
+
+private:
+    PktDecoder _decoder;
+    const ErFinder::Pred *_pred;
+    boost::optional<ErFieldPred::Evaluator> _fieldPredEvaluator;
+    bool _fieldPredSatisfied = false;
+};
+
+} // namespace
+
+ErFinder::ErFinder(const DsFile& dsFile, const Size workerCount) :
+    _dsFile {&dsFile},
+    _workerPool {workerCount}
+{
+}
+
+bool ErFinder::_isUnsatisfiable(const Pred& pred, const ErFieldPred * const fieldPred) noexcept
+{
+    return pred.target<NoErPred>() || (fieldPred && !fieldPred->isResolved());
+}
+
+boost::optional<ErFinder::Result> ErFinder::findFirst(const Pred& pred, const Index startPktIndex,
+                                                      const Index startErIndex,
+                                                      const std::atomic_bool * const cancel,
+                                                      const ErFieldPred * const fieldPred) const
+{
+    assert(pred || fieldPred);
+
+    const auto pktCount = _dsFile->pktCount();
+
+    if (startPktIndex >= pktCount) {
+        return boost::none;
+    }
+
+    if (ErFinder::_isUnsatisfiable(pred, fieldPred)) {
+        return boost::none;
+    }
+
+    const auto isCanceled = [cancel] {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    };
+
+    std::atomic<Index> nextPktIndex {startPktIndex};
+
+    // index of the earliest packet containing a match so far
+    std::atomic<Index> bestPktIndex {std::numeric_limits<Index>::max()};
+    boost::optional<Result> best;
+    std::mutex bestMutex;
+
+    _workerPool.run([&](Index) {
+        ErMatcher matcher {*_dsFile, pred, fieldPred};
+
+        while (!isCanceled()) {
+            const auto pktIndex = nextPktIndex.fetch_add(1);
+
+            if (pktIndex >= pktCount || pktIndex > bestPktIndex.load()) {
+                // no more packets, or any match would be too late
+                return;
+            }
+
+            const auto firstErIndex = pktIndex == startPktIndex ? startErIndex : 0;
+
+            matcher.forEachEr(_dsFile->pktIndexEntry(pktIndex),
+                              [&](const Er& er, const auto& matches) {
+                if (isCanceled() || pktIndex > bestPktIndex.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+
+                if (er.indexInPkt() < firstErIndex || !matches()) {
+                    return true;
+                }
+
+                std::lock_guard<std::mutex> lock {bestMutex};
+
+                if (!best || pktIndex < best->pktIndex) {
+                    best = Result {
+                        pktIndex, er.indexInPkt(), er.segment().offsetInPktBits(), er.ts(),
+                        er.type()
+                    };
+                    bestPktIndex = pktIndex;
+                }
+
+                return false;
+            });
+        }
+    }, pktCount - startPktIndex);
+
+    if (isCanceled()) {
+        return boost::none;
+    }
+
+    return best;
+}
+
+boost::optional<ErFinder::Result> ErFinder::findLast(const Pred& pred, Index endPktIndex,
+                                                     Index endErIndex,
+                                                     const std::atomic_bool * const cancel,
+                                                     const ErFieldPred * const fieldPred) const
+{
+    assert(pred || fieldPred);
+
+    if (endPktIndex >= _dsFile->pktCount()) {
+        // whole last packet
+        endPktIndex = _dsFile->pktCount();
+        endErIndex = 0;
+    }
+
+    if (endErIndex == 0) {
+        // nothing to search within the end packet
+        if (endPktIndex == 0) {
+            return boost::none;
+        }
+
+        --endPktIndex;
+        endErIndex = std::numeric_limits<Index>::max();
+    }
+
+    if (ErFinder::_isUnsatisfiable(pred, fieldPred)) {
+        return boost::none;
+    }
+
+    const auto isCanceled = [cancel] {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    };
+
+    // count of packets claimed so far, from `endPktIndex` down
+    std::atomic<Index> claimedPktCount {0};
+
+    // index, plus one, of the latest packet containing a match so far
+    std::atomic<Index> bestPktIndexPlusOne {0};
+    boost::optional<Result> best;
+    std::mutex bestMutex;
+
+    _workerPool.run([&](Index) {
+        ErMatcher matcher {*_dsFile, pred, fieldPred};
+
+        while (!isCanceled()) {
+            const auto claimedIndex = claimedPktCount.fetch_add(1);
+
+            if (claimedIndex > endPktIndex) {
+                // no more packets
+                return;
+            }
+
+            const auto pktIndex = endPktIndex - claimedIndex;
+
+            if (pktIndex + 1 < bestPktIndexPlusOne.load()) {
+                // any match would be too early
+                return;
+            }
+
+            boost::optional<Result> pktBest;
+
+            /*
+             * We need the last match of the packet: keep the latest one
+             * until the end of the packet (or `endErIndex`).
+             */
+            matcher.forEachEr(_dsFile->pktIndexEntry(pktIndex),
+                              [&](const Er& er, const auto& matches) {
+                if (isCanceled() ||
+                        pktIndex + 1 < bestPktIndexPlusOne.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+
+                if (pktIndex == endPktIndex && er.indexInPkt() >= endErIndex) {
+                    return false;
+                }
+
+                if (matches()) {
+                    pktBest = Result {
+                        pktIndex, er.indexInPkt(), er.segment().offsetInPktBits(), er.ts(),
+                        er.type()
+                    };
+                }
+
+                return true;
+            });
+
+            if (!pktBest || isCanceled()) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock {bestMutex};
+
+            if (!best || pktIndex > best->pktIndex) {
+                best = std::move(pktBest);
+                bestPktIndexPlusOne = pktIndex + 1;
+            }
+        }
+    }, endPktIndex + 1);
+
+    if (isCanceled()) {
+        return boost::none;
+    }
+
+    return best;
+}
+
+bool ErFinder::findAll(const Pred& pred, const ResultFunc& func,
+                       const std::atomic_bool * const cancel,
+                       const ErFieldPred * const fieldPred) const
+{
+    assert(pred || fieldPred);
+
+    const auto pktCount = _dsFile->pktCount();
+
+    if (pktCount == 0 || ErFinder::_isUnsatisfiable(pred, fieldPred)) {
+        return true;
+    }
+
+    const auto isCanceled = [cancel] {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    };
+
+    std::atomic<Index> nextPktIndex {0};
+    std::atomic_bool isStopped {false};
+    std::mutex reportMutex;
+    std::condition_variable reportedCond;
+
+    // results of decoded packets which we can't report yet
+    std::map<Index, std::vector<Result>> pendingResults;
+    Index nextReportedPktIndex = 0;
+
+    /*
+     * Maximum number of packets which the workers may decode ahead of
+     * the next packet to report: this bounds `pendingResults` when
+     * the decoding of a packet is slow.
+     */
+    const auto maxPktsAhead = _workerPool.workerCount() * 4;
+
+    _workerPool.run([&](Index) {
+        ErMatcher matcher {*_dsFile, pred, fieldPred};
+
+        while (!isCanceled() && !isStopped) {
+            const auto pktIndex = nextPktIndex.fetch_add(1);
+
+            if (pktIndex >= pktCount) {
+                return;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock {reportMutex};
+
+                /*
+                 * The worker decoding the next packet to report never
+                 * waits here, and it notifies the others once it
+                 * reports it, even when stopped or cancelled.
+                 */
+                reportedCond.wait(lock, [&] {
+                    return isCanceled() || isStopped ||
+                           pktIndex < nextReportedPktIndex + maxPktsAhead;
+                });
+            }
+
+            // when stopped or cancelled, forEachEr() returns at once
+            std::vector<Result> pktResults;
+
+            matcher.forEachEr(_dsFile->pktIndexEntry(pktIndex),
+                              [&](const Er& er, const auto& matches) {
+                if (isCanceled() || isStopped) {
+                    return false;
+                }
+
+                if (matches()) {
+                    pktResults.push_back(Result {
+                        pktIndex, er.indexInPkt(), er.segment().offsetInPktBits(), er.ts(),
+                        er.type()
+                    });
+                }
+
+                return true;
+            });
+
+            std::lock_guard<std::mutex> lock {reportMutex};
+
+            pendingResults[pktIndex] = std::move(pktResults);
+
+            // report the results of the consecutive decoded packets
+            auto it = pendingResults.begin();
+
+            while (it != pendingResults.end() && it->first == nextReportedPktIndex) {
+                for (const auto& result : it->second) {
+                    if (isStopped || isCanceled()) {
+                        break;
+                    }
+
+                    if (!func(result)) {
+                        isStopped = true;
+                    }
+                }
+
+                it = pendingResults.erase(it);
+                ++nextReportedPktIndex;
+            }
+
+            reportedCond.notify_all();
+        }
+    }, pktCount);
+
+    return !isStopped && !isCanceled();
+}
+
+} // namespace jacques
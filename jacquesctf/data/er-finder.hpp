@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_ER_FINDER_HPP
+#define _JACQUES_DATA_ER_FINDER_HPP
+
+#include <atomic>
+#include <functional>
+#include <boost/optional.hpp>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+#include "er.hpp"
+#include "pkt-index-entry.hpp"
+#include "ts.hpp"
+#include "ds-file.hpp"
+#include "er-field-pred.hpp"
+#include "worker-pool.hpp"
+
+namespace jacques {
+
+/*
+ * Finds the first or last event record, in data stream file order,
+ * which satisfies a predicate.
+ *
+ * The finder distributes the packets to decode amongst the workers of
+ * a worker pool, each worker having its own packet decoder. Workers
+ * claim packets in increasing index order and give up on any packet
+ * which follows a packet in which a match was already found, so that
+ * the earliest packet always wins, whatever the completion order.
+ *
+ * The predicate is called concurrently from many threads: it must not
+ * modify any shared state.
+ *
+ * The finder never modifies the data stream file, so that a canceled
+ * search leaves everything as is.
+ */
+class ErFinder final :
+    boost::noncopyable
+{
+public:
+    /*
+     * Event record predicate; the first parameter is the index entry
+     * of the packet containing the event record.
+     */
+    using Pred = std::function<bool (const PktIndexEntry&, const Er&)>;
+
+    /*
+     * Predicate which no event record satisfies.
+     *
+     * When `Pred` wraps such a predicate, the find methods return
+     * immediately instead of decoding all the packets.
+     */
+    struct NoErPred
+    {
+        bool operator()(const PktIndexEntry&, const Er&) const noexcept
+        {
+            return false;
+        }
+    };
+
+    struct Result
+    {
+        Index pktIndex;
+        Index erIndexInPkt;
+        Index erOffsetInPktBits;
+        boost::optional<Ts> erTs;
+        const yactfr::EventRecordType *ert;
+    };
+
+    /*
+     * Called for each result of findAll(); returns false to stop.
+     */
+    using ResultFunc = std::function<bool (const Result&)>;
+
+public:
+    explicit ErFinder(const DsFile& dsFile, Size workerCount = 0);
+
+    /*
+     * Finds the first event record satisfying `pred`, starting at the
+     * event record at index `startErIndex` within the packet at index
+     * `startPktIndex`.
+     *
+     * If `fieldPred` is set, then the event record must also satisfy
+     * it; `pred` may be empty in that case.
+     *
+     * The search stops as soon as possible when `cancel` becomes true;
+     * in that case this method returns `boost::none`.
+     */
+    boost::optional<Result> findFirst(const Pred& pred, Index startPktIndex,
+                                      Index startErIndex = 0,
+                                      const std::atomic_bool *cancel = nullptr,
+                                      const ErFieldPred *fieldPred = nullptr) const;
+
+    /*
+     * Like findFirst(), but finds the last event record satisfying
+     * `pred` located before the event record at index `endErIndex`
+     * within the packet at index `endPktIndex` (excluded).
+     *
+     * `endPktIndex` may be the packet count and `endErIndex` may be
+     * the event record count of the packet.
+     *
+     * Workers claim packets in decreasing index order, so that this
+     * costs as much as findFirst(): the latest packet always wins.
+     */
+    boost::optional<Result> findLast(const Pred& pred, Index endPktIndex, Index endErIndex,
+                                     const std::atomic_bool *cancel = nullptr,
+                                     const ErFieldPred *fieldPred = nullptr) const;
+
+    /*
+     * Calls `func` with each event record satisfying `pred` (and
+     * `fieldPred`, if set), in data stream file order.
+     *
+     * The workers decode distinct packets and keep the results of each
+     * decoded packet until the results of all the preceding packets
+     * are reported: `func` is called from one worker at a time, in
+     * order. The workers don't go more than a few packets per worker
+     * ahead of the next packet to report.
+     *
+     * Returns false if `func` stopped the iteration or if `cancel`
+     * became true.
+     */
+    bool findAll(const Pred& pred, const ResultFunc& func,
+                 const std::atomic_bool *cancel = nullptr,
+                 const ErFieldPred *fieldPred = nullptr) const;
+
+private:
+    /*
+     * True if no event record can satisfy both `pred` and `fieldPred`.
+     */
+    static bool _isUnsatisfiable(const Pred& pred, const ErFieldPred *fieldPred) noexcept;
+
+private:
+    const DsFile *_dsFile;
+    WorkerPool _workerPool;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_ER_FINDER_HPP
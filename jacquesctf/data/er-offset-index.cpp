@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include "er-offset-index.hpp"
+
+namespace jacques {
+
+constexpr Size ErOffsetIndex::_blockSize;
+
+void ErOffsetIndex::append(const Index offsetInPktBits)
+{
+    if (_size % _blockSize == 0) {
+        // new block: absolute offset
+        _blocks.push_back({offsetInPktBits, _deltas.size()});
+    } else {
+        assert(offsetInPktBits >= _lastOffsetInPktBits);
+
+        auto delta = offsetInPktBits - _lastOffsetInPktBits;
+
+        // LEB128
+        while (delta >= 0x80) {
+            _deltas.push_back(static_cast<std::uint8_t>((delta & 0x7f) | 0x80));
+            delta >>= 7;
+        }
+
+        _deltas.push_back(static_cast<std::uint8_t>(delta));
+    }
+
+    _lastOffsetInPktBits = offsetInPktBits;
+    ++_size;
+}
+
+namespace {
+
+/*
+ * Decodes the LEB128 integer at `*it`, advancing `it`.
+ */
+Index decodeDelta(const std::uint8_t *& it) noexcept
+{
+    Index delta = 0;
+    unsigned int shift = 0;
+
+    while (true) {
+        const auto byte = *it;
+
+        ++it;
+        delta |= static_cast<Index>(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return delta;
+        }
+
+        shift += 7;
+    }
+}
+
+} // namespace
+
+boost::optional<Index> ErOffsetIndex::erIndexBeforeOrAtOffsetInPktBits(const Index offsetInPktBits) const
+{
+    /*
+     * Find the last event record beginning before `offsetInPktBits`,
+     * then check whether or not the following one begins exactly at
+     * `offsetInPktBits`: this handles many event records beginning at
+     * the same offset, even across blocks.
+     */
+    // first block beginning at or after `offsetInPktBits`
+    const auto blockIt = std::lower_bound(_blocks.begin(), _blocks.end(), offsetInPktBits,
+                                          [](const auto& block, const auto offsetInPktBits) {
+        return block.firstOffsetInPktBits < offsetInPktBits;
+    });
+
+    if (blockIt == _blocks.begin()) {
+        if (!_blocks.empty() && _blocks.front().firstOffsetInPktBits == offsetInPktBits) {
+            return 0;
+        }
+
+        // before the first event record
+        return boost::none;
+    }
+
+    const auto blockIndex = static_cast<Index>(std::prev(blockIt) - _blocks.begin());
+    const auto& block = _blocks[blockIndex];
+    const auto blockErCount = std::min(_blockSize, _size - blockIndex * _blockSize);
+    auto indexInPkt = blockIndex * _blockSize;
+    auto curOffsetInPktBits = block.firstOffsetInPktBits;
+    auto deltaIt = _deltas.data() + block.deltasIndex;
+    boost::optional<Index> nextOffsetInPktBits;
+
+    for (Index i = 1; i < blockErCount; ++i) {
+        const auto offset = curOffsetInPktBits + decodeDelta(deltaIt);
+
+        if (offset >= offsetInPktBits) {
+            nextOffsetInPktBits = offset;
+            break;
+        }
+
+        curOffsetInPktBits = offset;
+        ++indexInPkt;
+    }
+
+    if (!nextOffsetInPktBits && blockIndex + 1 < _blocks.size()) {
+        // last event record of the block: the next one begins the next block
+        nextOffsetInPktBits = _blocks[blockIndex + 1].firstOffsetInPktBits;
+    }
+
+    if (nextOffsetInPktBits && *nextOffsetInPktBits == offsetInPktBits) {
+        return indexInPkt + 1;
+    }
+
+    return indexInPkt;
+}
+
+Index ErOffsetIndex::offsetInPktBits(const Index indexInPkt) const
+{
+    assert(indexInPkt < _size);
+
+    const auto& block = _blocks[indexInPkt / _blockSize];
+    auto curOffsetInPktBits = block.firstOffsetInPktBits;
+    auto deltaIt = _deltas.data() + block.deltasIndex;
+
+    for (Index i = 0; i < indexInPkt % _blockSize; ++i) {
+        curOffsetInPktBits += decodeDelta(deltaIt);
+    }
+
+    return curOffsetInPktBits;
+}
+
+} // namespace jacques
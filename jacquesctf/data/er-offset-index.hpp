@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_ER_OFFSET_INDEX_HPP
+#define _JACQUES_DATA_ER_OFFSET_INDEX_HPP
+
+#include <cstdint>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Compact index of the beginning offsets (bits, within the packet) of
+ * all the event records of a packet.
+ *
+ * The offsets are grouped in blocks of `_blockSize` event records. Each
+ * block has an absolute first offset (anchor); the following offsets
+ * of the block are deltas from their predecessor, encoded as LEB128
+ * variable-length integers. Most event records take one or two bytes.
+ *
+ * Finding the event record containing an offset is a binary search
+ * within the anchors followed by decoding at most `_blockSize - 1`
+ * deltas.
+ */
+class ErOffsetIndex final
+{
+public:
+    /*
+     * Appends the beginning offset of the next event record.
+     *
+     * `offsetInPktBits` must be greater than or equal to the last
+     * appended offset: an event record may be empty (no header and an
+     * empty payload, for example).
+     */
+    void append(Index offsetInPktBits);
+
+    /*
+     * Returns the index of the last event record beginning at or before
+     * `offsetInPktBits`, or `boost::none` if there's none.
+     *
+     * If many event records begin at `offsetInPktBits` (empty event
+     * records), then this method returns the index of the first one.
+     */
+    boost::optional<Index> erIndexBeforeOrAtOffsetInPktBits(Index offsetInPktBits) const;
+
+    /*
+     * Returns the beginning offset of the event record at index
+     * `indexInPkt` (must be less than size()).
+     */
+    Index offsetInPktBits(Index indexInPkt) const;
+
+    Size size() const noexcept
+    {
+        return _size;
+    }
+
+    bool isEmpty() const noexcept
+    {
+        return _size == 0;
+    }
+
+private:
+    struct _Block
+    {
+        // offset of first event record of the block
+        Index firstOffsetInPktBits;
+
+        // index, within `_deltas`, of the first delta of the block
+        Index deltasIndex;
+    };
+
+private:
+    static constexpr Size _blockSize = 64;
+
+private:
+    std::vector<_Block> _blocks;
+    std::vector<std::uint8_t> _deltas;
+    Index _lastOffsetInPktBits = 0;
+    Size _size = 0;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_ER_OFFSET_INDEX_HPP
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include "ert-id-set.hpp"
+
+namespace jacques {
+
+constexpr yactfr::TypeId ErtIdSet::_maxDenseId;
+
+ErtIdSet::ErtIdSet(const yactfr::TraceType& traceType, const ErtPred& pred)
+{
+    for (auto& dst : traceType.dataStreamTypes()) {
+        for (auto& ert : dst->eventRecordTypes()) {
+            if (!pred(*ert)) {
+                continue;
+            }
+
+            _isEmpty = false;
+
+            if (dst->id() > _maxDenseId || ert->id() > _maxDenseId) {
+                _sparseIds.insert({dst->id(), ert->id()});
+                continue;
+            }
+
+            if (dst->id() >= _dstBits.size()) {
+                _dstBits.resize(dst->id() + 1);
+            }
+
+            auto& bits = _dstBits[dst->id()];
+
+            if (ert->id() >= bits.size()) {
+                bits.resize(ert->id() + 1, false);
+            }
+
+            bits[ert->id()] = true;
+        }
+    }
+}
+
+} // namespace jacques
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_ERT_ID_SET_HPP
+#define _JACQUES_DATA_ERT_ID_SET_HPP
+
+#include <vector>
+#include <set>
+#include <utility>
+#include <functional>
+#include <yactfr/yactfr.hpp>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Set of event record types of a trace type, computed once from an
+ * event record type predicate.
+ *
+ * For each data stream type, the set is a dense bitset indexed by
+ * event record type ID, so that contains() is a single bit test. IDs
+ * which are too large for a dense bitset go to a sparse fallback set.
+ */
+class ErtIdSet final
+{
+public:
+    using ErtPred = std::function<bool (const yactfr::EventRecordType&)>;
+
+public:
+    explicit ErtIdSet(const yactfr::TraceType& traceType, const ErtPred& pred);
+
+    bool contains(const yactfr::DataStreamType& dst,
+                  const yactfr::EventRecordType& ert) const noexcept
+    {
+        if (dst.id() < _dstBits.size()) {
+            const auto& bits = _dstBits[dst.id()];
+
+            if (ert.id() < bits.size()) {
+                return bits[ert.id()];
+            }
+        }
+
+        return !_sparseIds.empty() && _sparseIds.count({dst.id(), ert.id()}) != 0;
+    }
+
+    bool isEmpty() const noexcept
+    {
+        return _isEmpty;
+    }
+
+private:
+    // largest data stream/event record type ID of a dense bitset
+    static constexpr yactfr::TypeId _maxDenseId = 1 << 16;
+
+private:
+    std::vector<std::vector<bool>> _dstBits;
+    std::set<std::pair<yactfr::TypeId, yactfr::TypeId>> _sparseIds;
+    bool _isEmpty = true;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_ERT_ID_SET_HPP
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define _JACQUES_MEM_FIND_HAS_AVX2
+# include <immintrin.h>
+#endif
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+#include "mem-find.hpp"
+
+namespace jacques {
+namespace {
+
+const std::uint8_t *memFindScalar(const std::uint8_t * const hay, const Size hayLen,
+                                  const std::uint8_t * const needle,
+                                  const Size needleLen) noexcept
+{
+    assert(needleLen >= 1);
+
+    if (hayLen < needleLen) {
+        return nullptr;
+    }
+
+    const auto last = hay + hayLen - needleLen;
+    auto cur = hay;
+
+    while (cur <= last) {
+        cur = static_cast<const std::uint8_t *>(std::memchr(cur, needle[0], last - cur + 1));
+
+        if (!cur) {
+            return nullptr;
+        }
+
+        if (std::memcmp(cur + 1, needle + 1, needleLen - 1) == 0) {
+            return cur;
+        }
+
+        ++cur;
+    }
+
+    return nullptr;
+}
+
+/*
+ * Checks each set bit of `mask`, which is a candidate position
+ * relative to `blockAddr` (first and last bytes match), comparing the
+ * middle of the needle.
+ */
+const std::uint8_t *checkCandidates(unsigned int mask, const std::uint8_t * const blockAddr,
+                                    const std::uint8_t * const needle,
+                                    const Size needleLen) noexcept
+{
+    while (mask != 0) {
+        const auto pos = blockAddr + __builtin_ctz(mask);
+
+        if (std::memcmp(pos + 1, needle + 1, needleLen - 2) == 0) {
+            return pos;
+        }
+
+        // clear lowest set bit
+        mask &= mask - 1;
+    }
+
+    return nullptr;
+}
+
+#ifdef __SSE2__
+const std::uint8_t *memFindSse2(const std::uint8_t * const hay, const Size hayLen,
+                                const std::uint8_t * const needle,
+                                const Size needleLen) noexcept
+{
+    assert(needleLen >= 2);
+
+    const auto firstByte = _mm_set1_epi8(static_cast<char>(needle[0]));
+    const auto lastByte = _mm_set1_epi8(static_cast<char>(needle[needleLen - 1]));
+    Index i = 0;
+
+    while (i + 16 + needleLen - 1 <= hayLen) {
+        const auto firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i));
+        const auto lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i +
+                                                                                 needleLen - 1));
+        const auto eq = _mm_and_si128(_mm_cmpeq_epi8(firstByte, firstBlock),
+                                      _mm_cmpeq_epi8(lastByte, lastBlock));
+        const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(eq));
+
+        if (const auto pos = checkCandidates(mask, hay + i, needle, needleLen)) {
+            return pos;
+        }
+
+        i += 16;
+    }
+
+    // remaining positions
+    return memFindScalar(hay + i, hayLen - i, needle, needleLen);
+}
+#endif // __SSE2__
+
+#ifdef _JACQUES_MEM_FIND_HAS_AVX2
+__attribute__((target("avx2")))
+const std::uint8_t *memFindAvx2(const std::uint8_t * const hay, const Size hayLen,
+                                const std::uint8_t * const needle,
+                                const Size needleLen) noexcept
+{
+    assert(needleLen >= 2);
+
+    const auto firstByte = _mm256_set1_epi8(static_cast<char>(needle[0]));
+    const auto lastByte = _mm256_set1_epi8(static_cast<char>(needle[needleLen - 1]));
+    Index i = 0;
+
+    while (i + 32 + needleLen - 1 <= hayLen) {
+        const auto firstBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hay + i));
+        const auto lastBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hay + i +
+                                                                                    needleLen - 1));
+        const auto eq = _mm256_and_si256(_mm256_cmpeq_epi8(firstByte, firstBlock),
+                                         _mm256_cmpeq_epi8(lastByte, lastBlock));
+        const auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(eq));
+
+        if (const auto pos = checkCandidates(mask, hay + i, needle, needleLen)) {
+            return pos;
+        }
+
+        i += 32;
+    }
+
+    // remaining positions
+    return memFindScalar(hay + i, hayLen - i, needle, needleLen);
+}
+
+bool cpuHasAvx2() noexcept
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+
+    return hasAvx2;
+}
+#endif // _JACQUES_MEM_FIND_HAS_AVX2
+
+} // namespace
+
+const std::uint8_t *memFind(const std::uint8_t * const hay, const Size hayLen,
+                            const std::uint8_t * const needle, const Size needleLen) noexcept
+{
+    if (needleLen == 0) {
+        return hay;
+    }
+
+    if (hayLen < needleLen) {
+        return nullptr;
+    }
+
+    if (needleLen == 1) {
+        // memchr(3) is already vectorized
+        return static_cast<const std::uint8_t *>(std::memchr(hay, needle[0], hayLen));
+    }
+
+#ifdef _JACQUES_MEM_FIND_HAS_AVX2
+    if (cpuHasAvx2()) {
+        return memFindAvx2(hay, hayLen, needle, needleLen);
+    }
+#endif
+
+#ifdef __SSE2__
+    return memFindSse2(hay, hayLen, needle, needleLen);
+#else
+    return memFindScalar(hay, hayLen, needle, needleLen);
+#endif
+}
+
+} // namespace jacques
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_MEM_FIND_HPP
+#define _JACQUES_DATA_MEM_FIND_HPP
+
+#include <cstdint>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Returns the address of the first occurrence of the `needleLen`-byte
+ * needle `needle` within the `hayLen`-byte haystack `hay`, or `nullptr`
+ * if there's none.
+ *
+ * This is a memmem(3)-like function which, when possible, compares
+ * the first and last bytes of the needle to 32 (AVX2) or 16 (SSE2)
+ * haystack positions at once, only fully comparing the candidate
+ * positions. The AVX2 version is selected at run time if the CPU
+ * supports it. Otherwise, it falls back to a scalar version.
+ */
+const std::uint8_t *memFind(const std::uint8_t *hay, Size hayLen,
+                            const std::uint8_t *needle, Size needleLen) noexcept;
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_MEM_FIND_HPP
@@ -111,6 +111,10 @@ void MemMappedFile::advice(const Advice advice)
     case Advice::RANDOM:
         _mmapAdvice = MADV_RANDOM;
         break;
+
+    case Advice::SEQUENTIAL:
+        _mmapAdvice = MADV_SEQUENTIAL;
+        break;
     }
 
     this->_advice();
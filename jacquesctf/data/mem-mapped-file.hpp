@@ -32,6 +32,7 @@ public:
     enum class Advice {
         NORMAL,
         RANDOM,
+        SEQUENTIAL,
     };
 
 public:
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <algorithm>
+#include <limits>
+
+#include "merged-er-iterator.hpp"
+#include "pkt-decoder.hpp"
+#include "worker-pool.hpp"
+
+namespace jacques {
+
+namespace {
+
+std::vector<const DsFile *> traceDsFiles(const Trace& trace)
+{
+    std::vector<const DsFile *> dsFiles;
+
+    for (const auto& dsFile : trace.dsFiles()) {
+        dsFiles.push_back(dsFile.get());
+    }
+
+    return dsFiles;
+}
+
+} // namespace
+
+MergedErIterator::MergedErIterator(const Trace& trace, const Size prefetchPktCount,
+                                   const Size workerCount) :
+    MergedErIterator {traceDsFiles(trace), prefetchPktCount, workerCount}
+{
+}
+
+MergedErIterator::MergedErIterator(std::vector<const DsFile *> dsFiles,
+                                   const Size prefetchPktCount, const Size workerCount) :
+    _dsFiles {std::move(dsFiles)},
+    _prefetchPktCount {std::max(prefetchPktCount, 1ULL)}
+{
+    for (Index dsFileIndex = 0; dsFileIndex < _dsFiles.size(); ++dsFileIndex) {
+        auto stream = std::make_unique<_Stream>();
+
+        stream->dsFileIndex = dsFileIndex;
+        stream->dsFile = _dsFiles[dsFileIndex];
+        stream->lastNsFromOrigin = std::numeric_limits<long long>::min();
+
+        if (this->_needsDecoding(*stream)) {
+            _needyStreams.push_back(stream.get());
+        }
+
+        _streams.push_back(std::move(stream));
+    }
+
+    this->_startWorkers(workerCount == 0 ? WorkerPool::defaultWorkerCount() : workerCount);
+}
+
+MergedErIterator::~MergedErIterator()
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+
+        _stop = true;
+    }
+
+    _workCond.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void MergedErIterator::_startWorkers(const Size workerCount)
+{
+    // no need for more workers than streams
+    const auto count = std::min(workerCount, static_cast<Size>(_streams.size()));
+
+    for (Index i = 0; i < count; ++i) {
+        _workers.emplace_back([this] {
+            this->_work();
+        });
+    }
+}
+
+bool MergedErIterator::_isStreamDone(const _Stream& stream) const noexcept
+{
+    return !stream.isDecoding && stream.nextPktIndex >= stream.dsFile->pktCount();
+}
+
+bool MergedErIterator::_needsDecoding(const _Stream& stream) const noexcept
+{
+    return !stream.isDecoding && stream.nextPktIndex < stream.dsFile->pktCount() &&
+           stream.readyBatches.size() < _prefetchPktCount;
+}
+
+void MergedErIterator::_work()
+{
+    std::unique_lock<std::mutex> lock {_mutex};
+
+    while (true) {
+        _workCond.wait(lock, [this] {
+            return _stop || !_needyStreams.empty();
+        });
+
+        if (_stop) {
+            return;
+        }
+
+        /*
+         * A stream is within `_needyStreams` if and only if it needs
+         * decoding: at most one worker decodes the packets of a given
+         * stream at a time, in order.
+         */
+        auto& stream = *_needyStreams.front();
+
+        _needyStreams.pop_front();
+        assert(this->_needsDecoding(stream));
+        stream.isDecoding = true;
+
+        const auto& pktIndexEntry = stream.dsFile->pktIndexEntries()[stream.nextPktIndex];
+
+        ++stream.nextPktIndex;
+        lock.unlock();
+
+        _Batch batch;
+        std::exception_ptr exc;
+
+        try {
+            if (!stream.decoder) {
+                stream.decoder = std::make_unique<PktDecoder>(*stream.dsFile);
+            }
+
+            if (pktIndexEntry.erCount()) {
+                batch.reserve(*pktIndexEntry.erCount());
+            }
+
+            stream.decoder->forEachEr(pktIndexEntry, [&stream, &pktIndexEntry,
+                                                      &batch](const jacques::Er& er) {
+                batch.push_back({
+                    stream.dsFileIndex, &pktIndexEntry, er.indexInPkt(), er.segment(),
+                    er.type(), er.ts()
+                });
+                return true;
+            });
+
+            // forEachEr() doesn't throw on decoding error
+            if (const auto& error = stream.decoder->lastDecodingError()) {
+                throw *error;
+            }
+        } catch (...) {
+            exc = std::current_exception();
+        }
+
+        lock.lock();
+        stream.isDecoding = false;
+
+        if (exc) {
+            if (!_exc) {
+                _exc = exc;
+            }
+
+            // don't decode this stream anymore
+            stream.nextPktIndex = stream.dsFile->pktCount();
+        } else {
+            stream.readyBatches.push_back(std::move(batch));
+        }
+
+        if (this->_needsDecoding(stream)) {
+            _needyStreams.push_back(&stream);
+        }
+
+        _readyCond.notify_all();
+    }
+}
+
+bool MergedErIterator::_advance(_Stream& stream)
+{
+    ++stream.curEntryIndex;
+
+    // skip empty packets
+    while (stream.curEntryIndex >= stream.curBatch.size()) {
+        std::unique_lock<std::mutex> lock {_mutex};
+
+        _readyCond.wait(lock, [this, &stream] {
+            return _exc || !stream.readyBatches.empty() || this->_isStreamDone(stream);
+        });
+
+        if (_exc) {
+            std::rethrow_exception(_exc);
+        }
+
+        if (stream.readyBatches.empty()) {
+            // no more event records
+            return false;
+        }
+
+        const auto wasNeedy = this->_needsDecoding(stream);
+
+        stream.curBatch = std::move(stream.readyBatches.front());
+        stream.readyBatches.pop_front();
+        stream.curEntryIndex = 0;
+
+        if (!wasNeedy && this->_needsDecoding(stream)) {
+            // we just made room for another decoded packet
+            _needyStreams.push_back(&stream);
+            _workCond.notify_one();
+        }
+    }
+
+    return true;
+}
+
+namespace {
+
+struct HeapEntryGt final
+{
+    template <typename HeapEntryT>
+    bool operator()(const HeapEntryT& a, const HeapEntryT& b) const noexcept
+    {
+        if (a.nsFromOrigin != b.nsFromOrigin) {
+            return a.nsFromOrigin > b.nsFromOrigin;
+        }
+
+        return a.stream->dsFileIndex > b.stream->dsFileIndex;
+    }
+};
+
+} // namespace
+
+void MergedErIterator::_pushHeap(_Stream& stream)
+{
+    const auto& entry = stream.curBatch[stream.curEntryIndex];
+
+    if (entry.ts) {
+        stream.lastNsFromOrigin = entry.ts->nsFromOrigin();
+    }
+
+    _heap.push_back({stream.lastNsFromOrigin, &stream});
+    std::push_heap(_heap.begin(), _heap.end(), HeapEntryGt {});
+}
+
+const MergedErIterator::Entry *MergedErIterator::next()
+{
+    if (!_isStarted) {
+        _isStarted = true;
+
+        for (auto& stream : _streams) {
+            // current batch is empty: this gets the first packet
+            if (this->_advance(*stream)) {
+                this->_pushHeap(*stream);
+            }
+        }
+    } else if (_curStream) {
+        if (this->_advance(*_curStream)) {
+            this->_pushHeap(*_curStream);
+        }
+    }
+
+    _curStream = nullptr;
+
+    if (_heap.empty()) {
+        return nullptr;
+    }
+
+    std::pop_heap(_heap.begin(), _heap.end(), HeapEntryGt {});
+    _curStream = _heap.back().stream;
+    _heap.pop_back();
+    return &_curStream->curBatch[_curStream->curEntryIndex];
+}
+
+} // namespace jacques
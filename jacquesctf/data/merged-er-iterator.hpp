@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_MERGED_ER_ITERATOR_HPP
+#define _JACQUES_DATA_MERGED_ER_ITERATOR_HPP
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <boost/optional.hpp>
+#include <boost/core/noncopyable.hpp>
+#include <yactfr/yactfr.hpp>
+
+#include "aliases.hpp"
+#include "ds-file.hpp"
+#include "pkt-index-entry.hpp"
+#include "pkt-segment.hpp"
+#include "ts.hpp"
+#include "trace.hpp"
+
+namespace jacques {
+
+class PktDecoder;
+
+/*
+ * Iterator over the event records of many data stream files in global
+ * timestamp order.
+ *
+ * This iterator k-way merges the per-data stream file event record
+ * streams with a binary heap keyed on the timestamp (nanoseconds from
+ * origin) of the next event record of each stream. Equal timestamps
+ * are ordered by data stream file index. An event record without a
+ * timestamp keeps the key of the previous event record of its data
+ * stream file, so that it stays in file order.
+ *
+ * Worker threads decode the packets of each stream ahead of the merge
+ * front, keeping at most `prefetchPktCount` decoded packets per stream,
+ * so that next() seldom waits.
+ *
+ * A merged event record iterator doesn't modify the data stream files.
+ */
+class MergedErIterator final :
+    boost::noncopyable
+{
+public:
+    /*
+     * Event record entry: enough to locate the event record, show its
+     * basic properties, or decode it again.
+     */
+    struct Entry
+    {
+        // index of the data stream file within the merged ones
+        Index dsFileIndex;
+
+        const PktIndexEntry *pktIndexEntry;
+        Index indexInPkt;
+        PktSegment segment;
+        const yactfr::EventRecordType *type;
+        boost::optional<Ts> ts;
+    };
+
+public:
+    /*
+     * Builds a merged event record iterator over the event records of
+     * all the data stream files of `trace`.
+     */
+    explicit MergedErIterator(const Trace& trace, Size prefetchPktCount = 4,
+                              Size workerCount = 0);
+
+    /*
+     * Builds a merged event record iterator over the event records of
+     * `dsFiles`, which must all have a built packet index.
+     *
+     * `workerCount` is the maximum number of decoding threads (as many
+     * as there are hardware threads if 0).
+     */
+    explicit MergedErIterator(std::vector<const DsFile *> dsFiles, Size prefetchPktCount = 4,
+                              Size workerCount = 0);
+
+    ~MergedErIterator();
+
+    /*
+     * Returns the entry of the next event record, or `nullptr` if
+     * there's none.
+     *
+     * The returned entry remains valid until the next call.
+     *
+     * Rethrows any exception which a decoding thread caught, including
+     * a decoding error (`yactfr::DecodingError`).
+     */
+    const Entry *next();
+
+    const std::vector<const DsFile *>& dsFiles() const noexcept
+    {
+        return _dsFiles;
+    }
+
+private:
+    using _Batch = std::vector<Entry>;
+
+    // event record stream of a single data stream file
+    struct _Stream
+    {
+        Index dsFileIndex;
+        const DsFile *dsFile;
+
+        // worker side (protected by `_mutex`, except `decoder`)
+        std::unique_ptr<PktDecoder> decoder;
+        Index nextPktIndex = 0;
+        bool isDecoding = false;
+        std::deque<_Batch> readyBatches;
+
+        // consumer side
+        _Batch curBatch;
+        Index curEntryIndex = 0;
+        long long lastNsFromOrigin;
+    };
+
+    struct _HeapEntry
+    {
+        long long nsFromOrigin;
+        _Stream *stream;
+    };
+
+private:
+    void _startWorkers(Size workerCount);
+    void _work();
+    bool _isStreamDone(const _Stream& stream) const noexcept;
+    bool _needsDecoding(const _Stream& stream) const noexcept;
+    bool _advance(_Stream& stream);
+    void _pushHeap(_Stream& stream);
+
+private:
+    const std::vector<const DsFile *> _dsFiles;
+    const Size _prefetchPktCount;
+    std::vector<std::unique_ptr<_Stream>> _streams;
+    std::vector<_HeapEntry> _heap;
+    bool _isStarted = false;
+
+    // stream of the last returned event record
+    _Stream *_curStream = nullptr;
+
+    // shared between the consumer and the workers
+    std::mutex _mutex;
+    std::condition_variable _workCond;
+    std::condition_variable _readyCond;
+    std::deque<_Stream *> _needyStreams;
+    bool _stop = false;
+    std::exception_ptr _exc;
+    std::vector<std::thread> _workers;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_MERGED_ER_ITERATOR_HPP
@@ -47,6 +47,14 @@ protected:
     virtual void _endBuild();
 };
 
+/*
+ * Packet checkpoints build listener which ignores all the updates.
+ */
+class NullPktCheckpointsBuildListener final :
+    public PktCheckpointsBuildListener
+{
+};
+
 } // namespace jacques
 
 #endif // _JACQUES_DATA_PKT_CHECKPOINTS_BUILD_LISTENER_HPP
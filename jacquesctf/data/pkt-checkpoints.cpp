@@ -21,20 +21,25 @@ PktDecodingError::PktDecodingError(const yactfr::DecodingError& decodingError,
 
 PktCheckpoints::PktCheckpoints(yactfr::ElementSequence& seq, const Metadata& metadata,
                                const PktIndexEntry& pktIndexEntry, const Size step,
+                               const Size tsIndexStep,
                                PktCheckpointsBuildListener& pktCheckpointsBuildListener)
 {
-    this->_tryCreateCheckpoints(seq, metadata, pktIndexEntry, step, pktCheckpointsBuildListener);
+    assert(tsIndexStep > 0);
+    this->_tryCreateCheckpoints(seq, metadata, pktIndexEntry, step, tsIndexStep,
+                                pktCheckpointsBuildListener);
 }
 
 void PktCheckpoints::_tryCreateCheckpoints(yactfr::ElementSequence& seq, const Metadata& metadata,
                                            const PktIndexEntry& pktIndexEntry, const Size step,
+                                           const Size tsIndexStep,
                                            PktCheckpointsBuildListener& pktCheckpointsBuildListener)
 {
     auto it = seq.at(pktIndexEntry.offsetInDsFileBytes());
 
     // we consider other errors (e.g., I/O) unrecoverable: do not catch them
     try {
-        this->_createCheckpoints(it, metadata, pktIndexEntry, step, pktCheckpointsBuildListener);
+        this->_createCheckpoints(it, metadata, pktIndexEntry, step, tsIndexStep,
+                                 pktCheckpointsBuildListener);
     } catch (const yactfr::DecodingError& exc) {
         _error = PktDecodingError {exc, pktIndexEntry};
     }
@@ -93,22 +98,75 @@ void PktCheckpoints::_tryCreateCheckpoints(yactfr::ElementSequence& seq, const M
 void PktCheckpoints::_createCheckpoints(yactfr::ElementSequenceIterator& it,
                                         const Metadata& metadata,
                                         const PktIndexEntry& pktIndexEntry, const Size step,
+                                        const Size tsIndexStep,
                                         PktCheckpointsBuildListener& pktCheckpointsBuildListener)
 {
     Index indexInPkt = 0;
+    const auto clkType = pktIndexEntry.dst() ? pktIndexEntry.dst()->defaultClockType() : nullptr;
+
+    /*
+     * Timestamp index entry being built: we know its position at the
+     * beginning of the event record, but we only know its timestamp
+     * once we reach its info element.
+     */
+    boost::optional<TsIndexEntry> pendingTsIndexEntry;
+    boost::optional<Ts> pendingTs;
 
     // create all checkpoints except (possibly) the last one
     while (it->kind() != yactfr::Element::Kind::PACKET_END) {
-        if (it->kind() == yactfr::Element::Kind::EVENT_RECORD_BEGINNING) {
+        switch (it->kind()) {
+        case yactfr::Element::Kind::EVENT_RECORD_BEGINNING:
+        {
             const auto curIndexInPkt = indexInPkt;
 
             ++indexInPkt;
+            pendingTsIndexEntry = boost::none;
+            pendingTs = boost::none;
+            _erOffsetIndex.append(it.offset() - pktIndexEntry.offsetInDsFileBits());
 
             if (curIndexInPkt % step == 0) {
                 this->_createCheckpoint(it, metadata, pktIndexEntry, curIndexInPkt,
                                         pktCheckpointsBuildListener);
+
+                // a checkpoint is also a perfect timestamp index entry
+                const auto& checkpoint = _checkpoints.back();
+
+                if (checkpoint.first->ts()) {
+                    _tsIndex.push_back({
+                        curIndexInPkt, *checkpoint.first->ts(), checkpoint.second
+                    });
+                }
+
                 continue;
             }
+
+            if (clkType && curIndexInPkt % tsIndexStep == 0) {
+                pendingTsIndexEntry = TsIndexEntry {curIndexInPkt, Ts {}, {}};
+                it.savePosition(pendingTsIndexEntry->pos);
+            }
+
+            break;
+        }
+
+        case yactfr::Element::Kind::DEFAULT_CLOCK_VALUE:
+            if (pendingTsIndexEntry) {
+                assert(clkType);
+                pendingTs = Ts {it->asDefaultClockValueElement().cycles(), *clkType};
+            }
+
+            break;
+
+        case yactfr::Element::Kind::EVENT_RECORD_INFO:
+            if (pendingTsIndexEntry && pendingTs) {
+                pendingTsIndexEntry->ts = *pendingTs;
+                _tsIndex.push_back(std::move(*pendingTsIndexEntry));
+            }
+
+            pendingTsIndexEntry = boost::none;
+            break;
+
+        default:
+            break;
         }
 
         ++it;
@@ -391,4 +449,18 @@ const PktCheckpoints::Checkpoint *PktCheckpoints::nearestCheckpointAfterCycles(c
     return checkpoint;
 }
 
+const PktCheckpoints::TsIndexEntry *PktCheckpoints::nearestTsIndexEntryBeforeOrAtNsFromOrigin(const long long nsFromOrigin) const noexcept
+{
+    return this->_nearestTsIndexEntryBeforeOrAt([](const Ts& ts) {
+        return ts.nsFromOrigin();
+    }, nsFromOrigin);
+}
+
+const PktCheckpoints::TsIndexEntry *PktCheckpoints::nearestTsIndexEntryBeforeOrAtCycles(const unsigned long long cycles) const noexcept
+{
+    return this->_nearestTsIndexEntryBeforeOrAt([](const Ts& ts) {
+        return ts.cycles();
+    }, cycles);
+}
+
 } // namespace jacques
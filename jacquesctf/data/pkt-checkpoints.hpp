@@ -11,6 +11,7 @@
 #include <cassert>
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <vector>
 #include <utility>
 #include <boost/optional.hpp>
@@ -20,6 +21,7 @@
 #include "data-len.hpp"
 #include "er.hpp"
 #include "ts.hpp"
+#include "er-offset-index.hpp"
 #include "pkt-checkpoints-build-listener.hpp"
 #include "metadata.hpp"
 
@@ -52,9 +54,33 @@ public:
     using Checkpoint = std::pair<Er::SP, yactfr::ElementSequenceIteratorPosition>;
     using Checkpoints = std::vector<Checkpoint>;
 
+    /*
+     * Entry of the sparse timestamp index: like a checkpoint, it
+     * contains an element sequence iterator position, but only the
+     * index and timestamp of its event record instead of a complete
+     * (shared) event record object.
+     *
+     * `pos` is the position of the beginning of the event record at
+     * index `indexInPkt`, which has the timestamp `ts`.
+     */
+    struct TsIndexEntry
+    {
+        Index indexInPkt;
+        Ts ts;
+        yactfr::ElementSequenceIteratorPosition pos;
+    };
+
+    using TsIndex = std::vector<TsIndexEntry>;
+
 public:
+    /*
+     * Builds packet checkpoints, creating a checkpoint every `step`
+     * event records and a timestamp index entry every `tsIndexStep`
+     * event records (having a timestamp), and indexing the offsets of
+     * all the event records, within the same pass.
+     */
     explicit PktCheckpoints(yactfr::ElementSequence& seq, const Metadata& metadata,
-                            const PktIndexEntry& pktIndexEntry, Size step,
+                            const PktIndexEntry& pktIndexEntry, Size step, Size tsIndexStep,
                             PktCheckpointsBuildListener& pktCheckpointsBuildListener);
 
     const Checkpoint *nearestCheckpointBeforeOrAtIndex(Index indexInPkt) const noexcept;
@@ -70,6 +96,23 @@ public:
     const Checkpoint *nearestCheckpointBeforeCycles(unsigned long long cycles) const noexcept;
     const Checkpoint *nearestCheckpointAfterCycles(unsigned long long cycles) const noexcept;
 
+    /*
+     * Returns the timestamp index entry from which to decode to find
+     * the first event record having the timestamp `nsFromOrigin`, or
+     * the last one having a timestamp before it: the last entry having
+     * a timestamp strictly before `nsFromOrigin`, or the first entry if
+     * it has exactly this timestamp.
+     *
+     * Returns `nullptr` if there's no such entry.
+     */
+    const TsIndexEntry *nearestTsIndexEntryBeforeOrAtNsFromOrigin(long long nsFromOrigin) const noexcept;
+
+    /*
+     * Like nearestTsIndexEntryBeforeOrAtNsFromOrigin(), but with a
+     * value of the default clock (cycles).
+     */
+    const TsIndexEntry *nearestTsIndexEntryBeforeOrAtCycles(unsigned long long cycles) const noexcept;
+
     Er::SP nearestErBeforeOrAtIndex(const Index indexInPkt) const noexcept
     {
         const auto checkpoint = this->nearestCheckpointBeforeOrAtIndex(indexInPkt);
@@ -245,6 +288,21 @@ public:
         return _checkpoints;
     }
 
+    const TsIndex& tsIndex() const noexcept
+    {
+        return _tsIndex;
+    }
+
+    /*
+     * Beginning offsets of all the event records of the packet which
+     * this object could decode, possibly including one more than
+     * erCount() in case of decoding error.
+     */
+    const ErOffsetIndex& erOffsetIndex() const noexcept
+    {
+        return _erOffsetIndex;
+    }
+
     Checkpoints::const_iterator begin() const noexcept
     {
         return _checkpoints.begin();
@@ -266,13 +324,44 @@ private:
                            PktCheckpointsBuildListener& pktCheckpointsBuildListener);
 
     void _createCheckpoints(yactfr::ElementSequenceIterator& it, const Metadata& metadata,
-                            const PktIndexEntry& pktIndexEntry, Size step,
+                            const PktIndexEntry& pktIndexEntry, Size step, Size tsIndexStep,
                             PktCheckpointsBuildListener& pktCheckpointsBuildListener);
 
     void _tryCreateCheckpoints(yactfr::ElementSequence& seq, const Metadata& metadata,
-                               const PktIndexEntry& pktIndexEntry, Size step,
+                               const PktIndexEntry& pktIndexEntry, Size step, Size tsIndexStep,
                                PktCheckpointsBuildListener& pktCheckpointsBuildListener);
 
+    template <typename GetPropFuncT, typename PropT>
+    const TsIndexEntry *_nearestTsIndexEntryBeforeOrAt(GetPropFuncT&& getPropFunc,
+                                                       const PropT prop) const noexcept
+    {
+        if (_tsIndex.empty()) {
+            return nullptr;
+        }
+
+        // first entry having a timestamp which is not less than `prop`
+        const auto it = std::lower_bound(_tsIndex.begin(), _tsIndex.end(), prop,
+                                         [&getPropFunc](const auto& entry, const auto prop) {
+            return getPropFunc(entry.ts) < prop;
+        });
+
+        if (it != _tsIndex.begin()) {
+            /*
+             * Previous entry: strictly before `prop`, so that decoding
+             * from there finds the first event record having exactly
+             * `prop`, if any.
+             */
+            return &(*std::prev(it));
+        }
+
+        if (getPropFunc(it->ts) == prop) {
+            return &(*it);
+        }
+
+        // nothing before
+        return nullptr;
+    }
+
     void _lastErPositions(yactfr::ElementSequenceIteratorPosition& lastPos,
                           yactfr::ElementSequenceIteratorPosition& penultimatePos,
                           Index& lastIndexInPkt, Index& penultimateIndexInPkt,
@@ -368,6 +457,8 @@ private:
 
 private:
     Checkpoints _checkpoints;
+    TsIndex _tsIndex;
+    ErOffsetIndex _erOffsetIndex;
     boost::optional<PktDecodingError> _error;
     boost::optional<Index> _pktCtxOffsetInPktBits;
 };
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+
+#include "pkt-decoder.hpp"
+
+namespace jacques {
+
+PktDecoder::PktDecoder(const DsFile& dsFile) :
+    _dsFile {&dsFile},
+    _factory {
+        std::make_unique<yactfr::MemoryMappedFileViewFactory>(dsFile.path().string(), 8 << 20,
+                                                              yactfr::MemoryMappedFileViewFactory::AccessPattern::SEQUENTIAL)
+    },
+    _seq {dsFile.metadata().traceType(), *_factory}
+{
+}
+
+yactfr::ElementSequenceIterator& PktDecoder::_itAtPkt(const PktIndexEntry& pktIndexEntry)
+{
+    if (_it) {
+        _it->seekPacket(pktIndexEntry.offsetInDsFileBytes());
+    } else {
+        _it = _seq.at(pktIndexEntry.offsetInDsFileBytes());
+    }
+
+    return *_it;
+}
+
+bool PktDecoder::forEachElem(const PktIndexEntry& pktIndexEntry, const ElemFunc& func)
+{
+    _lastDecodingError = boost::none;
+
+    try {
+        // positioning the iterator decodes the first element
+        auto& it = this->_itAtPkt(pktIndexEntry);
+
+        while (true) {
+            if (!func(it)) {
+                return false;
+            }
+
+            if (it->kind() == yactfr::Element::Kind::PACKET_END) {
+                break;
+            }
+
+            ++it;
+        }
+    } catch (const yactfr::DecodingError& exc) {
+        _lastDecodingError.emplace(exc);
+
+        /*
+         * The iterator is not usable anymore: the next call creates a
+         * new one.
+         */
+        _it = boost::none;
+    }
+
+    return true;
+}
+
+bool PktDecoder::forEachEr(const PktIndexEntry& pktIndexEntry, const ErFunc& func,
+                           const ErElemFunc& erElemFunc)
+{
+    const auto pktOffsetInDsFileBits = pktIndexEntry.offsetInDsFileBits();
+    const auto isCorrelatable = this->metadata().isCorrelatable();
+    boost::optional<Er> er;
+    boost::optional<Ts> curTs;
+    Index indexInPkt = 0;
+
+    return this->forEachElem(pktIndexEntry, [&](const auto& it) {
+        switch (it->kind()) {
+        case yactfr::Element::Kind::EVENT_RECORD_BEGINNING:
+            er.emplace(indexInPkt);
+            er->segment().offsetInPktBits(it.offset() - pktOffsetInDsFileBits);
+            ++indexInPkt;
+            break;
+
+        case yactfr::Element::Kind::EVENT_RECORD_INFO:
+        {
+            auto& elem = it->asEventRecordInfoElement();
+
+            assert(er);
+
+            if (elem.type()) {
+                er->type(*elem.type());
+            }
+
+            if (curTs && isCorrelatable) {
+                er->ts(*curTs);
+            }
+
+            break;
+        }
+
+        case yactfr::Element::Kind::DEFAULT_CLOCK_VALUE:
+        {
+            if (isCorrelatable) {
+                auto& elem = it->asDefaultClockValueElement();
+
+                assert(pktIndexEntry.dst());
+                assert(pktIndexEntry.dst()->defaultClockType());
+                curTs = Ts {elem.cycles(), *pktIndexEntry.dst()->defaultClockType()};
+            }
+
+            break;
+        }
+
+        case yactfr::Element::Kind::EVENT_RECORD_END:
+        {
+            assert(er);
+            er->segment().len(it.offset() - pktOffsetInDsFileBits -
+                              er->segment().offsetInPktBits());
+
+            const auto cont = func(*er);
+
+            er = boost::none;
+            return cont;
+        }
+
+        default:
+            break;
+        }
+
+        if (er && erElemFunc && it->kind() != yactfr::Element::Kind::EVENT_RECORD_BEGINNING) {
+            erElemFunc(*it);
+        }
+
+        return true;
+    });
+}
+
+} // namespace jacques
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_PKT_DECODER_HPP
+#define _JACQUES_DATA_PKT_DECODER_HPP
+
+#include <memory>
+#include <functional>
+#include <boost/optional.hpp>
+#include <boost/core/noncopyable.hpp>
+#include <yactfr/yactfr.hpp>
+
+#include "aliases.hpp"
+#include "er.hpp"
+#include "ds-file.hpp"
+#include "metadata.hpp"
+#include "pkt-index-entry.hpp"
+
+namespace jacques {
+
+/*
+ * A lightweight, stateless packet decoder.
+ *
+ * A packet decoder owns its own data source factory and element
+ * sequence for a given data stream file, so that you can decode
+ * different packets of the same data stream file concurrently with one
+ * packet decoder per thread. A single packet decoder is NOT thread-safe.
+ *
+ * Contrary to DsFile::pktAtIndex(), a packet decoder doesn't create
+ * checkpoints, doesn't cache anything, and doesn't modify the data
+ * stream file: it only walks the elements of a packet once.
+ */
+class PktDecoder final :
+    boost::noncopyable
+{
+public:
+    /*
+     * Called for each decoded event record; return `false` to stop
+     * decoding the current packet.
+     */
+    using ErFunc = std::function<bool (const Er&)>;
+
+    /*
+     * Called for each element of a packet, after `it` is positioned on
+     * it; return `false` to stop decoding the current packet.
+     */
+    using ElemFunc = std::function<bool (const yactfr::ElementSequenceIterator&)>;
+
+    // called for each element within an event record
+    using ErElemFunc = std::function<void (const yactfr::Element&)>;
+
+public:
+    explicit PktDecoder(const DsFile& dsFile);
+
+    /*
+     * Calls `func` for each event record of the packet described by
+     * `pktIndexEntry`, in order.
+     *
+     * If `erElemFunc` is set, this method calls it for each element
+     * between the beginning and the end of each event record, before
+     * calling `func` for this event record.
+     *
+     * Returns `false` if `func` stopped the iteration, or `true` if
+     * this method reached the end of the packet or a decoding error.
+     */
+    bool forEachEr(const PktIndexEntry& pktIndexEntry, const ErFunc& func,
+                   const ErElemFunc& erElemFunc = {});
+
+    /*
+     * Calls `func` for each element of the packet described by
+     * `pktIndexEntry`, in order, from its beginning element to its end
+     * element.
+     *
+     * Returns `false` if `func` stopped the iteration, or `true` if
+     * this method reached the end of the packet or a decoding error.
+     */
+    bool forEachElem(const PktIndexEntry& pktIndexEntry, const ElemFunc& func);
+
+    /*
+     * Decoding error of the last packet which forEachElem() or
+     * forEachEr() decoded, if any.
+     */
+    const boost::optional<yactfr::DecodingError>& lastDecodingError() const noexcept
+    {
+        return _lastDecodingError;
+    }
+
+    const DsFile& dsFile() const noexcept
+    {
+        return *_dsFile;
+    }
+
+    const Metadata& metadata() const noexcept
+    {
+        return _dsFile->metadata();
+    }
+
+private:
+    yactfr::ElementSequenceIterator& _itAtPkt(const PktIndexEntry& pktIndexEntry);
+
+private:
+    const DsFile *_dsFile;
+    std::unique_ptr<yactfr::MemoryMappedFileViewFactory> _factory;
+    yactfr::ElementSequence _seq;
+    boost::optional<yactfr::ElementSequenceIterator> _it;
+    boost::optional<yactfr::DecodingError> _lastDecodingError;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_PKT_DECODER_HPP
@@ -25,7 +25,7 @@ Pkt::Pkt(const PktIndexEntry& indexEntry, yactfr::ElementSequence& seq, const Me
     _it {seq.begin()},
     _endIt {seq.end()},
     _checkpoints {
-        seq, metadata, *_indexEntry, 3779, pktCheckpointsBuildListener,
+        seq, metadata, *_indexEntry, 3779, 64, pktCheckpointsBuildListener,
     },
     _lruRegionCache {2000},
     _preambleLen {
@@ -116,32 +116,17 @@ void Pkt::_ensureOffsetInPktBitsIsCached(const Index offsetInPktBits)
         return;
     }
 
-    // find nearest event record checkpoint by offset
-    const auto cp = _checkpoints.nearestCheckpointBeforeOrAtOffsetInPktBits(offsetInPktBits);
-
-    assert(cp);
-
-    auto curIndex = cp->first->indexInPkt();
+    /*
+     * Find the closest event record before or containing the offset
+     * with the offset index: no decoding needed.
+     */
+    const auto& erOffsetIndex = _checkpoints.erOffsetIndex();
+    const auto erIndex = erOffsetIndex.erIndexBeforeOrAtOffsetInPktBits(offsetInPktBits);
 
-    _it.restorePosition(cp->second);
+    assert(erIndex);
 
-    // find closest event record before or containing offset
-    while (true) {
-        if (_it->isEventRecordBeginningElement()) {
-            if (this->_itOffsetInPktBits() == offsetInPktBits) {
-                break;
-            } else if (this->_itOffsetInPktBits() > offsetInPktBits) {
-                // we want the previous one which includes `offsetInPktBits`
-                assert(curIndex != 0);
-                --curIndex;
-                break;
-            }
-        } else if (_it->isEventRecordEndElement()) {
-            ++curIndex;
-        }
-
-        ++_it;
-    }
+    // the offset index can contain one more event record on decoding error
+    auto curIndex = std::min(*erIndex, lastEr.indexInPkt());
 
     // no we have its index: cache event records around this one
     this->_ensureErIsCached(curIndex);
@@ -774,28 +759,28 @@ const PktRegion *Pkt::previousRegion(const PktRegion& region)
 
 const Er *Pkt::erBeforeOrAtNsFromOrigin(const long long nsFromOrigin)
 {
-    const auto cpNearestFunc = [this](const long long nsFromOrigin) -> const PktCheckpoints::Checkpoint * {
-        return _checkpoints.nearestCheckpointBeforeOrAtNsFromOrigin(nsFromOrigin);
+    const auto tsIndexNearestFunc = [this](const long long nsFromOrigin) {
+        return _checkpoints.nearestTsIndexEntryBeforeOrAtNsFromOrigin(nsFromOrigin);
     };
 
     const auto getPropFunc = [](const Ts& ts) -> long long {
         return ts.nsFromOrigin();
     };
 
-    return this->_erBeforeOrAtTs(cpNearestFunc, getPropFunc, nsFromOrigin);
+    return this->_erBeforeOrAtTs(tsIndexNearestFunc, getPropFunc, nsFromOrigin);
 }
 
 const Er *Pkt::erBeforeOrAtCycles(const unsigned long long cycles)
 {
-    const auto cpNearestFunc = [this](const unsigned long long cycles) -> const PktCheckpoints::Checkpoint * {
-        return _checkpoints.nearestCheckpointBeforeOrAtCycles(cycles);
+    const auto tsIndexNearestFunc = [this](const unsigned long long cycles) {
+        return _checkpoints.nearestTsIndexEntryBeforeOrAtCycles(cycles);
     };
 
     const auto getPropFunc = [](const Ts& ts) -> unsigned long long {
         return ts.cycles();
     };
 
-    return this->_erBeforeOrAtTs(cpNearestFunc, getPropFunc, cycles);
+    return this->_erBeforeOrAtTs(tsIndexNearestFunc, getPropFunc, cycles);
 }
 
 } // namespace jacques
@@ -546,9 +546,17 @@ private:
         regions.push_back(std::static_pointer_cast<const PktRegion>(*it));
     }
 
-    template <typename CpNearestFuncT, typename GetProcFuncT, typename PropT>
-    const Er *_erBeforeOrAtTs(CpNearestFuncT&& cpNearestFunc, GetProcFuncT&& getProcFuncT,
-                              const PropT prop)
+    /*
+     * Finds the event record having the timestamp property `prop`, or
+     * the last one before it.
+     *
+     * `tsIndexNearestFunc` returns the timestamp index entry from which
+     * to decode: this decodes at most the timestamp index step event
+     * records.
+     */
+    template <typename TsIndexNearestFuncT, typename GetProcFuncT, typename PropT>
+    const Er *_erBeforeOrAtTs(TsIndexNearestFuncT&& tsIndexNearestFunc,
+                              GetProcFuncT&& getProcFuncT, const PropT prop)
     {
         if (!_metadata->isCorrelatable()) {
             return nullptr;
@@ -569,15 +577,15 @@ private:
             return er.get();
         }
 
-        const auto cp = cpNearestFunc(prop);
+        const auto tsIndexEntry = tsIndexNearestFunc(prop);
 
-        if (!cp) {
+        if (!tsIndexEntry) {
             return nullptr;
         }
 
-        _it.restorePosition(cp->second);
+        _it.restorePosition(tsIndexEntry->pos);
 
-        auto curIndex = cp->first->indexInPkt();
+        auto curIndex = tsIndexEntry->indexInPkt;
         auto inEr = false;
         boost::optional<Ts> ts;
         boost::optional<Index> indexInPkt;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <algorithm>
+
+#include "trace-time-index.hpp"
+
+namespace jacques {
+
+TraceTimeIndex::TraceTimeIndex(const std::vector<const DsFile *>& dsFiles)
+{
+    for (Index dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+        const auto& dsFile = *dsFiles[dsFileIndex];
+
+        if (!dsFile.metadata().isCorrelatable()) {
+            continue;
+        }
+
+        Entries entries;
+
+        for (const auto& pktIndexEntry : dsFile.pktIndexEntries()) {
+            if (!pktIndexEntry.beginTs() || !pktIndexEntry.endTs()) {
+                continue;
+            }
+
+            entries.push_back({
+                dsFileIndex, &pktIndexEntry, pktIndexEntry.beginTs()->nsFromOrigin(),
+                pktIndexEntry.endTs()->nsFromOrigin()
+            });
+        }
+
+        if (entries.empty()) {
+            continue;
+        }
+
+        // already sorted unless the timestamps are broken
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            return a.beginNsFromOrigin < b.beginNsFromOrigin;
+        });
+
+        _dsFileEntries.push_back(std::move(entries));
+        _isEmpty = false;
+    }
+}
+
+template <typename FuncT>
+std::vector<const TraceTimeIndex::Entry *> TraceTimeIndex::_entriesFromUpperBounds(const long long nsFromOrigin, FuncT&& func) const
+{
+    std::vector<const Entry *> entries;
+
+    for (const auto& dsFileEntries : _dsFileEntries) {
+        // first entry beginning after `nsFromOrigin`
+        const auto it = std::upper_bound(dsFileEntries.begin(), dsFileEntries.end(),
+                                         nsFromOrigin,
+                                         [](const auto nsFromOrigin, const auto& entry) {
+            return nsFromOrigin < entry.beginNsFromOrigin;
+        });
+
+        if (const auto entry = func(dsFileEntries, it)) {
+            entries.push_back(entry);
+        }
+    }
+
+    // stable: keep the data stream file order for equal beginning times
+    std::stable_sort(entries.begin(), entries.end(), [](const auto a, const auto b) {
+        return a->beginNsFromOrigin < b->beginNsFromOrigin;
+    });
+
+    return entries;
+}
+
+std::vector<const TraceTimeIndex::Entry *> TraceTimeIndex::lastEntriesAtOrBeforeNsFromOrigin(const long long nsFromOrigin) const
+{
+    return this->_entriesFromUpperBounds(nsFromOrigin, [](const auto& dsFileEntries,
+                                                          const auto it) {
+        if (it == dsFileEntries.begin()) {
+            return static_cast<const Entry *>(nullptr);
+        }
+
+        return &*(it - 1);
+    });
+}
+
+std::vector<const TraceTimeIndex::Entry *> TraceTimeIndex::firstEntriesAfterNsFromOrigin(const long long nsFromOrigin) const
+{
+    return this->_entriesFromUpperBounds(nsFromOrigin, [](const auto& dsFileEntries,
+                                                          const auto it) {
+        if (it == dsFileEntries.end()) {
+            return static_cast<const Entry *>(nullptr);
+        }
+
+        return &*it;
+    });
+}
+
+} // namespace jacques
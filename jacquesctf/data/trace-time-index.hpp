@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DATA_TRACE_TIME_INDEX_HPP
+#define _JACQUES_DATA_TRACE_TIME_INDEX_HPP
+
+#include <vector>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+#include "ds-file.hpp"
+#include "pkt-index-entry.hpp"
+
+namespace jacques {
+
+/*
+ * Time index of the packets of many data stream files.
+ *
+ * The index keeps, for each data stream file, the packets having a
+ * beginning and an end timestamp, sorted by beginning time. Finding
+ * the last packets beginning at or before a given time, or the first
+ * packets beginning after it, is one binary search per data stream
+ * file: O(F log N), F being the number of data stream files and N the
+ * number of packets per file, whatever the duration of the packets.
+ */
+class TraceTimeIndex final :
+    boost::noncopyable
+{
+public:
+    struct Entry
+    {
+        // index of the data stream file within the indexed ones
+        Index dsFileIndex;
+
+        const PktIndexEntry *pktIndexEntry;
+        long long beginNsFromOrigin;
+        long long endNsFromOrigin;
+    };
+
+    using Entries = std::vector<Entry>;
+
+public:
+    /*
+     * Builds a time index of the packets of `dsFiles`, which must all
+     * have a built packet index.
+     *
+     * Data stream files of which the metadata isn't correlatable are
+     * not indexed.
+     */
+    explicit TraceTimeIndex(const std::vector<const DsFile *>& dsFiles);
+
+    /*
+     * Returns the entries of the last packets beginning at or before
+     * `nsFromOrigin`, whether or not they end after it, at most one
+     * per data stream file, in beginning time order.
+     */
+    std::vector<const Entry *> lastEntriesAtOrBeforeNsFromOrigin(long long nsFromOrigin) const;
+
+    /*
+     * Returns the entries of the first packets beginning after
+     * `nsFromOrigin`, at most one per data stream file, in beginning
+     * time order.
+     */
+    std::vector<const Entry *> firstEntriesAfterNsFromOrigin(long long nsFromOrigin) const;
+
+    bool isEmpty() const noexcept
+    {
+        return _isEmpty;
+    }
+
+private:
+    template <typename FuncT>
+    std::vector<const Entry *> _entriesFromUpperBounds(long long nsFromOrigin,
+                                                       FuncT&& func) const;
+
+private:
+    // entries of each indexed data stream file
+    std::vector<Entries> _dsFileEntries;
+
+    bool _isEmpty = true;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DATA_TRACE_TIME_INDEX_HPP
@@ -0,0 +1,531 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "cfg.hpp"
+#include "diff-pkts-cmd.hpp"
+#include "cmd-error.hpp"
+#include "ds-file-set.hpp"
+#include "hash.hpp"
+#include "worker-pool.hpp"
+#include "utils.hpp"
+#include "data/ds-file.hpp"
+#include "data/mem-mapped-file.hpp"
+#include "data/pkt-decoder.hpp"
+
+namespace jacques {
+namespace {
+
+/*
+ * Data stream file to compare: its packet index, its whole mapped
+ * content, and the content hash of each packet.
+ */
+struct Side
+{
+    explicit Side(const boost::filesystem::path& path) :
+        dsFileSet {{path}},
+        mmapFile {path}
+    {
+        dsFileSet.buildIndexes(1);
+        mmapFile.map(0, mmapFile.fileLen());
+    }
+
+    const DsFile& dsFile() const noexcept
+    {
+        return *dsFileSet.dsFiles().front();
+    }
+
+    const PktIndexEntry& pktIndexEntry(const Index pktIndex) const noexcept
+    {
+        return this->dsFile().pktIndexEntries()[pktIndex];
+    }
+
+    // content of a packet, possibly truncated by the end of the file
+    const std::uint8_t *pktContent(const Index pktIndex, Size& lenBytes) const noexcept
+    {
+        const auto& indexEntry = this->pktIndexEntry(pktIndex);
+        const auto& contentLen = indexEntry.effectiveContentLen();
+        const auto fileLenBytes = mmapFile.fileLen().bytes();
+        const auto offsetBytes = std::min(indexEntry.offsetInDsFileBytes(), fileLenBytes);
+
+        lenBytes = std::min(contentLen.bytes() + (contentLen.hasExtraBits() ? 1 : 0),
+                            fileLenBytes - offsetBytes);
+
+        if (lenBytes == 0) {
+            return nullptr;
+        }
+
+        return mmapFile.addr() + offsetBytes;
+    }
+
+    DsFileSet dsFileSet;
+    MemMappedFile mmapFile;
+    std::vector<std::uint64_t> pktHashes;
+};
+
+/*
+ * Sets the packet content hashes of both sides in parallel.
+ */
+void hashPkts(Side& sideA, Side& sideB)
+{
+    const auto pktCountA = sideA.dsFile().pktCount();
+    const auto pktCount = pktCountA + sideB.dsFile().pktCount();
+    std::atomic<Index> nextIndex {0};
+
+    sideA.pktHashes.resize(pktCountA);
+    sideB.pktHashes.resize(sideB.dsFile().pktCount());
+
+    WorkerPool {}.run([&](Index) {
+        while (true) {
+            const auto index = nextIndex++;
+
+            if (index >= pktCount) {
+                return;
+            }
+
+            auto& side = index < pktCountA ? sideA : sideB;
+            const auto pktIndex = index < pktCountA ? index : index - pktCountA;
+            Size lenBytes;
+            const auto content = side.pktContent(pktIndex, lenBytes);
+
+            side.pktHashes[pktIndex] = hashData(content, lenBytes);
+        }
+    }, pktCount);
+}
+
+/*
+ * Returns the alignment to use for `align`.
+ *
+ * Throws `CmdError` if `align` is an explicit sequence number or
+ * timestamp alignment and some packets don't have this key: they
+ * couldn't be paired.
+ */
+DiffPktsCfg::Align effectiveAlign(const DiffPktsCfg::Align align, const Side& sideA,
+                                  const Side& sideB)
+{
+    const auto all = [&sideA, &sideB](const auto& pred) {
+        for (const auto side : {&sideA, &sideB}) {
+            const auto& entries = side->dsFile().pktIndexEntries();
+
+            if (!std::all_of(entries.begin(), entries.end(), pred)) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    const auto haveSeqNums = all([](const auto& entry) {
+        return static_cast<bool>(entry.seqNum());
+    });
+
+    const auto haveBeginTss = all([](const auto& entry) {
+        return static_cast<bool>(entry.beginTs());
+    });
+
+    switch (align) {
+    case DiffPktsCfg::Align::SEQ_NUM:
+        if (!haveSeqNums) {
+            throw CmdError {"Cannot pair packets by sequence number: some packets have none."};
+        }
+
+        return align;
+
+    case DiffPktsCfg::Align::TS:
+        if (!haveBeginTss) {
+            throw CmdError {
+                "Cannot pair packets by beginning timestamp: some packets have none."
+            };
+        }
+
+        return align;
+
+    case DiffPktsCfg::Align::AUTO:
+        if (haveSeqNums) {
+            return DiffPktsCfg::Align::SEQ_NUM;
+        }
+
+        if (haveBeginTss) {
+            return DiffPktsCfg::Align::TS;
+        }
+
+        return DiffPktsCfg::Align::INDEX;
+
+    default:
+        return align;
+    }
+}
+
+using PktKey = unsigned long long;
+
+/*
+ * Returns the alignment key of `entry`, ordered like the packets
+ * should be.
+ *
+ * `entry` must have this key (see effectiveAlign()).
+ */
+PktKey pktKey(const PktIndexEntry& entry, const DiffPktsCfg::Align align)
+{
+    switch (align) {
+    case DiffPktsCfg::Align::SEQ_NUM:
+        assert(entry.seqNum());
+        return static_cast<PktKey>(*entry.seqNum());
+
+    case DiffPktsCfg::Align::TS:
+        assert(entry.beginTs());
+
+        // flip the sign bit to keep the order of negative values
+        return static_cast<PktKey>(entry.beginTs()->nsFromOrigin()) ^ (1ULL << 63);
+
+    default:
+        return static_cast<PktKey>(entry.indexInDsFile());
+    }
+}
+
+/*
+ * Returns the packet indexes of `side` sorted by key.
+ */
+std::vector<std::pair<PktKey, Index>> sortedPktKeys(const Side& side,
+                                                    const DiffPktsCfg::Align align)
+{
+    std::vector<std::pair<PktKey, Index>> keys;
+    const auto& entries = side.dsFile().pktIndexEntries();
+
+    for (Index pktIndex = 0; pktIndex < entries.size(); ++pktIndex) {
+        keys.push_back({pktKey(entries[pktIndex], align), pktIndex});
+    }
+
+    // keep the file order of packets having the same key
+    std::stable_sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    return keys;
+}
+
+struct PktDiff
+{
+    enum class Kind {
+        ADDED,
+        REMOVED,
+        CHANGED,
+    };
+
+    Kind kind;
+    std::string key;
+    boost::optional<Index> pktIndexA;
+    boost::optional<Index> pktIndexB;
+
+    // changed packets: first differing byte within the packet
+    Index diffOffsetInPktBytes = 0;
+
+    // changed packets: event record containing this byte, if any
+    boost::optional<Index> erIndexInPkt;
+
+    // changed packets: description of the first differing region
+    std::string region;
+};
+
+std::string keyStr(const PktIndexEntry& entry, const DiffPktsCfg::Align align)
+{
+    switch (align) {
+    case DiffPktsCfg::Align::SEQ_NUM:
+        return std::to_string(*entry.seqNum());
+
+    case DiffPktsCfg::Align::TS:
+        return std::to_string(entry.beginTs()->nsFromOrigin());
+
+    default:
+        return std::to_string(entry.natIndexInDsFile());
+    }
+}
+
+/*
+ * Pairs the packets of both sides by key and returns the differences,
+ * in key order.
+ *
+ * This only compares packet content hashes and lengths: it doesn't set
+ * the first differing region of changed packets.
+ */
+std::vector<PktDiff> diffPkts(const Side& sideA, const Side& sideB,
+                              const DiffPktsCfg::Align align)
+{
+    const auto keysA = sortedPktKeys(sideA, align);
+    const auto keysB = sortedPktKeys(sideB, align);
+    auto itA = keysA.begin();
+    auto itB = keysB.begin();
+    std::vector<PktDiff> diffs;
+
+    while (itA != keysA.end() || itB != keysB.end()) {
+        PktDiff diff;
+
+        if (itB == keysB.end() || (itA != keysA.end() && itA->first < itB->first)) {
+            diff.kind = PktDiff::Kind::REMOVED;
+            diff.pktIndexA = itA->second;
+            diff.key = keyStr(sideA.pktIndexEntry(itA->second), align);
+            diffs.push_back(std::move(diff));
+            ++itA;
+            continue;
+        }
+
+        if (itA == keysA.end() || itB->first < itA->first) {
+            diff.kind = PktDiff::Kind::ADDED;
+            diff.pktIndexB = itB->second;
+            diff.key = keyStr(sideB.pktIndexEntry(itB->second), align);
+            diffs.push_back(std::move(diff));
+            ++itB;
+            continue;
+        }
+
+        // same key
+        const auto& entryA = sideA.pktIndexEntry(itA->second);
+        const auto& entryB = sideB.pktIndexEntry(itB->second);
+
+        if (entryA.effectiveContentLen().bits() != entryB.effectiveContentLen().bits() ||
+                sideA.pktHashes[itA->second] != sideB.pktHashes[itB->second]) {
+            diff.kind = PktDiff::Kind::CHANGED;
+            diff.pktIndexA = itA->second;
+            diff.pktIndexB = itB->second;
+            diff.key = keyStr(entryA, align);
+            diffs.push_back(std::move(diff));
+        }
+
+        ++itA;
+        ++itB;
+    }
+
+    return diffs;
+}
+
+/*
+ * Sets the first differing byte of the changed packet `diff`, and then
+ * decodes the packet of `sideA` to find which region contains it.
+ */
+void locateFirstDiff(PktDiff& diff, const Side& sideA, const Side& sideB, PktDecoder& decoderA)
+{
+    assert(diff.kind == PktDiff::Kind::CHANGED);
+
+    Size lenA, lenB;
+    const auto contentA = sideA.pktContent(*diff.pktIndexA, lenA);
+    const auto contentB = sideB.pktContent(*diff.pktIndexB, lenB);
+    const auto commonLen = std::min(lenA, lenB);
+
+    if (commonLen > 0) {
+        diff.diffOffsetInPktBytes = std::mismatch(contentA, contentA + commonLen,
+                                                  contentB).first - contentA;
+    }
+
+    if (diff.diffOffsetInPktBytes >= lenA) {
+        // packet B is a longer version of packet A
+        diff.region = "end of content";
+        return;
+    }
+
+    const auto diffOffsetInPktBits = diff.diffOffsetInPktBytes * 8;
+    boost::optional<std::string> erTypeName;
+
+    diff.region = "packet header or context";
+    decoderA.forEachEr(sideA.pktIndexEntry(*diff.pktIndexA), [&](const Er& er) {
+        const auto& segment = er.segment();
+
+        if (segment.offsetInPktBits() > diffOffsetInPktBits) {
+            // between two event records
+            return false;
+        }
+
+        if (diffOffsetInPktBits < *segment.endOffsetInPktBits()) {
+            diff.erIndexInPkt = er.indexInPkt();
+            diff.region = "event record " + std::to_string(er.indexInPkt() + 1);
+
+            if (er.type() && er.type()->name()) {
+                diff.region += " (`" + *er.type()->name() + "`)";
+            }
+
+            return false;
+        }
+
+        diff.region = "after event record " + std::to_string(er.indexInPkt() + 1);
+        return true;
+    });
+
+    if (decoderA.lastDecodingError()) {
+        diff.region += " (decoding error)";
+    }
+}
+
+/*
+ * Sets the first differing region of all the changed packets of
+ * `diffs` in parallel.
+ */
+void locateFirstDiffs(std::vector<PktDiff>& diffs, const Side& sideA, const Side& sideB)
+{
+    std::atomic<Index> nextIndex {0};
+
+    WorkerPool {}.run([&](Index) {
+        std::unique_ptr<PktDecoder> decoderA;
+
+        while (true) {
+            const auto index = nextIndex++;
+
+            if (index >= diffs.size()) {
+                return;
+            }
+
+            auto& diff = diffs[index];
+
+            if (diff.kind != PktDiff::Kind::CHANGED) {
+                continue;
+            }
+
+            if (!decoderA) {
+                decoderA = std::make_unique<PktDecoder>(sideA.dsFile());
+            }
+
+            locateFirstDiff(diff, sideA, sideB, *decoderA);
+        }
+    }, diffs.size());
+}
+
+const char *kindStr(const PktDiff::Kind kind) noexcept
+{
+    switch (kind) {
+    case PktDiff::Kind::ADDED:
+        return "added";
+
+    case PktDiff::Kind::REMOVED:
+        return "removed";
+
+    default:
+        return "changed";
+    }
+}
+
+// appends the natural (1-based) version of `index`, or `none`
+void appendOptNatIndex(std::string& out, const boost::optional<Index>& index,
+                       const char * const none)
+{
+    if (index) {
+        utils::appendUInt(out, *index + 1);
+    } else {
+        out += none;
+    }
+}
+
+void appendCsvLine(std::string& out, const PktDiff& diff, const Side& sideA, const Side& sideB)
+{
+    const auto isChanged = diff.kind == PktDiff::Kind::CHANGED;
+
+    out += kindStr(diff.kind);
+    out += ',';
+    out += diff.key;
+    out += ',';
+    appendOptNatIndex(out, diff.pktIndexA, "");
+    out += ',';
+    appendOptNatIndex(out, diff.pktIndexB, "");
+    out += ',';
+
+    if (diff.pktIndexA) {
+        utils::appendUInt(out, sideA.pktIndexEntry(*diff.pktIndexA).offsetInDsFileBytes());
+    }
+
+    out += ',';
+
+    if (diff.pktIndexB) {
+        utils::appendUInt(out, sideB.pktIndexEntry(*diff.pktIndexB).offsetInDsFileBytes());
+    }
+
+    out += ',';
+
+    if (isChanged) {
+        utils::appendUInt(out, diff.diffOffsetInPktBytes);
+    }
+
+    out += ',';
+    appendOptNatIndex(out, diff.erIndexInPkt, "");
+    out += ',';
+    utils::appendCsvField(out, diff.region);
+    out += '\n';
+}
+
+void appendJsonLine(std::string& out, const PktDiff& diff, const Side& sideA, const Side& sideB)
+{
+    out += "{\"kind\":\"";
+    out += kindStr(diff.kind);
+    out += "\",\"key\":";
+    out += diff.key;
+    out += ",\"index-a\":";
+    appendOptNatIndex(out, diff.pktIndexA, "null");
+    out += ",\"index-b\":";
+    appendOptNatIndex(out, diff.pktIndexB, "null");
+    out += ",\"offset-a-bytes\":";
+
+    if (diff.pktIndexA) {
+        utils::appendUInt(out, sideA.pktIndexEntry(*diff.pktIndexA).offsetInDsFileBytes());
+    } else {
+        out += "null";
+    }
+
+    out += ",\"offset-b-bytes\":";
+
+    if (diff.pktIndexB) {
+        utils::appendUInt(out, sideB.pktIndexEntry(*diff.pktIndexB).offsetInDsFileBytes());
+    } else {
+        out += "null";
+    }
+
+    if (diff.kind == PktDiff::Kind::CHANGED) {
+        out += ",\"diff-offset-in-packet-bytes\":";
+        utils::appendUInt(out, diff.diffOffsetInPktBytes);
+        out += ",\"event-record-index\":";
+        appendOptNatIndex(out, diff.erIndexInPkt, "null");
+        out += ",\"region\":";
+        utils::appendJsonStr(out, diff.region);
+    }
+
+    out += "}\n";
+}
+
+} // namespace
+
+bool diffPktsCmd(const DiffPktsCfg& cfg)
+{
+    Side sideA {cfg.pathA()};
+    Side sideB {cfg.pathB()};
+
+    hashPkts(sideA, sideB);
+
+    const auto align = effectiveAlign(cfg.align(), sideA, sideB);
+    auto diffs = diffPkts(sideA, sideB, align);
+
+    // only decode the changed packets
+    locateFirstDiffs(diffs, sideA, sideB);
+
+    std::string out;
+
+    for (const auto& diff : diffs) {
+        if (cfg.format() == DiffPktsCfg::Fmt::JSON_LINES) {
+            appendJsonLine(out, diff, sideA, sideB);
+        } else {
+            appendCsvLine(out, diff, sideA, sideB);
+        }
+    }
+
+    std::cout << out;
+    std::cout.flush();
+    return diffs.empty();
+}
+
+} // namespace jacques
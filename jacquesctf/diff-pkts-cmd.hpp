@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DIFF_PKTS_CMD_HPP
+#define _JACQUES_DIFF_PKTS_CMD_HPP
+
+#include "cfg.hpp"
+
+namespace jacques {
+
+/*
+ * Returns `true` if both data stream files have the same packets.
+ */
+bool diffPktsCmd(const DiffPktsCfg& cfg);
+
+} // namespace jacques
+
+#endif // _JACQUES_DIFF_PKTS_CMD_HPP
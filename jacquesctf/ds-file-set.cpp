@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <map>
+#include <atomic>
+
+#include "ds-file-set.hpp"
+#include "worker-pool.hpp"
+
+namespace jacques {
+
+namespace bfs = boost::filesystem;
+
+DsFileSet::DsFileSet(const std::vector<bfs::path>& dsFilePaths)
+{
+    // trace directory to index within `groupedDsFilePaths`
+    std::map<bfs::path, Index> traceDirIndexes;
+
+    // data stream file paths of each trace directory, in given order
+    std::vector<std::vector<bfs::path>> groupedDsFilePaths;
+
+    for (auto& dsfPath : dsFilePaths) {
+        const auto traceDirIndexIt = traceDirIndexes.emplace(dsfPath.parent_path(),
+                                                             groupedDsFilePaths.size()).first;
+
+        if (traceDirIndexIt->second == groupedDsFilePaths.size()) {
+            // new trace directory
+            groupedDsFilePaths.emplace_back();
+        }
+
+        groupedDsFilePaths[traceDirIndexIt->second].push_back(dsfPath);
+    }
+
+    for (const auto& traceDsFilePaths : groupedDsFilePaths) {
+        // create trace with specific data stream files
+        _traces.push_back(std::make_unique<Trace>(traceDsFilePaths));
+
+        for (auto& dsf : _traces.back()->dsFiles()) {
+            _dsFiles.push_back(dsf.get());
+        }
+    }
+}
+
+void DsFileSet::buildIndexes(const Size workerCount)
+{
+    // each data stream file has its own element sequence
+    std::atomic<Index> nextIndex {0};
+
+    WorkerPool {workerCount}.run([this, &nextIndex](Index) {
+        while (true) {
+            const auto index = nextIndex++;
+
+            if (index >= _dsFiles.size()) {
+                return;
+            }
+
+            _dsFiles[index]->buildIndex();
+        }
+    }, _dsFiles.size());
+}
+
+} // namespace jacques
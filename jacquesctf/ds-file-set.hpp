@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_DS_FILE_SET_HPP
+#define _JACQUES_DS_FILE_SET_HPP
+
+#include <memory>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+#include "data/trace.hpp"
+#include "data/ds-file.hpp"
+
+namespace jacques {
+
+/*
+ * Data stream files of one or more traces, as given to a command.
+ *
+ * The data stream files are grouped by trace directory (one trace
+ * object per directory), in the order in which each directory first
+ * appears, then in the given order within each directory. Therefore,
+ * the data stream files of a single trace keep the given order.
+ */
+class DsFileSet final :
+    boost::noncopyable
+{
+public:
+    explicit DsFileSet(const std::vector<boost::filesystem::path>& dsFilePaths);
+
+    /*
+     * Builds the packet indexes of all the data stream files, in
+     * parallel with `workerCount` threads (as many as there are
+     * hardware threads if 0).
+     */
+    void buildIndexes(Size workerCount = 0);
+
+    const std::vector<DsFile *>& dsFiles() const noexcept
+    {
+        return _dsFiles;
+    }
+
+    std::vector<const DsFile *> constDsFiles() const
+    {
+        return {_dsFiles.begin(), _dsFiles.end()};
+    }
+
+private:
+    std::vector<std::unique_ptr<Trace>> _traces;
+    std::vector<DsFile *> _dsFiles;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_DS_FILE_SET_HPP
@@ -0,0 +1,1134 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <boost/endian/buffers.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <boost/core/noncopyable.hpp>
+#include <yactfr/yactfr.hpp>
+
+#include "cfg.hpp"
+#include "export-columnar-cmd.hpp"
+#include "cmd-error.hpp"
+#include "ds-file-set.hpp"
+#include "io-error.hpp"
+#include "ordered-chunk-queue.hpp"
+#include "utils.hpp"
+#include "worker-pool.hpp"
+#include "data/trace.hpp"
+#include "data/ds-file.hpp"
+#include "data/pkt-decoder.hpp"
+
+namespace jacques {
+namespace {
+
+namespace bfs = boost::filesystem;
+namespace bendian = boost::endian;
+
+/*
+ * Output format: the output directory contains `manifest.json` and
+ * one directory per event record type, named `T-DSTID-ERTID`, `T`
+ * being the natural index of its trace within the `traces` array of
+ * the manifest: the IDs of data stream and event record types are only
+ * unique within a trace.
+ *
+ * Each event record type has one row per event record and one column
+ * per scalar field (not within an array) of its header, common
+ * context, specific context, and payload, named after the scope
+ * (`header`, `ctx`, `sctx`, or `payload`) and the path of the field,
+ * for example `payload/msg/len`. Variants and optional fields are
+ * transparent. Each event record type also has the following columns:
+ *
+ * `ds-file-index` (`u64`):
+ *     Natural index of the data stream file within the
+ *     `data-stream-files` array of the manifest.
+ *
+ * `packet-index` (`u64`):
+ *     Natural index of the packet within its data stream file.
+ *
+ * `index` (`u64`):
+ *     Natural index of the event record within its packet.
+ *
+ * `offset-bits` (`u64`):
+ *     Offset of the event record within its data stream file (bits).
+ *
+ * `ts-cycles` (`u64`) and `ts-ns` (`s64`):
+ *     Timestamp of the event record.
+ *
+ * The rows are in data stream file, packet, then event record order.
+ *
+ * Each column has the following files, `N` being its index within
+ * the `columns` array of its event record type in the manifest:
+ *
+ * `N.validity`:
+ *     One byte per row: 1 if the row has a value, or 0 otherwise (for
+ *     example, a disabled optional field).
+ *
+ * `N.values`:
+ *     `u64`, `s64`, `f64`: 8 bytes per row (little-endian; IEEE 754
+ *     binary64 for `f64`).
+ *
+ *     `bool`: 1 byte per row (0 or 1).
+ *
+ *     `string`, `blob`: the concatenated bytes of all the values
+ *     (strings are UTF-8 and not null-terminated).
+ *
+ *     A row without any value is zero or empty.
+ *
+ * `N.offsets` (`string` and `blob` columns only):
+ *     Row count + 1 little-endian 64-bit offsets within `N.values`:
+ *     the value of row `i` is the bytes from offset `i` to offset
+ *     `i + 1` (excluded).
+ *
+ * A field having values of different types (through variants, for
+ * example) has one column per type.
+ */
+
+enum class ColType {
+    U64,
+    S64,
+    F64,
+    BOOL,
+    STR,
+    BLOB,
+};
+
+const char *colTypeName(const ColType type) noexcept
+{
+    switch (type) {
+    case ColType::U64:
+        return "u64";
+
+    case ColType::S64:
+        return "s64";
+
+    case ColType::F64:
+        return "f64";
+
+    case ColType::BOOL:
+        return "bool";
+
+    case ColType::STR:
+        return "string";
+
+    case ColType::BLOB:
+        return "blob";
+
+    default:
+        std::abort();
+    }
+}
+
+bool isVarLenColType(const ColType type) noexcept
+{
+    return type == ColType::STR || type == ColType::BLOB;
+}
+
+using ColKey = std::pair<std::string, ColType>;
+
+/*
+ * Values of one column within the event records of a single event
+ * record type within a single packet.
+ */
+struct ColChunk
+{
+    // row (within the packet) of each value
+    std::vector<Index> rows;
+
+    // encoded fixed-width values, or concatenated variable-length values
+    std::string data;
+
+    // lengths of the variable-length values
+    std::vector<Size> lens;
+};
+
+struct ErtChunk
+{
+    Size rowCount = 0;
+    std::map<ColKey, ColChunk> cols;
+};
+
+/*
+ * Decoded columns of a single packet.
+ *
+ * The packet index entry gives the data stream type of all the event
+ * record types.
+ */
+struct PktChunk
+{
+    Index dsFileIndex = 0;
+    const PktIndexEntry *pktIndexEntry = nullptr;
+    std::map<const yactfr::EventRecordType *, ErtChunk> erts;
+
+    // error message if the packet couldn't be fully decoded
+    std::string errorMsg;
+};
+
+void appendU64(std::string& data, const std::uint64_t val)
+{
+    const bendian::little_uint64_buf_t buf {val};
+
+    data.append(reinterpret_cast<const char *>(&buf), sizeof(buf));
+}
+
+/*
+ * Event record column value collector.
+ *
+ * Feed all the elements of an event record, in order, to feed(), then
+ * call commit() with the event record.
+ */
+class ErValCollector final :
+    boost::noncopyable
+{
+public:
+    explicit ErValCollector(const Index dsFileIndex, PktChunk& pktChunk) :
+        _dsFileIndex {dsFileIndex},
+        _pktChunk {&pktChunk}
+    {
+    }
+
+    void feed(const yactfr::Element& elem);
+    void commit(const Er& er);
+
+private:
+    struct _PendingVal
+    {
+        ColKey key;
+        std::string data;
+    };
+
+private:
+    static const std::string *_memberName(const yactfr::Element& elem) noexcept
+    {
+        auto& dataElem = static_cast<const yactfr::DataElement&>(elem);
+        const auto memberType = dataElem.structureMemberType();
+
+        if (!memberType) {
+            return nullptr;
+        }
+
+        return memberType->displayName() ? &*memberType->displayName() : &memberType->name();
+    }
+
+    std::string _colName(const yactfr::Element& elem);
+    void _beginStruct(const yactfr::Element& elem);
+    void _endStruct();
+
+    _PendingVal *_beginVal(const yactfr::Element& elem, ColType type);
+
+    void _appendU64(const yactfr::Element& elem, ColType type, std::uint64_t val)
+    {
+        if (const auto pendingVal = this->_beginVal(elem, type)) {
+            appendU64(pendingVal->data, val);
+        }
+    }
+
+private:
+    const Index _dsFileIndex;
+    PktChunk *_pktChunk;
+    std::vector<_PendingVal> _pendingVals;
+
+    // scope and member names of the current structure, joined with `/`
+    std::string _prefix;
+
+    // length of `_prefix` when beginning each current structure
+    std::vector<Size> _prefixLens;
+
+    // name of the variant or optional field which contains the next value
+    const std::string *_pendingName = nullptr;
+
+    Size _arrayDepth = 0;
+    bool _inScope = false;
+
+    // current string or BLOB value, if any
+    _PendingVal *_varLenVal = nullptr;
+
+    bool _strEnded = false;
+};
+
+std::string ErValCollector::_colName(const yactfr::Element& elem)
+{
+    auto name = _memberName(elem);
+
+    if (!name) {
+        name = _pendingName;
+    }
+
+    _pendingName = nullptr;
+
+    std::string colName = _prefix;
+
+    colName += '/';
+
+    if (name) {
+        colName += *name;
+    }
+
+    return colName;
+}
+
+void ErValCollector::_beginStruct(const yactfr::Element& elem)
+{
+    _prefixLens.push_back(_prefix.size());
+
+    if (_prefixLens.size() == 1) {
+        // root structure of the scope: `_prefix` is the scope name
+        return;
+    }
+
+    _prefix = this->_colName(elem);
+}
+
+void ErValCollector::_endStruct()
+{
+    assert(!_prefixLens.empty());
+    _prefix.resize(_prefixLens.back());
+    _prefixLens.pop_back();
+}
+
+ErValCollector::_PendingVal *ErValCollector::_beginVal(const yactfr::Element& elem,
+                                                       const ColType type)
+{
+    if (_arrayDepth > 0 || !_inScope) {
+        // no fixed row for fields within arrays
+        _pendingName = nullptr;
+        return nullptr;
+    }
+
+    _pendingVals.push_back({{this->_colName(elem), type}, {}});
+    return &_pendingVals.back();
+}
+
+void ErValCollector::feed(const yactfr::Element& elem)
+{
+    using ElemKind = yactfr::Element::Kind;
+
+    switch (elem.kind()) {
+    case ElemKind::SCOPE_BEGINNING:
+        switch (elem.asScopeBeginningElement().scope()) {
+        case yactfr::Scope::EVENT_RECORD_HEADER:
+            _prefix = "header";
+            break;
+
+        case yactfr::Scope::EVENT_RECORD_COMMON_CONTEXT:
+            _prefix = "ctx";
+            break;
+
+        case yactfr::Scope::EVENT_RECORD_SPECIFIC_CONTEXT:
+            _prefix = "sctx";
+            break;
+
+        case yactfr::Scope::EVENT_RECORD_PAYLOAD:
+            _prefix = "payload";
+            break;
+
+        default:
+            return;
+        }
+
+        _inScope = true;
+        _prefixLens.clear();
+        _arrayDepth = 0;
+        break;
+
+    case ElemKind::SCOPE_END:
+        _inScope = false;
+        break;
+
+    case ElemKind::FIXED_LENGTH_BIT_ARRAY:
+        this->_appendU64(elem, ColType::U64,
+                         elem.asFixedLengthBitArrayElement().unsignedIntegerValue());
+        break;
+
+    case ElemKind::FIXED_LENGTH_BOOLEAN:
+        if (const auto pendingVal = this->_beginVal(elem, ColType::BOOL)) {
+            pendingVal->data +=
+                static_cast<const yactfr::FixedLengthBooleanElement&>(elem).value() ? '\1' : '\0';
+        }
+
+        break;
+
+    case ElemKind::FIXED_LENGTH_SIGNED_INTEGER:
+    case ElemKind::FIXED_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::FixedLengthSignedIntegerElement&>(elem);
+
+        this->_appendU64(elem, ColType::S64, intElem.value());
+        break;
+    }
+
+    case ElemKind::FIXED_LENGTH_UNSIGNED_INTEGER:
+    case ElemKind::FIXED_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::FixedLengthUnsignedIntegerElement&>(elem);
+
+        this->_appendU64(elem, ColType::U64, intElem.value());
+        break;
+    }
+
+    case ElemKind::FIXED_LENGTH_FLOATING_POINT_NUMBER:
+    {
+        const double val =
+            static_cast<const yactfr::FixedLengthFloatingPointNumberElement&>(elem).value();
+        std::uint64_t bits;
+
+        std::memcpy(&bits, &val, sizeof(bits));
+        this->_appendU64(elem, ColType::F64, bits);
+        break;
+    }
+
+    case ElemKind::VARIABLE_LENGTH_SIGNED_INTEGER:
+    case ElemKind::VARIABLE_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::VariableLengthSignedIntegerElement&>(elem);
+
+        this->_appendU64(elem, ColType::S64, intElem.value());
+        break;
+    }
+
+    case ElemKind::VARIABLE_LENGTH_UNSIGNED_INTEGER:
+    case ElemKind::VARIABLE_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::VariableLengthUnsignedIntegerElement&>(elem);
+
+        this->_appendU64(elem, ColType::U64, intElem.value());
+        break;
+    }
+
+    case ElemKind::NULL_TERMINATED_STRING_BEGINNING:
+    case ElemKind::STATIC_LENGTH_STRING_BEGINNING:
+    case ElemKind::DYNAMIC_LENGTH_STRING_BEGINNING:
+        _varLenVal = this->_beginVal(elem, ColType::STR);
+        _strEnded = false;
+        break;
+
+    case ElemKind::SUBSTRING:
+    {
+        if (!_varLenVal || _strEnded) {
+            break;
+        }
+
+        auto& substrElem = elem.asSubstringElement();
+        const auto end = substrElem.begin() + substrElem.size();
+        const auto strEnd = std::find(substrElem.begin(), end, '\0');
+
+        _varLenVal->data.append(substrElem.begin(), strEnd);
+        _strEnded = strEnd != end;
+        break;
+    }
+
+    case ElemKind::STATIC_LENGTH_BLOB_BEGINNING:
+    case ElemKind::DYNAMIC_LENGTH_BLOB_BEGINNING:
+        _varLenVal = this->_beginVal(elem, ColType::BLOB);
+        break;
+
+    case ElemKind::BLOB_SECTION:
+    {
+        if (!_varLenVal) {
+            break;
+        }
+
+        auto& sectionElem = elem.asBlobSectionElement();
+
+        _varLenVal->data.append(reinterpret_cast<const char *>(sectionElem.begin()),
+                                reinterpret_cast<const char *>(sectionElem.end()));
+        break;
+    }
+
+    case ElemKind::NULL_TERMINATED_STRING_END:
+    case ElemKind::STATIC_LENGTH_STRING_END:
+    case ElemKind::DYNAMIC_LENGTH_STRING_END:
+    case ElemKind::STATIC_LENGTH_BLOB_END:
+    case ElemKind::DYNAMIC_LENGTH_BLOB_END:
+        _varLenVal = nullptr;
+        break;
+
+    case ElemKind::STRUCTURE_BEGINNING:
+        if (_inScope && _arrayDepth == 0) {
+            this->_beginStruct(elem);
+        }
+
+        break;
+
+    case ElemKind::STRUCTURE_END:
+        if (_inScope && _arrayDepth == 0) {
+            this->_endStruct();
+        }
+
+        break;
+
+    case ElemKind::STATIC_LENGTH_ARRAY_BEGINNING:
+    case ElemKind::DYNAMIC_LENGTH_ARRAY_BEGINNING:
+        ++_arrayDepth;
+        _pendingName = nullptr;
+        break;
+
+    case ElemKind::STATIC_LENGTH_ARRAY_END:
+    case ElemKind::DYNAMIC_LENGTH_ARRAY_END:
+        assert(_arrayDepth > 0);
+        --_arrayDepth;
+        break;
+
+    case ElemKind::VARIANT_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING:
+    case ElemKind::VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING:
+    case ElemKind::OPTIONAL_WITH_BOOLEAN_SELECTOR_BEGINNING:
+    case ElemKind::OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING:
+    case ElemKind::OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING:
+        if (const auto name = _memberName(elem)) {
+            _pendingName = name;
+        }
+
+        break;
+
+    default:
+        break;
+    }
+}
+
+void ErValCollector::commit(const Er& er)
+{
+    if (!er.type()) {
+        _pendingVals.clear();
+        return;
+    }
+
+    auto& ertChunk = _pktChunk->erts[er.type()];
+    const auto row = ertChunk.rowCount;
+    const auto& pktIndexEntry = *_pktChunk->pktIndexEntry;
+
+    const auto addU64 = [&ertChunk, row](const char * const name, const ColType type,
+                                         const std::uint64_t val) {
+        auto& colChunk = ertChunk.cols[{name, type}];
+
+        colChunk.rows.push_back(row);
+        appendU64(colChunk.data, val);
+    };
+
+    addU64("ds-file-index", ColType::U64, _dsFileIndex + 1);
+    addU64("packet-index", ColType::U64, pktIndexEntry.natIndexInDsFile());
+    addU64("index", ColType::U64, er.natIndexInPkt());
+    addU64("offset-bits", ColType::U64,
+           pktIndexEntry.offsetInDsFileBits() + er.segment().offsetInPktBits());
+
+    if (er.ts()) {
+        addU64("ts-cycles", ColType::U64, er.ts()->cycles());
+        addU64("ts-ns", ColType::S64, static_cast<std::uint64_t>(er.ts()->nsFromOrigin()));
+    }
+
+    for (auto& pendingVal : _pendingVals) {
+        const auto type = pendingVal.key.second;
+        auto& colChunk = ertChunk.cols[std::move(pendingVal.key)];
+
+        colChunk.rows.push_back(row);
+
+        if (isVarLenColType(type)) {
+            colChunk.lens.push_back(pendingVal.data.size());
+        }
+
+        colChunk.data += pendingVal.data;
+    }
+
+    _pendingVals.clear();
+    ++ertChunk.rowCount;
+}
+
+/*
+ * Output file which only stays open while appending its buffered
+ * data, so that the output may have many more files than the
+ * process may open at once.
+ */
+class OutFile final :
+    boost::noncopyable
+{
+public:
+    explicit OutFile(bfs::path path) :
+        _path {std::move(path)}
+    {
+    }
+
+    std::string& buf() noexcept
+    {
+        return _buf;
+    }
+
+    void flushIfFull()
+    {
+        if (_buf.size() >= 1 << 18) {
+            this->flush();
+        }
+    }
+
+    void flush();
+
+    const bfs::path& path() const noexcept
+    {
+        return _path;
+    }
+
+private:
+    const bfs::path _path;
+    std::string _buf;
+    bool _isCreated = false;
+};
+
+void OutFile::flush()
+{
+    if (_buf.empty() && _isCreated) {
+        return;
+    }
+
+    const auto fd = ::open(_path.string().c_str(),
+                           O_WRONLY | O_CREAT | (_isCreated ? O_APPEND : O_TRUNC), 0644);
+
+    if (fd < 0) {
+        throwIOError(_path, "open");
+    }
+
+    _isCreated = true;
+
+    Size writtenLen = 0;
+
+    while (writtenLen < _buf.size()) {
+        const auto ret = ::write(fd, _buf.data() + writtenLen, _buf.size() - writtenLen);
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ::close(fd);
+            throwIOError(_path, "write");
+        }
+
+        writtenLen += static_cast<Size>(ret);
+    }
+
+    if (::close(fd) != 0) {
+        throwIOError(_path, "close");
+    }
+
+    _buf.clear();
+}
+
+/*
+ * Writer of the files of one column.
+ */
+class ColWriter final :
+    boost::noncopyable
+{
+public:
+    explicit ColWriter(const bfs::path& dirPath, const Index index, const ColType type) :
+        _type {type},
+        _validityFile {dirPath / (std::to_string(index) + ".validity")},
+        _valsFile {dirPath / (std::to_string(index) + ".values")}
+    {
+        if (isVarLenColType(type)) {
+            _offsetsFile = std::make_unique<OutFile>(dirPath /
+                                                     (std::to_string(index) + ".offsets"));
+            appendU64(_offsetsFile->buf(), 0);
+        }
+    }
+
+    /*
+     * Appends rows without any value until this column has `rowCount`
+     * rows.
+     */
+    void padTo(Size rowCount);
+
+    /*
+     * Appends the values of `colChunk`, of which the rows are relative
+     * to `baseRow`.
+     */
+    void append(const ColChunk& colChunk, Index baseRow);
+
+    void finish(Size rowCount);
+
+    ColType type() const noexcept
+    {
+        return _type;
+    }
+
+private:
+    void _flushIfFull()
+    {
+        _validityFile.flushIfFull();
+        _valsFile.flushIfFull();
+
+        if (_offsetsFile) {
+            _offsetsFile->flushIfFull();
+        }
+    }
+
+private:
+    const ColType _type;
+    OutFile _validityFile;
+    OutFile _valsFile;
+    std::unique_ptr<OutFile> _offsetsFile;
+    Size _rowCount = 0;
+    Size _valsLen = 0;
+};
+
+void ColWriter::padTo(const Size rowCount)
+{
+    assert(rowCount >= _rowCount);
+
+    const auto count = rowCount - _rowCount;
+
+    _validityFile.buf().append(count, '\0');
+
+    if (_offsetsFile) {
+        for (Index i = 0; i < count; ++i) {
+            appendU64(_offsetsFile->buf(), _valsLen);
+        }
+    } else {
+        _valsFile.buf().append(count * (_type == ColType::BOOL ? 1 : 8), '\0');
+    }
+
+    _rowCount = rowCount;
+}
+
+void ColWriter::append(const ColChunk& colChunk, const Index baseRow)
+{
+    Index dataOffset = 0;
+
+    for (Index i = 0; i < colChunk.rows.size(); ++i) {
+        this->padTo(baseRow + colChunk.rows[i]);
+        _validityFile.buf() += '\1';
+
+        if (_offsetsFile) {
+            const auto len = colChunk.lens[i];
+
+            _valsFile.buf().append(colChunk.data, dataOffset, len);
+            dataOffset += len;
+            _valsLen += len;
+            appendU64(_offsetsFile->buf(), _valsLen);
+        } else {
+            const auto len = _type == ColType::BOOL ? 1 : 8;
+
+            _valsFile.buf().append(colChunk.data, dataOffset, len);
+            dataOffset += len;
+        }
+
+        ++_rowCount;
+    }
+
+    this->_flushIfFull();
+}
+
+void ColWriter::finish(const Size rowCount)
+{
+    this->padTo(rowCount);
+    _validityFile.flush();
+    _valsFile.flush();
+
+    if (_offsetsFile) {
+        _offsetsFile->flush();
+    }
+}
+
+/*
+ * Columns of an event record type.
+ */
+struct ErtCols
+{
+    const yactfr::EventRecordType *ert;
+    const yactfr::DataStreamType *dst;
+    Index traceIndex;
+    std::string dirName;
+    Size rowCount = 0;
+
+    // in creation order: index within the manifest
+    std::vector<std::pair<ColKey, std::unique_ptr<ColWriter>>> cols;
+
+    std::map<ColKey, ColWriter *> colWriters;
+};
+
+/*
+ * Merges decoded packet chunks of the data stream files `dsFiles`, in
+ * order, into the column files of an output directory.
+ */
+class ColsMerger final :
+    boost::noncopyable
+{
+public:
+    explicit ColsMerger(bfs::path dirPath, const std::vector<const DsFile *>& dsFiles);
+
+    void merge(const PktChunk& pktChunk);
+    void finish();
+
+private:
+    ErtCols& _ertColsFor(const yactfr::EventRecordType& ert, const yactfr::DataStreamType *dst,
+                         Index traceIndex);
+    void _writeManifest();
+
+private:
+    const bfs::path _dirPath;
+    const std::vector<const DsFile *>& _dsFiles;
+
+    // trace index of each data stream file
+    std::vector<Index> _dsFileTraceIndexes;
+
+    // directory of each trace
+    std::vector<bfs::path> _traceDirPaths;
+
+    // in creation order
+    std::vector<std::unique_ptr<ErtCols>> _ertCols;
+
+    std::map<const yactfr::EventRecordType *, ErtCols *> _ertColsMap;
+};
+
+ColsMerger::ColsMerger(bfs::path dirPath, const std::vector<const DsFile *>& dsFiles) :
+    _dirPath {std::move(dirPath)},
+    _dsFiles {dsFiles}
+{
+    std::map<const Trace *, Index> traceIndexes;
+
+    for (const auto dsf : dsFiles) {
+        const auto it = traceIndexes.find(&dsf->trace());
+
+        if (it != traceIndexes.end()) {
+            _dsFileTraceIndexes.push_back(it->second);
+            continue;
+        }
+
+        traceIndexes[&dsf->trace()] = _traceDirPaths.size();
+        _dsFileTraceIndexes.push_back(_traceDirPaths.size());
+        _traceDirPaths.push_back(dsf->path().parent_path());
+    }
+}
+
+ErtCols& ColsMerger::_ertColsFor(const yactfr::EventRecordType& ert,
+                                 const yactfr::DataStreamType * const dst,
+                                 const Index traceIndex)
+{
+    const auto it = _ertColsMap.find(&ert);
+
+    if (it != _ertColsMap.end()) {
+        return *it->second;
+    }
+
+    auto ertCols = std::make_unique<ErtCols>();
+    std::ostringstream ss;
+
+    /*
+     * Event record type IDs are only unique within a data stream type,
+     * and data stream type IDs within a trace.
+     */
+    ss << traceIndex + 1 << '-' << (dst ? dst->id() : 0) << '-' << ert.id();
+    ertCols->ert = &ert;
+    ertCols->dst = dst;
+    ertCols->traceIndex = traceIndex;
+    ertCols->dirName = ss.str();
+    bfs::create_directories(_dirPath / ertCols->dirName);
+    _ertColsMap[&ert] = ertCols.get();
+    _ertCols.push_back(std::move(ertCols));
+    return *_ertCols.back();
+}
+
+void ColsMerger::merge(const PktChunk& pktChunk)
+{
+    for (const auto& ertChunkPair : pktChunk.erts) {
+        auto& ertCols = this->_ertColsFor(*ertChunkPair.first, pktChunk.pktIndexEntry->dst(),
+                                          _dsFileTraceIndexes[pktChunk.dsFileIndex]);
+        const auto& ertChunk = ertChunkPair.second;
+
+        for (const auto& colChunkPair : ertChunk.cols) {
+            auto& colWriter = ertCols.colWriters[colChunkPair.first];
+
+            if (!colWriter) {
+                auto newColWriter = std::make_unique<ColWriter>(_dirPath / ertCols.dirName,
+                                                                ertCols.cols.size(),
+                                                                colChunkPair.first.second);
+
+                colWriter = newColWriter.get();
+                ertCols.cols.emplace_back(colChunkPair.first, std::move(newColWriter));
+            }
+
+            colWriter->append(colChunkPair.second, ertCols.rowCount);
+        }
+
+        ertCols.rowCount += ertChunk.rowCount;
+    }
+}
+
+void ColsMerger::finish()
+{
+    for (auto& ertCols : _ertCols) {
+        for (auto& col : ertCols->cols) {
+            col.second->finish(ertCols->rowCount);
+        }
+    }
+
+    this->_writeManifest();
+}
+
+void ColsMerger::_writeManifest()
+{
+    OutFile file {_dirPath / "manifest.json"};
+    auto& out = file.buf();
+
+    out += "{\"version\":1,\"traces\":[";
+
+    for (Index i = 0; i < _traceDirPaths.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+
+        utils::appendJsonStr(out, _traceDirPaths[i].string());
+    }
+
+    out += "],\"data-stream-files\":[";
+
+    for (Index i = 0; i < _dsFiles.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+
+        utils::appendJsonStr(out, _dsFiles[i]->path().string());
+    }
+
+    out += "],\"event-record-types\":[";
+
+    for (Index ertIndex = 0; ertIndex < _ertCols.size(); ++ertIndex) {
+        const auto& ertCols = *_ertCols[ertIndex];
+
+        if (ertIndex > 0) {
+            out += ',';
+        }
+
+        out += "\n{\"trace-index\":";
+        utils::appendUInt(out, ertCols.traceIndex + 1);
+        out += ",\"data-stream-type-id\":";
+
+        if (ertCols.dst) {
+            utils::appendUInt(out, ertCols.dst->id());
+        } else {
+            out += "null";
+        }
+
+        out += ",\"id\":";
+        utils::appendUInt(out, ertCols.ert->id());
+        out += ",\"name\":";
+
+        if (ertCols.ert->name()) {
+            utils::appendJsonStr(out, *ertCols.ert->name());
+        } else {
+            out += "null";
+        }
+
+        out += ",\"directory\":";
+        utils::appendJsonStr(out, ertCols.dirName);
+        out += ",\"row-count\":";
+        utils::appendUInt(out, ertCols.rowCount);
+        out += ",\"columns\":[";
+
+        for (Index colIndex = 0; colIndex < ertCols.cols.size(); ++colIndex) {
+            const auto& key = ertCols.cols[colIndex].first;
+
+            if (colIndex > 0) {
+                out += ',';
+            }
+
+            out += "{\"name\":";
+            utils::appendJsonStr(out, key.first);
+            out += ",\"type\":\"";
+            out += colTypeName(key.second);
+            out += "\"}";
+        }
+
+        out += "]}";
+    }
+
+    out += "\n]}\n";
+    file.flush();
+}
+
+/*
+ * Decodes the packet at index `pktIndex` within `dsf` into `pktChunk`.
+ *
+ * If the packet can't be fully decoded, `pktChunk` contains the event
+ * records preceding the error and an error message.
+ */
+void decodePkt(PktDecoder& decoder, const Index dsFileIndex, const Index pktIndex,
+               PktChunk& pktChunk)
+{
+    const auto& pktIndexEntry = decoder.dsFile().pktIndexEntry(pktIndex);
+
+    pktChunk.dsFileIndex = dsFileIndex;
+    pktChunk.pktIndexEntry = &pktIndexEntry;
+
+    ErValCollector collector {dsFileIndex, pktChunk};
+
+    decoder.forEachEr(pktIndexEntry, [&collector](const Er& er) {
+        collector.commit(er);
+        return true;
+    }, [&collector](const yactfr::Element& elem) {
+        collector.feed(elem);
+    });
+
+    if (const auto& error = decoder.lastDecodingError()) {
+        std::ostringstream ss;
+
+        ss << "Cannot decode packet " << pktIndexEntry.natIndexInDsFile() <<
+              " of data stream file `" << decoder.dsFile().path().string() << "` at offset " <<
+              error->offset() << " bits: " << error->reason();
+        pktChunk.errorMsg = ss.str();
+    }
+}
+
+} // namespace
+
+bool exportColumnarCmd(const ExportColumnarCfg& cfg)
+{
+    if (bfs::exists(cfg.dstDirPath()) && !bfs::is_empty(cfg.dstDirPath())) {
+        std::ostringstream ss;
+
+        ss << "Output directory `" << cfg.dstDirPath().string() << "` is not empty.";
+        throw CmdError {ss.str()};
+    }
+
+    DsFileSet dsFileSet {cfg.paths()};
+
+    dsFileSet.buildIndexes();
+    bfs::create_directories(cfg.dstDirPath());
+
+    const auto dsFiles = dsFileSet.constDsFiles();
+
+    struct Unit
+    {
+        Index dsFileIndex;
+        Index pktIndex;
+    };
+
+    std::vector<Unit> units;
+
+    for (Index dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+        for (Index pktIndex = 0; pktIndex < dsFiles[dsFileIndex]->pktCount(); ++pktIndex) {
+            units.push_back({dsFileIndex, pktIndex});
+        }
+    }
+
+    if (units.empty()) {
+        ColsMerger {cfg.dstDirPath(), dsFiles}.finish();
+        return true;
+    }
+
+    /*
+     * Workers decode the packets in parallel while this thread merges
+     * them in order: the ordered chunk queue bounds how far ahead of
+     * the merger the workers may go, and therefore the memory usage.
+     */
+    const WorkerPool pool;
+    OrderedChunkQueue<PktChunk> queue {pool.workerCount() * 8};
+    std::atomic<Index> nextUnitIndex {0};
+    std::exception_ptr exc;
+
+    const auto work = [&](Index) {
+        /*
+         * Units are ordered by data stream file, so a worker mostly
+         * gets consecutive packets of the same data stream file: only
+         * keep the decoder of the current one.
+         */
+        std::unique_ptr<PktDecoder> decoder;
+
+        try {
+            while (true) {
+                const auto unitIndex = nextUnitIndex++;
+
+                if (unitIndex >= units.size()) {
+                    return;
+                }
+
+                const auto& unit = units[unitIndex];
+                const auto& dsf = *dsFiles[unit.dsFileIndex];
+
+                if (!decoder || &decoder->dsFile() != &dsf) {
+                    decoder = std::make_unique<PktDecoder>(dsf);
+                }
+
+                PktChunk pktChunk;
+
+                decodePkt(*decoder, unit.dsFileIndex, unit.pktIndex, pktChunk);
+
+                if (!queue.put(unitIndex, std::move(pktChunk))) {
+                    // cancelled
+                    return;
+                }
+            }
+        } catch (...) {
+            // make the merger stop waiting for this chunk
+            queue.cancel();
+            throw;
+        }
+    };
+
+    std::thread producer {[&pool, &work, &units, &exc] {
+        try {
+            pool.run(work, units.size());
+        } catch (...) {
+            exc = std::current_exception();
+        }
+    }};
+
+    ColsMerger merger {cfg.dstDirPath(), dsFiles};
+
+    // decoding error messages, in packet order
+    std::vector<std::string> errorMsgs;
+
+    try {
+        PktChunk pktChunk;
+
+        for (Index unitIndex = 0; unitIndex < units.size(); ++unitIndex) {
+            if (!queue.take(pktChunk)) {
+                break;
+            }
+
+            merger.merge(pktChunk);
+
+            if (!pktChunk.errorMsg.empty()) {
+                errorMsgs.push_back(std::move(pktChunk.errorMsg));
+                pktChunk.errorMsg.clear();
+            }
+        }
+    } catch (...) {
+        queue.cancel();
+        producer.join();
+        throw;
+    }
+
+    producer.join();
+
+    if (exc) {
+        std::rethrow_exception(exc);
+    }
+
+    merger.finish();
+
+    for (const auto& errorMsg : errorMsgs) {
+        utils::error() << errorMsg << std::endl;
+    }
+
+    return errorMsgs.empty();
+}
+
+} // namespace jacques
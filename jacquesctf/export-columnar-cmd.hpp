@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_EXPORT_COLUMNAR_CMD_HPP
+#define _JACQUES_EXPORT_COLUMNAR_CMD_HPP
+
+#include "cfg.hpp"
+
+namespace jacques {
+
+/*
+ * Returns `false` if a packet couldn't be fully decoded.
+ */
+bool exportColumnarCmd(const ExportColumnarCfg& cfg);
+
+} // namespace jacques
+
+#endif // _JACQUES_EXPORT_COLUMNAR_CMD_HPP
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cerrno>
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include "file-range-copier.hpp"
+#include "io-error.hpp"
+
+namespace jacques {
+
+namespace bfs = boost::filesystem;
+
+void appendFileRange(std::vector<FileRange>& ranges, const FileRange& range)
+{
+    if (!ranges.empty()) {
+        auto& lastRange = ranges.back();
+
+        if (lastRange.offsetBytes + lastRange.lenBytes == range.offsetBytes) {
+            // contiguous: coalesce
+            lastRange.lenBytes += range.lenBytes;
+            return;
+        }
+    }
+
+    ranges.push_back(range);
+}
+
+void appendSrcFileRange(std::vector<SrcFileRange>& ranges, const SrcFileRange& range)
+{
+    if (!ranges.empty()) {
+        auto& lastRange = ranges.back();
+
+        if (lastRange.srcIndex == range.srcIndex &&
+                lastRange.range.offsetBytes + lastRange.range.lenBytes ==
+                range.range.offsetBytes) {
+            // contiguous: coalesce
+            lastRange.range.lenBytes += range.range.lenBytes;
+            return;
+        }
+    }
+
+    ranges.push_back(range);
+}
+
+FileRangeCopier::FileRangeCopier(bfs::path dstPath) :
+    _dstPath {std::move(dstPath)}
+{
+    _dstFd = open(_dstPath.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (_dstFd < 0) {
+        throwIOError(_dstPath, "create");
+    }
+}
+
+FileRangeCopier::~FileRangeCopier()
+{
+    if (_dstFd >= 0) {
+        static_cast<void>(::close(_dstFd));
+    }
+}
+
+void FileRangeCopier::close()
+{
+    const auto fd = _dstFd;
+
+    _dstFd = -1;
+
+    if (::close(fd) != 0) {
+        throwIOError(_dstPath, "close");
+    }
+}
+
+void FileRangeCopier::copy(const bfs::path& srcPath, const std::vector<FileRange>& ranges)
+{
+    const auto srcFd = open(srcPath.string().c_str(), O_RDONLY);
+
+    if (srcFd < 0) {
+        throwIOError(srcPath, "open");
+    }
+
+    try {
+        for (const auto& range : ranges) {
+            this->_copyRange(srcFd, srcPath, range);
+        }
+    } catch (...) {
+        static_cast<void>(::close(srcFd));
+        throw;
+    }
+
+    static_cast<void>(::close(srcFd));
+}
+
+void FileRangeCopier::copy(const std::vector<bfs::path>& srcPaths,
+                           const std::vector<SrcFileRange>& ranges)
+{
+    std::vector<int> srcFds;
+
+    const auto closeSrcFds = [&srcFds] {
+        for (const auto fd : srcFds) {
+            static_cast<void>(::close(fd));
+        }
+    };
+
+    try {
+        for (const auto& srcPath : srcPaths) {
+            const auto srcFd = open(srcPath.string().c_str(), O_RDONLY);
+
+            if (srcFd < 0) {
+                throwIOError(srcPath, "open");
+            }
+
+            srcFds.push_back(srcFd);
+        }
+
+        for (const auto& range : ranges) {
+            this->_copyRange(srcFds[range.srcIndex], srcPaths[range.srcIndex], range.range);
+        }
+    } catch (...) {
+        closeSrcFds();
+        throw;
+    }
+
+    closeSrcFds();
+}
+
+void FileRangeCopier::_copyRange(const int srcFd, const bfs::path& srcPath,
+                                 const FileRange& range)
+{
+    auto srcOffset = static_cast<loff_t>(range.offsetBytes);
+    auto dstOffset = static_cast<loff_t>(_dstOffsetBytes);
+    auto remLen = range.lenBytes;
+
+    while (remLen > 0 && _canCopyFileRange) {
+        const auto ret = copy_file_range(srcFd, &srcOffset, _dstFd, &dstOffset,
+                                         static_cast<size_t>(remLen), 0);
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP ||
+                    errno == EBADF) {
+                // not supported for those files: fall back for good
+                _canCopyFileRange = false;
+                break;
+            }
+
+            throwIOError(_dstPath, "write");
+        }
+
+        if (ret == 0) {
+            std::ostringstream ss;
+
+            ss << "Unexpected end of file `" << srcPath.string() << "`.";
+            throw IOError {srcPath, ss.str()};
+        }
+
+        remLen -= static_cast<Size>(ret);
+    }
+
+    const auto copiedLen = range.lenBytes - remLen;
+
+    _dstOffsetBytes += copiedLen;
+
+    if (remLen > 0) {
+        this->_copyRangeBuffered(srcFd, srcPath, {range.offsetBytes + copiedLen, remLen});
+    }
+}
+
+void FileRangeCopier::_copyRangeBuffered(const int srcFd, const bfs::path& srcPath,
+                                         const FileRange& range)
+{
+    if (_buf.empty()) {
+        _buf.resize(1 << 20);
+    }
+
+    auto srcOffset = range.offsetBytes;
+    auto remLen = range.lenBytes;
+
+    while (remLen > 0) {
+        const auto readLen = std::min(static_cast<Size>(_buf.size()), remLen);
+        const auto readRet = pread(srcFd, _buf.data(), static_cast<size_t>(readLen),
+                                   static_cast<off_t>(srcOffset));
+
+        if (readRet < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throwIOError(srcPath, "read");
+        }
+
+        if (readRet == 0) {
+            std::ostringstream ss;
+
+            ss << "Unexpected end of file `" << srcPath.string() << "`.";
+            throw IOError {srcPath, ss.str()};
+        }
+
+        Size writtenLen = 0;
+
+        while (writtenLen < static_cast<Size>(readRet)) {
+            const auto writeRet = pwrite(_dstFd, _buf.data() + writtenLen,
+                                         static_cast<size_t>(readRet) - writtenLen,
+                                         static_cast<off_t>(_dstOffsetBytes));
+
+            if (writeRet < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throwIOError(_dstPath, "write");
+            }
+
+            writtenLen += static_cast<Size>(writeRet);
+            _dstOffsetBytes += static_cast<Size>(writeRet);
+        }
+
+        srcOffset += static_cast<Size>(readRet);
+        remLen -= static_cast<Size>(readRet);
+    }
+}
+
+} // namespace jacques
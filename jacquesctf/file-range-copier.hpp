@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_FILE_RANGE_COPIER_HPP
+#define _JACQUES_FILE_RANGE_COPIER_HPP
+
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Byte range of a file.
+ */
+struct FileRange
+{
+    Index offsetBytes;
+    Size lenBytes;
+};
+
+/*
+ * Byte range of one of many source files.
+ */
+struct SrcFileRange
+{
+    // index of the source file
+    Index srcIndex;
+
+    FileRange range;
+};
+
+/*
+ * Appends `range` to `ranges`, extending the last range of `ranges`
+ * instead if `range` immediately follows it.
+ */
+void appendFileRange(std::vector<FileRange>& ranges, const FileRange& range);
+
+/*
+ * Appends `range` to `ranges`, extending the last range of `ranges`
+ * instead if `range` immediately follows it within the same source
+ * file.
+ */
+void appendSrcFileRange(std::vector<SrcFileRange>& ranges, const SrcFileRange& range);
+
+/*
+ * Copier of byte ranges of source files to a destination file.
+ *
+ * A file range copier appends each copied range to the destination
+ * file. It copies within the kernel with copy_file_range(2) when
+ * possible, and falls back to a buffered copy otherwise (for example,
+ * with an older kernel, or when the files are on different file
+ * systems).
+ */
+class FileRangeCopier final :
+    boost::noncopyable
+{
+public:
+    // creates or truncates `dstPath`
+    explicit FileRangeCopier(boost::filesystem::path dstPath);
+
+    ~FileRangeCopier();
+
+    /*
+     * Copies the ranges `ranges` of the file `srcPath`, in order, to
+     * the end of the destination file.
+     */
+    void copy(const boost::filesystem::path& srcPath, const std::vector<FileRange>& ranges);
+
+    /*
+     * Copies the ranges `ranges`, in order, to the end of the
+     * destination file, the source file of each range being
+     * `srcPaths[range.srcIndex]`.
+     *
+     * This method opens each source file once, however interleaved
+     * the ranges are.
+     */
+    void copy(const std::vector<boost::filesystem::path>& srcPaths,
+              const std::vector<SrcFileRange>& ranges);
+
+    /*
+     * Closes the destination file, reporting any error.
+     */
+    void close();
+
+    Size dstLenBytes() const noexcept
+    {
+        return _dstOffsetBytes;
+    }
+
+private:
+    void _copyRange(int srcFd, const boost::filesystem::path& srcPath, const FileRange& range);
+    void _copyRangeBuffered(int srcFd, const boost::filesystem::path& srcPath,
+                            const FileRange& range);
+
+private:
+    const boost::filesystem::path _dstPath;
+    int _dstFd;
+    Index _dstOffsetBytes = 0;
+    bool _canCopyFileRange = true;
+    std::vector<char> _buf;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_FILE_RANGE_COPIER_HPP
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cstring>
+
+#include "hash.hpp"
+
+namespace jacques {
+namespace {
+
+constexpr std::uint64_t prime1 = 0x9e3779b185ebca87ULL;
+constexpr std::uint64_t prime2 = 0xc2b2ae3d27d4eb4fULL;
+constexpr std::uint64_t prime3 = 0x165667b19e3779f9ULL;
+constexpr std::uint64_t prime4 = 0x85ebca77c2b2ae63ULL;
+constexpr std::uint64_t prime5 = 0x27d4eb2f165667c5ULL;
+
+inline std::uint64_t rotl(const std::uint64_t val, const unsigned int count) noexcept
+{
+    return (val << count) | (val >> (64 - count));
+}
+
+// the hash only needs to be stable within a process: native byte order
+inline std::uint64_t read64(const std::uint8_t * const data) noexcept
+{
+    std::uint64_t val;
+
+    std::memcpy(&val, data, sizeof(val));
+    return val;
+}
+
+inline std::uint32_t read32(const std::uint8_t * const data) noexcept
+{
+    std::uint32_t val;
+
+    std::memcpy(&val, data, sizeof(val));
+    return val;
+}
+
+inline std::uint64_t round(std::uint64_t acc, const std::uint64_t input) noexcept
+{
+    acc += input * prime2;
+    acc = rotl(acc, 31);
+    return acc * prime1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t acc, const std::uint64_t val) noexcept
+{
+    acc ^= round(0, val);
+    return acc * prime1 + prime4;
+}
+
+} // namespace
+
+std::uint64_t hashData(const std::uint8_t *data, const Size len, const std::uint64_t seed) noexcept
+{
+    const auto end = data + len;
+    std::uint64_t hash;
+
+    if (len >= 32) {
+        const auto stripesEnd = end - 32;
+        auto acc1 = seed + prime1 + prime2;
+        auto acc2 = seed + prime2;
+        auto acc3 = seed;
+        auto acc4 = seed - prime1;
+
+        do {
+            acc1 = round(acc1, read64(data));
+            acc2 = round(acc2, read64(data + 8));
+            acc3 = round(acc3, read64(data + 16));
+            acc4 = round(acc4, read64(data + 24));
+            data += 32;
+        } while (data <= stripesEnd);
+
+        hash = rotl(acc1, 1) + rotl(acc2, 7) + rotl(acc3, 12) + rotl(acc4, 18);
+        hash = mergeRound(hash, acc1);
+        hash = mergeRound(hash, acc2);
+        hash = mergeRound(hash, acc3);
+        hash = mergeRound(hash, acc4);
+    } else {
+        hash = seed + prime5;
+    }
+
+    hash += static_cast<std::uint64_t>(len);
+
+    // remaining bytes
+    while (data + 8 <= end) {
+        hash ^= round(0, read64(data));
+        hash = rotl(hash, 27) * prime1 + prime4;
+        data += 8;
+    }
+
+    if (data + 4 <= end) {
+        hash ^= static_cast<std::uint64_t>(read32(data)) * prime1;
+        hash = rotl(hash, 23) * prime2 + prime3;
+        data += 4;
+    }
+
+    while (data < end) {
+        hash ^= static_cast<std::uint64_t>(*data) * prime5;
+        hash = rotl(hash, 11) * prime1;
+        ++data;
+    }
+
+    // avalanche
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+} // namespace jacques
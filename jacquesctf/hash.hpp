@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_HASH_HPP
+#define _JACQUES_HASH_HPP
+
+#include <cstdint>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Returns a fast, non-cryptographic 64-bit hash of the `len` bytes at
+ * `data`.
+ *
+ * This is the XXH64 algorithm: it processes 32-byte stripes with four
+ * independent accumulators, so that the CPU works on the four lanes of
+ * a stripe in parallel, making it about as fast as reading memory.
+ */
+std::uint64_t hashData(const std::uint8_t *data, Size len, std::uint64_t seed = 0) noexcept;
+
+} // namespace jacques
+
+#endif // _JACQUES_HASH_HPP
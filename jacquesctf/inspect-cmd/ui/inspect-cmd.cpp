@@ -22,6 +22,7 @@
 #include "screens/ds-files-screen.hpp"
 #include "screens/dts-screen.hpp"
 #include "screens/trace-info-screen.hpp"
+#include "screens/er-search-results-screen.hpp"
 #include "views/status-view.hpp"
 #include "views/pkt-index-build-progress-view.hpp"
 #include "views/pkt-checkpoints-build-progress-view.hpp"
@@ -267,6 +268,9 @@ void startInteractive(const InspectCfg& cfg)
     const auto dtsScreen = std::make_unique<DtsScreen>(screenRect, cfg, *stylist, *appState);
     const auto traceInfoScreen = std::make_unique<TraceInfoScreen>(screenRect, cfg, *stylist,
                                                                    *appState);
+    const auto erSearchResultsScreen = std::make_unique<ErSearchResultsScreen>(screenRect, cfg,
+                                                                               *stylist,
+                                                                               *appState);
     const std::vector<Screen *> screens {
         inspectScreen.get(),
         pktsScreen.get(),
@@ -274,6 +278,7 @@ void startInteractive(const InspectCfg& cfg)
         helpScreen.get(),
         dtsScreen.get(),
         traceInfoScreen.get(),
+        erSearchResultsScreen.get(),
     };
 
     // goto first packet if available: this creates it and shows the progress
@@ -409,6 +414,16 @@ void startInteractive(const InspectCfg& cfg)
             curScreen->isVisible(true);
             break;
 
+        case 'F':
+            if (curScreen == erSearchResultsScreen.get()) {
+                break;
+            }
+
+            curScreen->isVisible(false);
+            curScreen = erSearchResultsScreen.get();
+            curScreen->isVisible(true);
+            break;
+
         case 'h':
         case 'H':
         case '?':
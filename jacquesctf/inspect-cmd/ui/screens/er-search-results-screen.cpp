@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <curses.h>
+
+#include "cfg.hpp"
+#include "er-search-results-screen.hpp"
+#include "../stylist.hpp"
+
+namespace jacques {
+
+ErSearchResultsScreen::ErSearchResultsScreen(const Rect& rect, const InspectCfg& cfg,
+                                             const Stylist& stylist,
+                                             InspectCmdState& appState) :
+    Screen {rect, cfg, stylist, appState},
+    _view {std::make_unique<ErSearchResultsTableView>(rect, stylist)},
+    _searchCtrl {*this, stylist},
+    _tsFmtModeWheel {
+        TsFmtMode::LONG,
+        TsFmtMode::NS_FROM_ORIGIN,
+        TsFmtMode::CYCLES,
+    },
+    _dataLenFmtModeWheel {
+        utils::LenFmtMode::FULL_FLOOR_WITH_EXTRA_BITS,
+        utils::LenFmtMode::BYTES_FLOOR_WITH_EXTRA_BITS,
+        utils::LenFmtMode::BITS,
+    }
+{
+    _view->focus();
+}
+
+ErSearchResultsScreen::~ErSearchResultsScreen()
+{
+    _cancel = true;
+
+    if (_searchThread.joinable()) {
+        _searchThread.join();
+    }
+}
+
+void ErSearchResultsScreen::_redraw()
+{
+    _view->redraw();
+}
+
+void ErSearchResultsScreen::_resized()
+{
+    _view->moveAndResize(this->rect());
+    _searchCtrl.parentScreenResized(*this);
+}
+
+void ErSearchResultsScreen::_visibilityChanged()
+{
+    _view->isVisible(this->isVisible());
+    this->_updateInputTimeout();
+
+    if (!this->isVisible()) {
+        return;
+    }
+
+    _view->update();
+    _view->redraw();
+
+    if (!_results) {
+        // nothing to show yet: ask for a query immediately
+        _view->refresh();
+        doupdate();
+        this->_startSearch();
+    }
+}
+
+void ErSearchResultsScreen::_updateInputTimeout()
+{
+    /*
+     * Only wake up periodically when there's something new to show:
+     * the main loop blocks on getch() otherwise.
+     */
+    if (this->isVisible() && _results && !_results->isDone()) {
+        timeout(250);
+    } else {
+        timeout(-1);
+    }
+}
+
+namespace {
+
+/*
+ * True if "find all" supports `query`.
+ */
+bool isErSearchQuery(const SearchQuery& query) noexcept
+{
+    return dynamic_cast<const ErtNameSearchQuery *>(&query) ||
+           dynamic_cast<const ErtIdSearchQuery *>(&query) ||
+           dynamic_cast<const ErFieldSearchQuery *>(&query);
+}
+
+} // namespace
+
+void ErSearchResultsScreen::_stopSearch()
+{
+    _cancel = true;
+
+    if (_searchThread.joinable()) {
+        _searchThread.join();
+    }
+
+    _cancel = false;
+
+    if (_searchExc) {
+        const auto exc = _searchExc;
+
+        _searchExc = nullptr;
+        std::rethrow_exception(exc);
+    }
+}
+
+void ErSearchResultsScreen::_startSearch()
+{
+    auto query = _searchCtrl.start();
+
+    if (!query || !isErSearchQuery(*query)) {
+        // canceled, invalid, or not an event record search
+        this->_redraw();
+        return;
+    }
+
+    this->_stopSearch();
+    _view->results(nullptr);
+    _query = std::move(query);
+    _results = std::make_unique<ErSearchResults>(this->_appState().activeDsFileStateIndex());
+
+    /*
+     * DsFileState::findAll() doesn't modify the data stream file state,
+     * so the user may keep on navigating while it runs.
+     */
+    auto& dsFileState = this->_appState().activeDsFileState();
+
+    _searchThread = std::thread {[this, &dsFileState] {
+        try {
+            dsFileState.findAll(*_query, *_results, &_cancel);
+        } catch (...) {
+            _searchExc = std::current_exception();
+            _results->isDone(true);
+        }
+    }};
+
+    _view->results(_results.get());
+    this->_updateInputTimeout();
+    this->_redraw();
+}
+
+KeyHandlingReaction ErSearchResultsScreen::_gotoSelResult()
+{
+    if (!_results || _results->storedResultCount() == 0) {
+        return KeyHandlingReaction::CONTINUE;
+    }
+
+    // O(1): the result contains everything needed to go to its location
+    const auto result = (*_results)[_view->selResultIndex()];
+
+    if (this->_appState().activeDsFileStateIndex() != _results->dsFileIndex()) {
+        this->_appState().gotoDsFile(_results->dsFileIndex());
+    }
+
+    this->_appState().gotoPkt(result.pktIndex);
+    this->_appState().gotoPktRegionAtOffsetInPktBits(result.erOffsetInPktBits);
+    return KeyHandlingReaction::RETURN_TO_INSPECT;
+}
+
+KeyHandlingReaction ErSearchResultsScreen::_handleKey(const int key)
+{
+    switch (key) {
+    case ERR:
+        // input timeout: show new results
+        _view->update();
+
+        if (_results && _results->isDone()) {
+            this->_stopSearch();
+            this->_updateInputTimeout();
+        }
+
+        break;
+
+    case KEY_UP:
+        _view->prev();
+        break;
+
+    case KEY_DOWN:
+        _view->next();
+        break;
+
+    case KEY_PPAGE:
+        _view->pageUp();
+        break;
+
+    case KEY_NPAGE:
+        _view->pageDown();
+        break;
+
+    case KEY_END:
+        _view->selectLast();
+        break;
+
+    case KEY_HOME:
+        _view->selectFirst();
+        break;
+
+    case 'c':
+        _view->centerSelRow();
+        break;
+
+    case 't':
+        _tsFmtModeWheel.next();
+        _view->tsFmtMode(_tsFmtModeWheel.curVal());
+        break;
+
+    case 's':
+        _dataLenFmtModeWheel.next();
+        _view->dataLenFmtMode(_dataLenFmtModeWheel.curVal());
+        break;
+
+    case '/':
+    case 'g':
+        this->_startSearch();
+        break;
+
+    case 'x':
+        this->_stopSearch();
+        _view->update();
+        this->_updateInputTimeout();
+        break;
+
+    case '\n':
+    case '\r':
+        return this->_gotoSelResult();
+
+    default:
+        break;
+    }
+
+    _view->refresh();
+    return KeyHandlingReaction::CONTINUE;
+}
+
+} // namespace jacques
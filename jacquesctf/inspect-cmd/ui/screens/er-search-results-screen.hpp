@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_INSPECT_COMMAND_UI_SCREENS_ER_SEARCH_RESULTS_SCREEN_HPP
+#define _JACQUES_INSPECT_COMMAND_UI_SCREENS_ER_SEARCH_RESULTS_SCREEN_HPP
+
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+#include "aliases.hpp"
+#include "../stylist.hpp"
+#include "../views/er-search-results-table-view.hpp"
+#include "screen.hpp"
+#include "../cycle-wheel.hpp"
+#include "../search-ctrl.hpp"
+#include "inspect-common/search-query.hpp"
+#include "inspect-common/er-search-results.hpp"
+
+namespace jacques {
+
+/*
+ * "Find all" event record search screen.
+ *
+ * This screen searches all the event records of the active data stream
+ * file matching a query in a background thread and shows the results
+ * in a table as they arrive.
+ *
+ * While the search is running and this screen is visible, this screen
+ * makes getch() time out so that it receives `ERR` periodically to
+ * update the match count and the table.
+ */
+class ErSearchResultsScreen final :
+    public Screen
+{
+public:
+    explicit ErSearchResultsScreen(const Rect& rect, const InspectCfg& cfg,
+                                   const Stylist& stylist, InspectCmdState& appState);
+    ~ErSearchResultsScreen();
+
+private:
+    void _redraw() override;
+    void _resized() override;
+    KeyHandlingReaction _handleKey(int key) override;
+    void _visibilityChanged() override;
+    void _startSearch();
+    void _stopSearch();
+    void _updateInputTimeout();
+    KeyHandlingReaction _gotoSelResult();
+
+private:
+    std::unique_ptr<ErSearchResultsTableView> _view;
+    SearchCtrl _searchCtrl;
+    CycleWheel<TsFmtMode> _tsFmtModeWheel;
+    CycleWheel<utils::LenFmtMode> _dataLenFmtModeWheel;
+    std::unique_ptr<const SearchQuery> _query;
+    std::unique_ptr<ErSearchResults> _results;
+    std::thread _searchThread;
+    std::atomic_bool _cancel {false};
+    std::exception_ptr _searchExc;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_INSPECT_COMMAND_UI_SCREENS_ER_SEARCH_RESULTS_SCREEN_HPP
@@ -9,6 +9,7 @@
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <exception>
 #include <curses.h>
 #include <signal.h>
 #include <unistd.h>
@@ -331,21 +332,51 @@ void InspectScreen::_setLastOffsetInRowBits()
     }
 }
 
+namespace {
+
+/*
+ * True if searching `query` may need to decode or scan many packets.
+ */
+bool isLongSearchQuery(const SearchQuery& query) noexcept
+{
+    return dynamic_cast<const ErtNameSearchQuery *>(&query) ||
+           dynamic_cast<const ErtIdSearchQuery *>(&query) ||
+           dynamic_cast<const ErFieldSearchQuery *>(&query) ||
+           dynamic_cast<const BytePatternSearchQuery *>(&query);
+}
+
+} // namespace
+
 void InspectScreen::_search(const SearchQuery& query, const bool animate)
 {
-    if (dynamic_cast<const ErtNameSearchQuery *>(&query) ||
-            dynamic_cast<const ErtIdSearchQuery *>(&query)) {
+    if (isLongSearchQuery(query)) {
+        /*
+         * Those searches can take a while: search in another thread
+         * and let the user cancel it while we animate. A canceled
+         * search doesn't change the application state.
+         */
         std::atomic_bool stop {false};
-        std::thread t {[this, &stop, &query] {
-            this->_appState().search(query);
+        std::atomic_bool cancel {false};
+        std::exception_ptr exc;
+        std::thread t {[this, &stop, &cancel, &exc, &query] {
+            try {
+                this->_appState().search(query, &cancel);
+            } catch (...) {
+                exc = std::current_exception();
+            }
+
             stop = true;
         }};
 
         if (animate) {
-            _searchCtrl.animate(stop);
+            _searchCtrl.animate(stop, &cancel);
         }
 
         t.join();
+
+        if (exc) {
+            std::rethrow_exception(exc);
+        }
     } else {
         this->_appState().search(query);
     }
@@ -584,6 +615,7 @@ KeyHandlingReaction InspectScreen::_handleKey(const int key)
     case '$':
     case '*':
     case 'P':
+    case 'T':
     {
         const auto init = [key]() {
             switch (key) {
@@ -608,6 +640,10 @@ KeyHandlingReaction InspectScreen::_handleKey(const int key)
                 return "$";
                 break;
 
+            case 'T':
+                return "~/";
+                break;
+
             default:
                 return "";
             }
@@ -621,8 +657,7 @@ KeyHandlingReaction InspectScreen::_handleKey(const int key)
                 // start from initial state
                 this->_restoreStateSnapshot(snapshot);
 
-                if (!dynamic_cast<const ErtNameSearchQuery *>(&query) &&
-                        !dynamic_cast<const ErtIdSearchQuery *>(&query)) {
+                if (!isLongSearchQuery(query)) {
                     // this makes the appropriate views update and redraw
                     this->_appState().search(query);
                 }
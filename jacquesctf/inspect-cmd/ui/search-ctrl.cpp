@@ -94,7 +94,7 @@ void SearchCtrl::parentScreenResized(const Screen& parentScreen)
     _searchView->moveAndResize(SearchCtrl::_viewRect(parentScreen));
 }
 
-void SearchCtrl::animate(std::atomic_bool& stop) const
+void SearchCtrl::animate(const std::atomic_bool& stop, std::atomic_bool * const cancel) const
 {
     using namespace std::chrono_literals;
 
@@ -102,9 +102,19 @@ void SearchCtrl::animate(std::atomic_bool& stop) const
 
     _searchView->isVisible(true);
 
-    while (true) {
-        if (stop) {
-            return;
+    if (cancel) {
+        // don't block on getch()
+        nodelay(stdscr, TRUE);
+    }
+
+    while (!stop) {
+        if (cancel && !*cancel) {
+            const auto ch = getch();
+
+            if (ch == 27 || ch == 4 || ch == 'q') {
+                // escape, ctrl+d, or `q`
+                *cancel = true;
+            }
         }
 
         _searchView->animateBorder(animIndex);
@@ -114,6 +124,10 @@ void SearchCtrl::animate(std::atomic_bool& stop) const
         std::this_thread::sleep_for(50ms);
     }
 
+    if (cancel) {
+        nodelay(stdscr, FALSE);
+    }
+
     _searchView->isVisible(false);
 }
 
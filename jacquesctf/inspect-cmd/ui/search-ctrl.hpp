@@ -29,7 +29,15 @@ public:
                                                  const LiveUpdateFunc& liveUpdateFunc);
 
     void parentScreenResized(const Screen& parentScreen);
-    void animate(std::atomic_bool& stop) const;
+
+    /*
+     * Animates the search view until `stop` becomes true.
+     *
+     * If `cancel` is set, this method also reads the keyboard and sets
+     * `*cancel` when the user presses Escape, Ctrl+D, or `q`, but it
+     * keeps animating until `stop` becomes true anyway.
+     */
+    void animate(const std::atomic_bool& stop, std::atomic_bool *cancel = nullptr) const;
 
     std::unique_ptr<const SearchQuery> start(const std::string& init)
     {
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <numeric>
+#include <sstream>
+
+#include "er-search-results-table-view.hpp"
+#include "utils.hpp"
+
+namespace jacques {
+
+ErSearchResultsTableView::ErSearchResultsTableView(const Rect& rect, const Stylist& stylist) :
+    TableView {rect, "Search results", DecorationStyle::BORDERS, stylist}
+{
+    this->_setColumnDescrs();
+}
+
+void ErSearchResultsTableView::_resized()
+{
+    TableView::_resized();
+    this->_setColumnDescrs();
+}
+
+void ErSearchResultsTableView::_resetRow(const std::vector<TableViewColumnDescr>& descrs)
+{
+    _row.clear();
+    _row.push_back(std::make_unique<UIntTableViewCell>(TableViewCell::TextAlign::RIGHT));
+    static_cast<UIntTableViewCell&>(*_row.back()).sep(true);
+    _row.push_back(std::make_unique<UIntTableViewCell>(TableViewCell::TextAlign::RIGHT));
+    static_cast<UIntTableViewCell&>(*_row.back()).sep(true);
+    _row.push_back(std::make_unique<UIntTableViewCell>(TableViewCell::TextAlign::RIGHT));
+    static_cast<UIntTableViewCell&>(*_row.back()).sep(true);
+    _row.push_back(std::make_unique<DataLenTableViewCell>(_dataLenFmtMode));
+
+    if (descrs.size() >= 5) {
+        _row.push_back(std::make_unique<TextTableViewCell>(TableViewCell::TextAlign::LEFT));
+        _row.back()->emphasized(true);
+    }
+
+    if (descrs.size() >= 6) {
+        _row.push_back(std::make_unique<TsTableViewCell>(_tsFmtMode));
+    }
+}
+
+void ErSearchResultsTableView::_setColumnDescrs()
+{
+    std::vector<TableViewColumnDescr> descrs {
+        TableViewColumnDescr {"Match", 12},
+        TableViewColumnDescr {"Packet", 10},
+        TableViewColumnDescr {"ER", 10},
+        TableViewColumnDescr {"Packet offset", 16},
+        TableViewColumnDescr {"ERT name", 8},
+        TableViewColumnDescr {"Timestamp", 29},
+    };
+
+    const auto accOp = [](const auto sz, const auto& descr) {
+        return sz + descr.contentWidth();
+    };
+    auto curSize = std::accumulate(descrs.begin(), descrs.end(), 0ULL, accOp);
+
+    // remove columns until they all fit
+    while (descrs.size() > 4 && this->_contentSize(descrs.size()) < curSize) {
+        descrs.pop_back();
+        curSize = std::accumulate(descrs.begin(), descrs.end(), 0ULL, accOp);
+    }
+
+    // expand name column
+    if (descrs.size() >= 5) {
+        auto totWidth = descrs[0].contentWidth() + descrs[1].contentWidth() +
+                        descrs[2].contentWidth() + descrs[3].contentWidth();
+
+        if (descrs.size() >= 6) {
+            totWidth += descrs[5].contentWidth();
+        }
+
+        descrs[4] = TableViewColumnDescr {
+            descrs[4].title(),
+            this->_contentSize(descrs.size()) - totWidth
+        };
+    }
+
+    this->_resetRow(descrs);
+    this->_colDescrs(std::move(descrs));
+}
+
+void ErSearchResultsTableView::_drawRow(const Index row)
+{
+    assert(_results);
+
+    const auto result = (*_results)[row];
+
+    static_cast<UIntTableViewCell&>(*_row[0]).val(row + 1);
+    static_cast<UIntTableViewCell&>(*_row[1]).val(result.pktIndex + 1);
+    static_cast<UIntTableViewCell&>(*_row[2]).val(result.erIndexInPkt + 1);
+    static_cast<DataLenTableViewCell&>(*_row[3]).len(result.erOffsetInPktBits);
+
+    if (_row.size() >= 5) {
+        if (result.ert && result.ert->name()) {
+            _row[4]->na(false);
+            static_cast<TextTableViewCell&>(*_row[4]).text(*result.ert->name());
+        } else {
+            _row[4]->na(true);
+        }
+    }
+
+    if (_row.size() >= 6) {
+        if (result.erTs) {
+            _row[5]->na(false);
+            static_cast<TsTableViewCell&>(*_row[5]).ts(*result.erTs);
+        } else {
+            _row[5]->na(true);
+        }
+    }
+
+    this->_drawCells(row, _row);
+}
+
+Size ErSearchResultsTableView::_rowCount()
+{
+    if (!_results) {
+        return 0;
+    }
+
+    return _lastStoredResultCount;
+}
+
+void ErSearchResultsTableView::results(const ErSearchResults * const results)
+{
+    _results = results;
+    _lastStoredResultCount = _results ? _results->storedResultCount() : 0;
+    this->_updateTitle();
+    this->_updateCounts();
+    this->_redrawRows();
+}
+
+void ErSearchResultsTableView::update()
+{
+    if (!_results) {
+        return;
+    }
+
+    /*
+     * Only redraw the rows when there are new results: the existing
+     * ones never change.
+     */
+    const auto storedResultCount = _results->storedResultCount();
+
+    this->_updateTitle();
+
+    if (storedResultCount != _lastStoredResultCount) {
+        _lastStoredResultCount = storedResultCount;
+        this->_updateCounts();
+        this->_redrawRows();
+    }
+}
+
+void ErSearchResultsTableView::_updateTitle()
+{
+    if (!_results) {
+        this->_title("Search results");
+        this->_decorate();
+        return;
+    }
+
+    std::ostringstream ss;
+
+    ss << "Search results: " <<
+          utils::sepNumber(_results->matchCount()) << " match" <<
+          (_results->matchCount() == 1 ? "" : "es");
+
+    if (_results->matchCount() > _results->storedResultCount()) {
+        ss << " (showing the first " << utils::sepNumber(_results->storedResultCount()) << ")";
+    }
+
+    if (!_results->isDone()) {
+        ss << " (searching...)";
+    }
+
+    this->_title(ss.str());
+    this->_decorate();
+}
+
+void ErSearchResultsTableView::tsFmtMode(const TsFmtMode tsFmtMode)
+{
+    if (_row.size() >= 6) {
+        static_cast<TsTableViewCell&>(*_row[5]).fmtMode(tsFmtMode);
+    }
+
+    _tsFmtMode = tsFmtMode;
+    this->_redrawRows();
+}
+
+void ErSearchResultsTableView::dataLenFmtMode(const utils::LenFmtMode dataLenFmtMode)
+{
+    static_cast<DataLenTableViewCell&>(*_row[3]).fmtMode(dataLenFmtMode);
+    _dataLenFmtMode = dataLenFmtMode;
+    this->_redrawRows();
+}
+
+} // namespace jacques
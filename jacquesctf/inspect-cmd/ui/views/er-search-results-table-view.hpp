@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_INSPECT_CMD_UI_VIEWS_ER_SEARCH_RESULTS_TABLE_VIEW_HPP
+#define _JACQUES_INSPECT_CMD_UI_VIEWS_ER_SEARCH_RESULTS_TABLE_VIEW_HPP
+
+#include <vector>
+
+#include "table-view.hpp"
+#include "inspect-common/er-search-results.hpp"
+
+namespace jacques {
+
+/*
+ * Table of the results of a "find all" event record search.
+ *
+ * The results may still grow while this view shows them: call update()
+ * to show the new ones.
+ */
+class ErSearchResultsTableView final :
+    public TableView
+{
+public:
+    explicit ErSearchResultsTableView(const Rect& rect, const Stylist& stylist);
+    void results(const ErSearchResults *results);
+    void update();
+    void tsFmtMode(TsFmtMode tsFmtMode);
+    void dataLenFmtMode(utils::LenFmtMode dataLenFmtMode);
+
+    const ErSearchResults *results() const noexcept
+    {
+        return _results;
+    }
+
+    Index selResultIndex() const noexcept
+    {
+        return this->_selRow();
+    }
+
+protected:
+    void _drawRow(Index index) override;
+    Size _rowCount() override;
+    void _resized() override;
+
+private:
+    void _setColumnDescrs();
+    void _resetRow(const std::vector<TableViewColumnDescr>& descrs);
+    void _updateTitle();
+
+private:
+    const ErSearchResults *_results = nullptr;
+
+    // stored result count when we last updated the rows
+    Size _lastStoredResultCount = 0;
+
+    std::vector<std::unique_ptr<TableViewCell>> _row;
+    TsFmtMode _tsFmtMode = TsFmtMode::LONG;
+    utils::LenFmtMode _dataLenFmtMode = utils::LenFmtMode::FULL_FLOOR_WITH_EXTRA_BITS;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_INSPECT_CMD_UI_VIEWS_ER_SEARCH_RESULTS_TABLE_VIEW_HPP
@@ -42,6 +42,7 @@ void HelpView::_buildRows()
         _KeyRow {"p", "Go to \"Packets\" screen"},
         _KeyRow {"d", "Go to \"Data types\" screen"},
         _KeyRow {"i", "Go to \"Trace info\" screen"},
+        _KeyRow {"F", "Go to \"Search results\" screen"},
         _KeyRow {"h, H, ?", "Go to \"Help\" screen"},
         _KeyRow {"q, Esc", "Quit current screen or go to \"Packet inspection\" screen"},
         _KeyRow {"r, Ctrl+l", "Hard refresh screen"},
@@ -102,6 +103,7 @@ void HelpView::_buildRows()
         _KeyRow {"$", "Go to offset within packet (bytes)"},
         _KeyRow {"N, *", "Go to event record with timestamp (ns from origin)"},
         _KeyRow {"k", "Go to event record with timestamp (cycles)"},
+        _KeyRow {"T", "Search event record type in all data stream files"},
         _KeyRow {"n", "Repeat previous search"},
         _EmptyRow {},
         _SectionRow {"\"Data stream files\" screen keys"},
@@ -186,6 +188,28 @@ void HelpView::_buildRows()
         _KeyRow {"Pg down", "Jump to next page"},
         _KeyRow {"q", "Return to \"Packet inspection\" screen"},
         _EmptyRow {},
+        _SectionRow {"\"Search results\" screen keys"},
+        _SubSectionRow {"Presentation"},
+        _KeyRow {"s", "Cycle format of length column"},
+        _KeyRow {"t", "Cycle format of timestamp column"},
+        _KeyRow {"c", "Center selected row"},
+        _EmptyRow {},
+        _SubSectionRow {"Navigation"},
+        _KeyRow {"Up", "Select previous row"},
+        _KeyRow {"Down", "Select next row"},
+        _KeyRow {"Pg up", "Jump to previous page"},
+        _KeyRow {"Pg down", "Jump to next page"},
+        _KeyRow {"Home", "Select first row"},
+        _KeyRow {"End", "Select last row"},
+        _EmptyRow {},
+        _SubSectionRow {"Search"},
+        _KeyRow {"/, g", "Find all matching event records of data stream file (see syntax below)"},
+        _KeyRow {"x", "Stop current search"},
+        _EmptyRow {},
+        _SubSectionRow {"Action"},
+        _KeyRow {"Enter", "Go to selected event record in \"Packet inspection\" screen"},
+        _KeyRow {"q", "Return to \"Packet inspection\" screen"},
+        _EmptyRow {},
         _SectionRow {"\"Help\" screen keys"},
         _KeyRow {"Up", "Go up one line"},
         _KeyRow {"Down", "Go down one line"},
@@ -197,6 +221,7 @@ void HelpView::_buildRows()
         _KeyRow {"Ctrl+w", "Clear input"},
         _KeyRow {"Enter", "Search if input isn't empty, else cancel"},
         _KeyRow {"Ctrl+d", "Cancel"},
+        _KeyRow {"Esc, Ctrl+d, q", "Cancel ongoing event record search"},
         _EmptyRow {},
         _SectionRow {"Search syntax"},
         _TextRow {"X is a constant integer which you can write in decimal, hexadecimal"},
@@ -226,9 +251,25 @@ void HelpView::_buildRows()
         _SearchSyntaxRow {"Event record with relative timestamp X (ns from origin)", "+*X  -*X"},
         _SearchSyntaxRow {"Event record with timestamp X (cycles)", "**X"},
         _SearchSyntaxRow {"Event record with relative timestamp X (cycles)", "+**X  -**X"},
+        _SearchSyntaxRow {"Same (ns from origin), but in all data stream files",
+                          "~*X  ~+*X  ~-*X"},
         _EmptyRow {},
         _SearchSyntaxRow {"Next event record with type name Z", "/Z"},
         _SearchSyntaxRow {"Next event record with type ID X", "%X"},
+        _EmptyRow {},
+        _SearchSyntaxRow {"Next event record with payload field F equal to X", "?payload.F == X"},
+        _SearchSyntaxRow {"Same, with another comparison operator", "!=  <  <=  >  >="},
+        _SearchSyntaxRow {"Same, with a specific scope", "?header.F  ?ctx.F  ?sctx.F"},
+        _SearchSyntaxRow {"Next event record with payload field F equal to string S",
+                          "?payload.F == \"S\""},
+        _SearchSyntaxRow {"Next event record with payload field F within [X, Y]",
+                          "?payload.F in [X, Y]"},
+        _EmptyRow {},
+        _SearchSyntaxRow {"Previous event record (same syntaxes)", "-/Z  -%X  -?F..."},
+        _SearchSyntaxRow {"Same, but in all data stream files", "~/Z  ~-/Z  ~%X  ~?F..."},
+        _EmptyRow {},
+        _SearchSyntaxRow {"Next occurrence of bytes (hexadecimal)", "&de ad be ef"},
+        _SearchSyntaxRow {"Next occurrence of bytes (ASCII, hexadecimal)", "&\"GET\" 20 2f"},
     };
 
     _ssRowFmtPos = 0;
@@ -8,6 +8,13 @@
 #include <cassert>
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <limits>
+#include <tuple>
+
+#include "worker-pool.hpp"
+#include "data/er-finder.hpp"
+#include "data/er-field-pred.hpp"
 
 #include "data/trace.hpp"
 #include "app-state.hpp"
@@ -83,9 +90,426 @@ void AppState::gotoNextDsFile()
     this->gotoDsFile(_activeDsFileStateIndex + 1);
 }
 
-bool AppState::search(const SearchQuery& query)
+bool AppState::search(const SearchQuery& query, const std::atomic_bool * const cancel)
+{
+    if (query.isTraceWide()) {
+        return this->_searchTraceWide(query, cancel);
+    }
+
+    return this->activeDsFileState().search(query, cancel);
+}
+
+void AppState::_gotoDsFileAndPkt(const Index dsFileIndex, const Index pktIndex)
+{
+    assert(dsFileIndex < _dsFileStates.size());
+
+    if (dsFileIndex == _activeDsFileStateIndex) {
+        _activeDsFileState->gotoPkt(pktIndex);
+        return;
+    }
+
+    _activeDsFileStateIndex = dsFileIndex;
+    _activeDsFileState = _dsFileStates[dsFileIndex].get();
+
+    // go to packet without notifying as we notify here
+    _activeDsFileState->_gotoPkt(pktIndex, false);
+    this->_activeDsFileAndPktChanged();
+}
+
+namespace {
+
+/*
+ * Returns the index of the first packet of `dsFile` which could contain
+ * an event record having a timestamp greater than or equal to
+ * `nsFromOrigin`.
+ */
+Index firstPktIndexEndingAtOrAfter(const DsFile& dsFile, const long long nsFromOrigin)
+{
+    const auto& entries = dsFile.pktIndexEntries();
+    const auto it = std::lower_bound(entries.begin(), entries.end(), nsFromOrigin,
+                                     [](const auto& entry, const auto nsFromOrigin) {
+        if (!entry.endTs()) {
+            return false;
+        }
+
+        return entry.endTs()->nsFromOrigin() < nsFromOrigin;
+    });
+
+    return static_cast<Index>(it - entries.begin());
+}
+
+/*
+ * Returns the index of the first packet of `dsFile` which only contains
+ * event records having a timestamp greater than `nsFromOrigin`, or the
+ * packet count if there's none.
+ */
+Index firstPktIndexBeginningAfter(const DsFile& dsFile, const long long nsFromOrigin)
+{
+    const auto& entries = dsFile.pktIndexEntries();
+    const auto it = std::upper_bound(entries.begin(), entries.end(), nsFromOrigin,
+                                     [](const auto nsFromOrigin, const auto& entry) {
+        if (!entry.beginTs()) {
+            return true;
+        }
+
+        return nsFromOrigin < entry.beginTs()->nsFromOrigin();
+    });
+
+    return static_cast<Index>(it - entries.begin());
+}
+
+} // namespace
+
+const TraceTimeIndex& AppState::traceTimeIndex()
+{
+    if (!_traceTimeIndex) {
+        std::vector<const DsFile *> dsFiles;
+
+        for (const auto& dsFileState : _dsFileStates) {
+            dsFiles.push_back(&dsFileState->dsFile());
+        }
+
+        _traceTimeIndex = std::make_unique<const TraceTimeIndex>(dsFiles);
+    }
+
+    return *_traceTimeIndex;
+}
+
+bool AppState::_gotoTraceWideTs(const TimestampSearchQuery& query)
+{
+    assert(query.unit() == TimestampSearchQuery::Unit::NS);
+
+    auto reqNsFromOrigin = query.val();
+
+    if (query.isDiff()) {
+        if (!_activeDsFileState->hasActivePktState()) {
+            return false;
+        }
+
+        const auto curEr = _activeDsFileState->curEr();
+
+        if (!curEr || !curEr->ts()) {
+            return false;
+        }
+
+        reqNsFromOrigin += curEr->ts()->nsFromOrigin();
+    }
+
+    /*
+     * Find the event record having the requested timestamp, or the
+     * last one before it, within the last packet of each data stream
+     * file beginning at or before this timestamp (which may end before
+     * it), and keep the latest one (data stream file order for equal
+     * timestamps), like a single data stream file search does.
+     */
+    const TraceTimeIndex::Entry *bestEntry = nullptr;
+    long long bestNsFromOrigin = 0;
+    Index bestOffsetInPktBits = 0;
+
+    const auto& timeIndex = this->traceTimeIndex();
+    const auto entries = timeIndex.lastEntriesAtOrBeforeNsFromOrigin(reqNsFromOrigin);
+
+    for (const auto entry : entries) {
+        auto& dsFileState = *_dsFileStates[entry->dsFileIndex];
+        auto& pkt = dsFileState.dsFile().pktAtIndex(entry->pktIndexEntry->indexInDsFile(),
+                                                    *dsFileState._pktCheckpointsBuildListener);
+        const Er *er;
+
+        if (reqNsFromOrigin >= entry->endNsFromOrigin) {
+            // whole packet at or before this timestamp
+            er = pkt.lastEr();
+        } else {
+            er = pkt.erBeforeOrAtNsFromOrigin(reqNsFromOrigin);
+        }
+
+        if (!er || !er->ts() || er->ts()->nsFromOrigin() > reqNsFromOrigin) {
+            continue;
+        }
+
+        const auto nsFromOrigin = er->ts()->nsFromOrigin();
+
+        if (!bestEntry || nsFromOrigin > bestNsFromOrigin ||
+                (nsFromOrigin == bestNsFromOrigin && entry->dsFileIndex < bestEntry->dsFileIndex)) {
+            bestEntry = entry;
+            bestNsFromOrigin = nsFromOrigin;
+
+            // `er` can become invalid when decoding another packet
+            bestOffsetInPktBits = er->segment().offsetInPktBits();
+        }
+    }
+
+    if (!bestEntry) {
+        /*
+         * No data stream file has an event record at or before this
+         * timestamp (for example, a timestamp preceding all the
+         * packets): go to the first event record after it, that is,
+         * within a packet beginning at or before it or the next packet.
+         */
+        const auto firstAfterEntries = timeIndex.firstEntriesAfterNsFromOrigin(reqNsFromOrigin);
+        auto nextEntries = entries;
+
+        nextEntries.insert(nextEntries.end(), firstAfterEntries.begin(),
+                           firstAfterEntries.end());
+
+        for (const auto entry : nextEntries) {
+            auto& dsFileState = *_dsFileStates[entry->dsFileIndex];
+            auto& pkt = dsFileState.dsFile().pktAtIndex(entry->pktIndexEntry->indexInDsFile(),
+                                                        *dsFileState._pktCheckpointsBuildListener);
+            const auto er = pkt.firstEr();
+
+            if (!er || !er->ts()) {
+                continue;
+            }
+
+            const auto nsFromOrigin = er->ts()->nsFromOrigin();
+
+            if (!bestEntry || nsFromOrigin < bestNsFromOrigin ||
+                    (nsFromOrigin == bestNsFromOrigin &&
+                     entry->dsFileIndex < bestEntry->dsFileIndex)) {
+                bestEntry = entry;
+                bestNsFromOrigin = nsFromOrigin;
+                bestOffsetInPktBits = er->segment().offsetInPktBits();
+            }
+        }
+
+        if (!bestEntry) {
+            return false;
+        }
+    }
+
+    this->_gotoDsFileAndPkt(bestEntry->dsFileIndex, bestEntry->pktIndexEntry->indexInDsFile());
+    _activeDsFileState->gotoPktRegionAtOffsetInPktBits(bestOffsetInPktBits);
+    return true;
+}
+
+bool AppState::_searchTraceWide(const SearchQuery& query, const std::atomic_bool * const cancel)
 {
-    return this->activeDsFileState().search(query);
+    if (const auto tsQuery = dynamic_cast<const TimestampSearchQuery *>(&query)) {
+        return this->_gotoTraceWideTs(*tsQuery);
+    }
+
+    const auto fieldQuery = dynamic_cast<const ErFieldSearchQuery *>(&query);
+
+    /*
+     * Build the event record predicate and resolve the field path once
+     * per metadata object (data stream files of different traces have
+     * different metadata objects).
+     */
+    std::map<const Metadata *, ErFinder::Pred> preds;
+    std::map<const Metadata *, std::unique_ptr<const ErFieldPred>> fieldPreds;
+
+    for (const auto& dsFileState : _dsFileStates) {
+        const auto& metadata = dsFileState->metadata();
+
+        if (preds.find(&metadata) != preds.end()) {
+            continue;
+        }
+
+        preds[&metadata] = erPredFromSearchQuery(query, metadata);
+
+        if (fieldQuery) {
+            fieldPreds[&metadata] = std::make_unique<const ErFieldPred>(metadata,
+                                                                        fieldQuery->path(),
+                                                                        fieldQuery->cond());
+        }
+    }
+
+    const auto hasPred = std::any_of(preds.begin(), preds.end(), [](const auto& pair) {
+        return static_cast<bool>(pair.second);
+    });
+
+    if (!hasPred && !fieldQuery) {
+        // not an event record search
+        return false;
+    }
+
+    /*
+     * Order by timestamp only if we can compare the timestamps of all
+     * the data stream files and if we have a current timestamp.
+     */
+    boost::optional<long long> curNsFromOrigin;
+    const auto byTs = std::all_of(_dsFileStates.begin(), _dsFileStates.end(),
+                                  [](const auto& dsFileState) {
+        return dsFileState->metadata().isCorrelatable();
+    });
+
+    if (byTs && _activeDsFileState->hasActivePktState()) {
+        const auto curEr = _activeDsFileState->curEr();
+
+        if (curEr && curEr->ts()) {
+            curNsFromOrigin = curEr->ts()->nsFromOrigin();
+        } else {
+            const auto& pktIndexEntry = _activeDsFileState->activePktState().pktIndexEntry();
+
+            if (pktIndexEntry.beginTs()) {
+                curNsFromOrigin = pktIndexEntry.beginTs()->nsFromOrigin();
+            }
+        }
+    }
+
+    const auto isBackward = query.isBackward();
+
+    /*
+     * The packet and event record indexes of a candidate are where to
+     * start searching (forward) or before which to search (backward).
+     */
+    struct Candidate
+    {
+        Index dsFileIndex;
+        Index pktIndex;
+        Index erIndex;
+        boost::optional<ErFinder::Result> result;
+    };
+
+    std::vector<Candidate> candidates;
+
+    for (Index dsFileIndex = 0; dsFileIndex < _dsFileStates.size(); ++dsFileIndex) {
+        auto& dsFileState = *_dsFileStates[dsFileIndex];
+        const auto& dsFile = dsFileState.dsFile();
+
+        if (dsFile.pktCount() == 0) {
+            continue;
+        }
+
+        if (dsFileIndex == _activeDsFileStateIndex) {
+            const auto bound = isBackward ? dsFileState._prevErSearchEnd() :
+                               dsFileState._nextErSearchStart();
+
+            candidates.push_back({dsFileIndex, bound.first, bound.second, boost::none});
+        } else if (curNsFromOrigin) {
+            if (isBackward) {
+                const auto endPktIndex = firstPktIndexBeginningAfter(dsFile, *curNsFromOrigin);
+
+                candidates.push_back({dsFileIndex, endPktIndex, 0, boost::none});
+            } else {
+                const auto startPktIndex = firstPktIndexEndingAtOrAfter(dsFile,
+                                                                        *curNsFromOrigin);
+
+                candidates.push_back({dsFileIndex, startPktIndex, 0, boost::none});
+            }
+        } else if (isBackward && dsFileIndex < _activeDsFileStateIndex) {
+            candidates.push_back({dsFileIndex, dsFile.pktCount(), 0, boost::none});
+        } else if (!isBackward && dsFileIndex > _activeDsFileStateIndex) {
+            candidates.push_back({dsFileIndex, 0, 0, boost::none});
+        }
+    }
+
+    if (candidates.empty()) {
+        return false;
+    }
+
+    /*
+     * Search the data stream files in parallel, splitting the
+     * available hardware threads between the files so as to keep all
+     * of them busy when there are fewer files than threads.
+     */
+    const WorkerPool filePool;
+    const auto fileWorkerCount = std::min(filePool.workerCount(),
+                                          static_cast<Size>(candidates.size()));
+    const auto pktWorkerCount = std::max(filePool.workerCount() / fileWorkerCount, 1ULL);
+    std::atomic<Index> nextCandidateIndex {0};
+
+    filePool.run([&](Index) {
+        while (!cancel || !*cancel) {
+            const auto candidateIndex = nextCandidateIndex.fetch_add(1);
+
+            if (candidateIndex >= candidates.size()) {
+                return;
+            }
+
+            auto& candidate = candidates[candidateIndex];
+            const auto isActive = candidate.dsFileIndex == _activeDsFileStateIndex;
+            const auto& dsFileState = *_dsFileStates[candidate.dsFileIndex];
+            const ErFinder finder {dsFileState.dsFile(), pktWorkerCount};
+            const auto& pred = preds.at(&dsFileState.metadata());
+            const auto fieldPred = fieldQuery ? fieldPreds.at(&dsFileState.metadata()).get() :
+                                   nullptr;
+            const auto find = [&](const ErFinder::Pred& findPred) {
+                if (isBackward) {
+                    return finder.findLast(findPred, candidate.pktIndex, candidate.erIndex,
+                                           cancel, fieldPred);
+                }
+
+                return finder.findFirst(findPred, candidate.pktIndex, candidate.erIndex, cancel,
+                                        fieldPred);
+            };
+
+            if (curNsFromOrigin && !isActive) {
+                /*
+                 * Event records having the current timestamp in a
+                 * data stream file preceding (following, if searching
+                 * backward) the active one are considered already
+                 * visited.
+                 */
+                const auto dsFileIndex = candidate.dsFileIndex;
+                const auto curNs = *curNsFromOrigin;
+                const auto activeIndex = _activeDsFileStateIndex;
+
+                candidate.result = find([&pred, dsFileIndex, curNs, activeIndex,
+                                         isBackward](const PktIndexEntry& pktIndexEntry,
+                                                     const Er& er) {
+                    if (!er.ts()) {
+                        return false;
+                    }
+
+                    const auto ns = er.ts()->nsFromOrigin();
+
+                    if (isBackward) {
+                        if (ns > curNs || (ns == curNs && dsFileIndex > activeIndex)) {
+                            return false;
+                        }
+                    } else if (ns < curNs || (ns == curNs && dsFileIndex < activeIndex)) {
+                        return false;
+                    }
+
+                    return !pred || pred(pktIndexEntry, er);
+                });
+            } else {
+                candidate.result = find(pred);
+            }
+        }
+    }, fileWorkerCount);
+
+    if (cancel && *cancel) {
+        return false;
+    }
+
+    /*
+     * Rank the results: timestamp first, if possible, then file order.
+     * The best result has the lowest rank (highest rank if searching
+     * backward).
+     */
+    const Candidate *best = nullptr;
+
+    const auto rank = [&curNsFromOrigin](const Candidate& candidate) {
+        auto ns = std::numeric_limits<long long>::min();
+
+        if (curNsFromOrigin && candidate.result->erTs) {
+            ns = candidate.result->erTs->nsFromOrigin();
+        }
+
+        return std::make_tuple(ns, candidate.dsFileIndex, candidate.result->pktIndex,
+                               candidate.result->erOffsetInPktBits);
+    };
+
+    for (const auto& candidate : candidates) {
+        if (!candidate.result) {
+            continue;
+        }
+
+        if (!best || (isBackward ? rank(*best) < rank(candidate) :
+                      rank(candidate) < rank(*best))) {
+            best = &candidate;
+        }
+    }
+
+    if (!best) {
+        return false;
+    }
+
+    this->_gotoDsFileAndPkt(best->dsFileIndex, best->result->pktIndex);
+    _activeDsFileState->gotoPktRegionAtOffsetInPktBits(best->result->erOffsetInPktBits);
+    return true;
 }
 
 void AppState::_activeDsFileAndPktChanged()
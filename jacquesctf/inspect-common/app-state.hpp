@@ -9,6 +9,7 @@
 #define _JACQUES_INSPECT_COMMON_APP_STATE_HPP
 
 #include <vector>
+#include <atomic>
 #include <functional>
 #include <boost/filesystem.hpp>
 #include <boost/core/noncopyable.hpp>
@@ -17,6 +18,7 @@
 #include "search-query.hpp"
 #include "data/pkt-checkpoints-build-listener.hpp"
 #include "data/trace.hpp"
+#include "data/trace-time-index.hpp"
 
 namespace jacques {
 
@@ -66,7 +68,30 @@ public:
     void gotoDsFile(Index index);
     void gotoPrevDsFile();
     void gotoNextDsFile();
-    bool search(const SearchQuery& query);
+
+    /*
+     * Searches `query` within the active data stream file, or within
+     * all the data stream files if `query` is trace-wide.
+     *
+     * A trace-wide event record search goes to the next matching event
+     * record following the current timestamp if all the data stream
+     * files are correlatable, or following the current position in
+     * data stream file order (index, then offset) otherwise.
+     *
+     * A trace-wide timestamp search goes to the event record having
+     * the requested timestamp, or the last one before it, within the
+     * packets of all the data stream files covering this timestamp.
+     *
+     * If `cancel` is set and becomes true while searching, this method
+     * returns `false` as soon as possible without changing the state.
+     */
+    bool search(const SearchQuery& query, const std::atomic_bool *cancel = nullptr);
+
+    /*
+     * Time index of the packets of all the data stream files (indexed
+     * like the data stream file states), built on first call.
+     */
+    const TraceTimeIndex& traceTimeIndex();
 
     DsFileState& activeDsFileState() const noexcept
     {
@@ -188,11 +213,17 @@ protected:
     virtual void _activePktChanged();
     virtual void _curOffsetInPktChanged();
 
+private:
+    bool _searchTraceWide(const SearchQuery& query, const std::atomic_bool *cancel);
+    bool _gotoTraceWideTs(const TimestampSearchQuery& query);
+    void _gotoDsFileAndPkt(Index dsFileIndex, Index pktIndex);
+
 private:
     std::vector<std::unique_ptr<DsFileState>> _dsFileStates;
     DsFileState *_activeDsFileState;
     Index _activeDsFileStateIndex = 0;
     std::vector<std::unique_ptr<Trace>> _traces;
+    std::unique_ptr<const TraceTimeIndex> _traceTimeIndex;
 };
 
 } // namespace jacques
@@ -15,6 +15,7 @@
 #include "search-query.hpp"
 #include "app-state.hpp"
 #include "io-error.hpp"
+#include "data/er-finder.hpp"
 
 namespace jacques {
 
@@ -166,28 +167,17 @@ void DsFileState::gotoLastPktRegion()
     _activePktState->gotoLastPktRegion();
 }
 
-bool DsFileState::_gotoNextErWithProp(const std::function<bool (const Er&)>& cmpFunc,
-                                      const boost::optional<Index>& initPktIndex,
-                                      const boost::optional<Index>& initErIndex)
+std::pair<Index, Index> DsFileState::_nextErSearchStart()
 {
     if (!_activePktState) {
-        return false;
+        return {0, 0};
     }
 
     Index startPktIndex = _activePktStateIndex + 1;
-    boost::optional<Index> startErIndex = 0;
-
-    if (initPktIndex) {
-        startPktIndex = *initPktIndex;
-    }
-
-    if (initErIndex) {
-        startErIndex = *initErIndex;
-    }
+    Index startErIndex = 0;
 
-    if (_activePktState->pkt().erCount() > 0 && !initPktIndex && !initErIndex) {
+    if (_activePktState->pkt().erCount() > 0) {
         const auto curEr = _activePktState->curEr();
-        boost::optional<Index> erIndex;
 
         if (curEr) {
             if (curEr->indexInPkt() < _activePktState->pkt().erCount() - 1) {
@@ -206,31 +196,134 @@ bool DsFileState::_gotoNextErWithProp(const std::function<bool (const Er&)>& cmp
         }
     }
 
-    for (auto pktIndex = startPktIndex; pktIndex < _dsFile->pktCount(); ++pktIndex) {
-        auto& pkt = this->_pktState(pktIndex).pkt();
+    return {startPktIndex, startErIndex};
+}
+
+std::pair<Index, Index> DsFileState::_prevErSearchEnd()
+{
+    if (!_activePktState) {
+        return {0, 0};
+    }
+
+    const auto erCount = _activePktState->pkt().erCount();
 
-        const auto itStartErIndex = startErIndex ? *startErIndex : 0;
+    if (erCount == 0) {
+        return {_activePktStateIndex, 0};
+    }
 
-        startErIndex = boost::none;
-        assert(itStartErIndex < pkt.erCount());
+    const auto curEr = _activePktState->curEr();
 
-        for (Index erIndex = itStartErIndex; erIndex < pkt.erCount(); ++erIndex) {
-            const auto& er = pkt.erAtIndexInPkt(erIndex);
+    if (curEr) {
+        // skip current event record
+        return {_activePktStateIndex, curEr->indexInPkt()};
+    }
 
-            if (cmpFunc(er)) {
-                const auto offsetInPktBits = er.segment().offsetInPktBits();
+    const auto& firstEr = _activePktState->pkt().erAtIndexInPkt(0);
 
-                this->gotoPkt(pktIndex);
-                _activePktState->gotoPktRegionAtOffsetInPktBits(offsetInPktBits);
-                return true;
-            }
-        }
+    if (_activePktState->curOffsetInPktBits() < firstEr.segment().offsetInPktBits()) {
+        // before the first event record: search previous packets
+        return {_activePktStateIndex, 0};
     }
 
-    return false;
+    // after the last event record: search whole active packet
+    return {_activePktStateIndex, erCount};
+}
+
+bool DsFileState::_gotoErWithProp(const ErFinder::Pred& pred, const bool isBackward,
+                                  const std::atomic_bool * const cancel,
+                                  const ErFieldPred * const fieldPred)
+{
+    if (!_activePktState) {
+        return false;
+    }
+
+    /*
+     * The finder doesn't touch this state: only change the active
+     * packet and offset once we have a complete result, so that a
+     * canceled search leaves this state as is.
+     */
+    const ErFinder finder {*_dsFile};
+    boost::optional<ErFinder::Result> result;
+
+    if (isBackward) {
+        const auto end = this->_prevErSearchEnd();
+
+        result = finder.findLast(pred, end.first, end.second, cancel, fieldPred);
+    } else {
+        const auto start = this->_nextErSearchStart();
+
+        result = finder.findFirst(pred, start.first, start.second, cancel, fieldPred);
+    }
+
+    if (!result) {
+        return false;
+    }
+
+    this->gotoPkt(result->pktIndex);
+    _activePktState->gotoPktRegionAtOffsetInPktBits(result->erOffsetInPktBits);
+    return true;
 }
 
-bool DsFileState::search(const SearchQuery& query)
+bool DsFileState::_gotoNextBytePattern(const BytePatternFinder::Pattern& pattern,
+                                       const std::atomic_bool * const cancel)
+{
+    if (!_activePktState) {
+        return false;
+    }
+
+    const auto curOffsetInDsFileBits = this->curOffsetInDsFileBits();
+    auto startOffsetBytes = curOffsetInDsFileBits / 8 + 1;
+
+    if (_lastBytePatternMatch && _lastBytePatternMatch->pattern == pattern &&
+            _lastBytePatternMatch->regionOffsetInDsFileBits == curOffsetInDsFileBits) {
+        // repeating the search at the packet region of the last match
+        startOffsetBytes = _lastBytePatternMatch->offsetBytes + 1;
+    }
+
+    const auto offsetBytes = BytePatternFinder {*_dsFile, pattern}.findFirst(startOffsetBytes,
+                                                                             cancel);
+
+    if (!offsetBytes) {
+        return false;
+    }
+
+    // go to the packet region containing the first byte of the match
+    this->gotoOffsetBytes(*offsetBytes);
+    _lastBytePatternMatch = _BytePatternMatch {
+        pattern, *offsetBytes, this->curOffsetInDsFileBits()
+    };
+    return true;
+}
+
+bool DsFileState::findAll(const SearchQuery& query, ErSearchResults& results,
+                          const std::atomic_bool * const cancel) const
+{
+    const auto ret = this->findAll(query, [&results](const auto& result) {
+        results.append(result);
+        return true;
+    }, cancel);
+
+    results.isDone(true);
+    return ret;
+}
+
+bool DsFileState::findAll(const SearchQuery& query, const ErFinder::ResultFunc& func,
+                          const std::atomic_bool * const cancel) const
+{
+    const auto pred = erPredFromSearchQuery(query, this->metadata());
+    const auto fieldQuery = dynamic_cast<const ErFieldSearchQuery *>(&query);
+    boost::optional<ErFieldPred> fieldPred;
+
+    if (fieldQuery) {
+        fieldPred.emplace(this->metadata(), fieldQuery->path(), fieldQuery->cond());
+    } else if (!pred) {
+        return false;
+    }
+
+    return ErFinder {*_dsFile}.findAll(pred, func, cancel, fieldPred.get_ptr());
+}
+
+bool DsFileState::search(const SearchQuery& query, const std::atomic_bool * const cancel)
 {
     if (const auto sQuery = dynamic_cast<const PktIndexSearchQuery *>(&query)) {
         long long reqIndex;
@@ -368,34 +461,15 @@ bool DsFileState::search(const SearchQuery& query)
         }
 
         return true;
-    } else if (const auto sQuery = dynamic_cast<const ErtIdSearchQuery *>(&query)) {
-        if (sQuery->val() < 0) {
-            return false;
-        }
-
-        const auto cmpFunc = [sQuery](const Er& er) {
-            if (!er.type()) {
-                return false;
-            }
-
-            return er.type()->id() == static_cast<Index>(sQuery->val());
-        };
-
-        return this->_gotoNextErWithProp(cmpFunc);
-    } else if (const auto sQuery = dynamic_cast<const ErtNameSearchQuery *>(&query)) {
-        const auto cmpFunc = [sQuery](const Er& er) {
-            if (!er.type()) {
-                return false;
-            }
-
-            if (!er.type()->name()) {
-                return false;
-            }
-
-            return sQuery->matches(*er.type()->name());
-        };
-
-        return this->_gotoNextErWithProp(cmpFunc);
+    } else if (const auto pred = erPredFromSearchQuery(query, this->metadata())) {
+        return this->_gotoErWithProp(pred, query.isBackward(), cancel);
+    } else if (const auto sQuery = dynamic_cast<const ErFieldSearchQuery *>(&query)) {
+        // resolve the field path once for the whole search
+        const ErFieldPred fieldPred {this->metadata(), sQuery->path(), sQuery->cond()};
+
+        return this->_gotoErWithProp({}, query.isBackward(), cancel, &fieldPred);
+    } else if (const auto sQuery = dynamic_cast<const BytePatternSearchQuery *>(&query)) {
+        return this->_gotoNextBytePattern(sQuery->pattern(), cancel);
     } else if (const auto sQuery = dynamic_cast<const TimestampSearchQuery *>(&query)) {
         if (!_activePktState) {
             return false;
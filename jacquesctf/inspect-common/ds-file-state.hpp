@@ -9,6 +9,8 @@
 #define _JACQUES_INSPECT_COMMON_DS_FILE_STATE_HPP
 
 #include <vector>
+#include <atomic>
+#include <utility>
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
 #include <yactfr/yactfr.hpp>
@@ -20,8 +22,11 @@
 #include "search-query.hpp"
 #include "data/pkt.hpp"
 #include "data/er.hpp"
+#include "data/er-finder.hpp"
+#include "data/byte-pattern-finder.hpp"
 #include "data/metadata.hpp"
 #include "pkt-state.hpp"
+#include "er-search-results.hpp"
 
 namespace jacques {
 
@@ -45,7 +50,32 @@ public:
     void gotoNextPktRegion();
     void gotoPktCtx();
     void gotoLastPktRegion();
-    bool search(const SearchQuery& query);
+    bool search(const SearchQuery& query, const std::atomic_bool *cancel = nullptr);
+
+    /*
+     * Appends all the event records of this data stream file matching
+     * the event record search query `query` to `results`, in data
+     * stream file order, and marks `results` as done.
+     *
+     * This method doesn't modify this state: you may call it from
+     * another thread.
+     *
+     * Returns false if `query` isn't an event record search query or
+     * if `cancel` became true.
+     */
+    bool findAll(const SearchQuery& query, ErSearchResults& results,
+                 const std::atomic_bool *cancel = nullptr) const;
+
+    /*
+     * Like findAll() above, but calls `func` with each matching event
+     * record, in data stream file order, instead of appending it to
+     * some results.
+     *
+     * Returns false if `query` isn't an event record search query, if
+     * `func` stopped the iteration, or if `cancel` became true.
+     */
+    bool findAll(const SearchQuery& query, const ErFinder::ResultFunc& func,
+                 const std::atomic_bool *cancel = nullptr) const;
     void analyzeAllPkts(PktCheckpointsBuildListener *buildListener = nullptr);
 
     DsFile& dsFile() noexcept
@@ -151,9 +181,23 @@ public:
 private:
     PktState& _pktState(Index index);
     void _gotoPkt(Index index, bool notify);
-    bool _gotoNextErWithProp(const std::function<bool (const Er&)>& cmpFunc,
-                             const boost::optional<Index>& initPktIndex = boost::none,
-                             const boost::optional<Index>& initErIndex = boost::none);
+    bool _gotoErWithProp(const ErFinder::Pred& pred, bool isBackward,
+                         const std::atomic_bool *cancel, const ErFieldPred *fieldPred = nullptr);
+
+    bool _gotoNextBytePattern(const BytePatternFinder::Pattern& pattern,
+                              const std::atomic_bool *cancel);
+
+    /*
+     * Returns the indexes of the packet and of the event record within
+     * it from which to search the next event record.
+     */
+    std::pair<Index, Index> _nextErSearchStart();
+
+    /*
+     * Returns the indexes of the packet and of the event record within
+     * it before which (excluded) to search the previous event record.
+     */
+    std::pair<Index, Index> _prevErSearchEnd();
 
 private:
     AppState *_appState;
@@ -162,6 +206,27 @@ private:
     std::vector<std::unique_ptr<PktState>> _pktStates;
     PktCheckpointsBuildListener *_pktCheckpointsBuildListener;
     DsFile *_dsFile;
+
+    /*
+     * Last byte pattern match.
+     *
+     * A match may start within a packet region: as long as we're still
+     * at this packet region, the next search for the same pattern
+     * starts after the last match instead of after the beginning of
+     * the region.
+     */
+    struct _BytePatternMatch
+    {
+        BytePatternFinder::Pattern pattern;
+
+        // offset of the match within the data stream file (bytes)
+        Index offsetBytes;
+
+        // offset of the packet region we went to within the data stream file (bits)
+        Index regionOffsetInDsFileBits;
+    };
+
+    boost::optional<_BytePatternMatch> _lastBytePatternMatch;
 };
 
 } // namespace jacques
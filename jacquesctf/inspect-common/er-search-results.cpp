@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+
+#include "er-search-results.hpp"
+
+namespace jacques {
+
+ErSearchResults::ErSearchResults(const Index dsFileIndex, const Size maxStoredResultCount) :
+    _dsFileIndex {dsFileIndex},
+    _maxStoredResultCount {maxStoredResultCount}
+{
+}
+
+void ErSearchResults::append(const ErFinder::Result& result)
+{
+    assert(!_isDone);
+    ++_matchCount;
+
+    if (_storedResultCount == _maxStoredResultCount) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    _results.push_back(result);
+    _storedResultCount = _results.size();
+}
+
+ErFinder::Result ErSearchResults::operator[](const Index index) const
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    assert(index < _results.size());
+    return _results[index];
+}
+
+} // namespace jacques
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_INSPECT_COMMON_ER_SEARCH_RESULTS_HPP
+#define _JACQUES_INSPECT_COMMON_ER_SEARCH_RESULTS_HPP
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+#include "data/er-finder.hpp"
+
+namespace jacques {
+
+/*
+ * Results of a "find all" event record search within a data stream
+ * file.
+ *
+ * One thread (the search) appends results while another one (the
+ * user interface) reads them: all the methods are thread-safe.
+ *
+ * The result buffer is bounded: once it contains
+ * `maxStoredResultCount` results, the results object only counts the
+ * following matches.
+ */
+class ErSearchResults final :
+    boost::noncopyable
+{
+public:
+    explicit ErSearchResults(Index dsFileIndex, Size maxStoredResultCount = 1 << 20);
+
+    /*
+     * Appends a result; always succeeds, even if the result buffer is
+     * full.
+     */
+    void append(const ErFinder::Result& result);
+
+    /*
+     * Returns the stored result at index `index`.
+     */
+    ErFinder::Result operator[](Index index) const;
+
+    /*
+     * Marks these results as complete: no more results will be
+     * appended.
+     */
+    void isDone(bool isDone) noexcept
+    {
+        _isDone = isDone;
+    }
+
+    bool isDone() const noexcept
+    {
+        return _isDone;
+    }
+
+    /*
+     * Total number of matches so far, including the ones which aren't
+     * stored.
+     */
+    Size matchCount() const noexcept
+    {
+        return _matchCount;
+    }
+
+    /*
+     * Number of stored results so far (at most maxStoredResultCount()).
+     */
+    Size storedResultCount() const noexcept
+    {
+        return _storedResultCount;
+    }
+
+    Size maxStoredResultCount() const noexcept
+    {
+        return _maxStoredResultCount;
+    }
+
+    Index dsFileIndex() const noexcept
+    {
+        return _dsFileIndex;
+    }
+
+private:
+    const Index _dsFileIndex;
+    const Size _maxStoredResultCount;
+    std::vector<ErFinder::Result> _results;
+    mutable std::mutex _mutex;
+    std::atomic<Size> _matchCount {0};
+    std::atomic<Size> _storedResultCount {0};
+    std::atomic_bool _isDone {false};
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_INSPECT_COMMON_ER_SEARCH_RESULTS_HPP
@@ -7,18 +7,28 @@
 
 #include <cstdlib>
 #include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <vector>
 
 #include "search-query.hpp"
+#include "data/ert-id-set.hpp"
 
 namespace jacques {
 
-SearchQuery::SearchQuery(const bool isDiff) noexcept :
-    _isDiff {isDiff}
+SearchQuery::SearchQuery(const bool isDiff, const bool isTraceWide,
+                         const bool isBackward) noexcept :
+    _isDiff {isDiff},
+    _isTraceWide {isTraceWide},
+    _isBackward {isBackward}
 {
 }
 
-SimpleValSearchQuery::SimpleValSearchQuery(const bool isDiff, const long long val) noexcept :
-    SearchQuery {isDiff},
+SimpleValSearchQuery::SimpleValSearchQuery(const bool isDiff, const long long val,
+                                           const bool isTraceWide,
+                                           const bool isBackward) noexcept :
+    SearchQuery {isDiff, isTraceWide, isBackward},
     _val {val}
 {
 }
@@ -44,20 +54,37 @@ OffsetSearchQuery::OffsetSearchQuery(const bool isDiff, const long long val, con
 {
 }
 
-TimestampSearchQuery::TimestampSearchQuery(const bool isDiff, const long long val, const Unit unit) noexcept :
-    SimpleValSearchQuery {isDiff, val},
+TimestampSearchQuery::TimestampSearchQuery(const bool isDiff, const long long val, const Unit unit,
+                                           const bool isTraceWide) noexcept :
+    SimpleValSearchQuery {isDiff, val, isTraceWide},
     _unit {unit}
 {
 }
 
-ErtNameSearchQuery::ErtNameSearchQuery(std::string pattern) :
-    SearchQuery {false},
+ErtNameSearchQuery::ErtNameSearchQuery(std::string pattern, const bool isTraceWide,
+                                       const bool isBackward) :
+    SearchQuery {false, isTraceWide, isBackward},
     _pattern {std::move(pattern)}
 {
 }
 
-ErtIdSearchQuery::ErtIdSearchQuery(const long long val) noexcept :
-    SimpleValSearchQuery {false, val}
+ErtIdSearchQuery::ErtIdSearchQuery(const long long val, const bool isTraceWide,
+                                   const bool isBackward) noexcept :
+    SimpleValSearchQuery {false, val, isTraceWide, isBackward}
+{
+}
+
+ErFieldSearchQuery::ErFieldSearchQuery(ErFieldPred::Path path, ErFieldPred::Cond cond,
+                                       const bool isTraceWide, const bool isBackward) :
+    SearchQuery {false, isTraceWide, isBackward},
+    _path {std::move(path)},
+    _cond {std::move(cond)}
+{
+}
+
+BytePatternSearchQuery::BytePatternSearchQuery(BytePatternFinder::Pattern pattern) :
+    SearchQuery {false},
+    _pattern {std::move(pattern)}
 {
 }
 
@@ -76,8 +103,15 @@ void skipWs(std::string::const_iterator& it, std::string::const_iterator end)
     }
 }
 
+/*
+ * Parses a decimal, hexadecimal, or octal integer at `begin`.
+ *
+ * If `groupCommas` is true, then this function skips commas between
+ * the digits of a decimal integer (thousands separators).
+ */
 boost::optional<long long> parseInt(std::string::const_iterator& begin,
-                                    std::string::const_iterator end)
+                                    std::string::const_iterator end,
+                                    const bool groupCommas = true)
 {
     if (begin == end) {
         return boost::none;
@@ -94,7 +128,7 @@ boost::optional<long long> parseInt(std::string::const_iterator& begin,
     if (*begin != '0') {
         // remove commas
         for (auto it = begin; it != end; ++it) {
-            if (*it == ',') {
+            if (*it == ',' && groupCommas) {
                 ++nbCommas;
                 continue;
             }
@@ -220,7 +254,7 @@ std::unique_ptr<const SearchQuery> parseOffset(std::string::const_iterator& it,
 
 std::unique_ptr<const SearchQuery> parseTs(std::string::const_iterator& it,
                                            std::string::const_iterator end, const bool isDiff,
-                                           const long long mul)
+                                           const long long mul, const bool isTraceWide)
 {
     if (it == end) {
         return nullptr;
@@ -236,6 +270,11 @@ std::unique_ptr<const SearchQuery> parseTs(std::string::const_iterator& it,
     }
 
     if (*it == '*') {
+        if (isTraceWide) {
+            // clock values of different data stream files aren't comparable
+            return nullptr;
+        }
+
         unit = TimestampSearchQuery::Unit::CYCLE;
         ++it;
 
@@ -250,20 +289,17 @@ std::unique_ptr<const SearchQuery> parseTs(std::string::const_iterator& it,
         return nullptr;
     }
 
-    return std::make_unique<const TimestampSearchQuery>(isDiff, *val * mul, unit);
+    return std::make_unique<const TimestampSearchQuery>(isDiff, *val * mul, unit, isTraceWide);
 }
 
 std::unique_ptr<const SearchQuery> parseErtId(std::string::const_iterator& it,
-                                              std::string::const_iterator end, const bool isDiff)
+                                              std::string::const_iterator end,
+                                              const bool isTraceWide, const bool isBackward)
 {
     if (it == end) {
         return nullptr;
     }
 
-    if (isDiff) {
-        return nullptr;
-    }
-
     // skip '%'
     ++it;
 
@@ -277,20 +313,17 @@ std::unique_ptr<const SearchQuery> parseErtId(std::string::const_iterator& it,
         return nullptr;
     }
 
-    return std::make_unique<const ErtIdSearchQuery>(*val);
+    return std::make_unique<const ErtIdSearchQuery>(*val, isTraceWide, isBackward);
 }
 
 std::unique_ptr<const SearchQuery> parseErtName(std::string::const_iterator& it,
-                                                std::string::const_iterator end, const bool isDiff)
+                                                std::string::const_iterator end,
+                                                const bool isTraceWide, const bool isBackward)
 {
     if (it == end) {
         return nullptr;
     }
 
-    if (isDiff) {
-        return nullptr;
-    }
-
     // skip '/'
     ++it;
 
@@ -304,7 +337,321 @@ std::unique_ptr<const SearchQuery> parseErtName(std::string::const_iterator& it,
 
     // normalize pattern (no consecutive `*`)
     utils::normalizeGlobPattern(pattern);
-    return std::make_unique<const ErtNameSearchQuery>(std::move(pattern));
+    return std::make_unique<const ErtNameSearchQuery>(std::move(pattern), isTraceWide,
+                                                      isBackward);
+}
+
+boost::optional<long long> parseSignedInt(std::string::const_iterator& it,
+                                          std::string::const_iterator end,
+                                          const bool groupCommas = true)
+{
+    if (it == end) {
+        return boost::none;
+    }
+
+    auto mul = 1LL;
+
+    if (*it == '-') {
+        mul = -1LL;
+        ++it;
+    }
+
+    const auto val = parseInt(it, end, groupCommas);
+
+    if (!val) {
+        return boost::none;
+    }
+
+    return *val * mul;
+}
+
+boost::optional<yactfr::Scope> parseErFieldScope(const std::string& name)
+{
+    std::string lcName;
+
+    std::transform(name.begin(), name.end(), std::back_inserter(lcName),
+                   [](const char ch) {
+        return std::tolower(ch);
+    });
+
+    if (lcName == "erh" || lcName == "header") {
+        return yactfr::Scope::EVENT_RECORD_HEADER;
+    } else if (lcName == "ercc" || lcName == "ctx") {
+        return yactfr::Scope::EVENT_RECORD_COMMON_CONTEXT;
+    } else if (lcName == "ersc" || lcName == "sctx") {
+        return yactfr::Scope::EVENT_RECORD_SPECIFIC_CONTEXT;
+    } else if (lcName == "erp" || lcName == "payload") {
+        return yactfr::Scope::EVENT_RECORD_PAYLOAD;
+    }
+
+    return boost::none;
+}
+
+bool isErFieldPathChar(const char ch)
+{
+    return std::isalnum(ch) || ch == '_' || ch == '-' || ch == '.' || ch == '/';
+}
+
+boost::optional<ErFieldPred::Path> parseErFieldPath(std::string::const_iterator& it,
+                                                    std::string::const_iterator end)
+{
+    std::vector<std::string> names;
+    std::string curName;
+
+    while (it != end && isErFieldPathChar(*it)) {
+        if (*it == '.' || *it == '/') {
+            if (curName.empty()) {
+                return boost::none;
+            }
+
+            names.push_back(std::move(curName));
+            curName.clear();
+        } else {
+            curName += *it;
+        }
+
+        ++it;
+    }
+
+    if (curName.empty()) {
+        return boost::none;
+    }
+
+    names.push_back(std::move(curName));
+
+    if (names.size() < 2) {
+        // need at least a scope and a member name
+        return boost::none;
+    }
+
+    const auto scope = parseErFieldScope(names.front());
+
+    if (!scope) {
+        return boost::none;
+    }
+
+    names.erase(names.begin());
+    return ErFieldPred::Path {*scope, std::move(names)};
+}
+
+boost::optional<ErFieldPred::Op> parseErFieldOp(std::string::const_iterator& it,
+                                                std::string::const_iterator end)
+{
+    const auto rem = static_cast<Size>(end - it);
+    const auto startsWith = [&it, rem](const char * const str) {
+        const auto len = std::strlen(str);
+
+        return rem >= len && std::equal(str, str + len, it);
+    };
+
+    static const std::vector<std::pair<const char *, ErFieldPred::Op>> ops {
+        // longest first
+        {"==", ErFieldPred::Op::EQ},
+        {"!=", ErFieldPred::Op::NE},
+        {"<=", ErFieldPred::Op::LE},
+        {">=", ErFieldPred::Op::GE},
+        {"in", ErFieldPred::Op::IN},
+        {"=", ErFieldPred::Op::EQ},
+        {"<", ErFieldPred::Op::LT},
+        {">", ErFieldPred::Op::GT},
+    };
+
+    for (const auto& strOpPair : ops) {
+        if (startsWith(strOpPair.first)) {
+            it += std::strlen(strOpPair.first);
+            return strOpPair.second;
+        }
+    }
+
+    return boost::none;
+}
+
+boost::optional<std::string> parseQuotedStr(std::string::const_iterator& it,
+                                            std::string::const_iterator end)
+{
+    if (it == end || *it != '"') {
+        return boost::none;
+    }
+
+    ++it;
+
+    std::string str;
+
+    while (it != end) {
+        if (*it == '"') {
+            ++it;
+            return str;
+        }
+
+        if (*it == '\\') {
+            ++it;
+
+            if (it == end) {
+                return boost::none;
+            }
+        }
+
+        str += *it;
+        ++it;
+    }
+
+    // no closing quote
+    return boost::none;
+}
+
+std::unique_ptr<const SearchQuery> parseErField(std::string::const_iterator& it,
+                                                std::string::const_iterator end,
+                                                const bool isTraceWide, const bool isBackward)
+{
+    // skip '?'
+    ++it;
+    skipWs(it, end);
+
+    auto path = parseErFieldPath(it, end);
+
+    if (!path) {
+        return nullptr;
+    }
+
+    skipWs(it, end);
+
+    const auto op = parseErFieldOp(it, end);
+
+    if (!op) {
+        return nullptr;
+    }
+
+    skipWs(it, end);
+
+    if (it == end) {
+        return nullptr;
+    }
+
+    ErFieldPred::Cond cond {*op, 0LL, 0};
+
+    if (*op == ErFieldPred::Op::IN) {
+        // `[A, B]`
+        if (*it != '[') {
+            return nullptr;
+        }
+
+        ++it;
+        skipWs(it, end);
+
+        // `,` separates the bounds: don't group commas
+        const auto lower = parseSignedInt(it, end, false);
+
+        skipWs(it, end);
+
+        if (!lower || it == end || *it != ',') {
+            return nullptr;
+        }
+
+        ++it;
+        skipWs(it, end);
+
+        const auto upper = parseSignedInt(it, end, false);
+
+        skipWs(it, end);
+
+        if (!upper || it == end || *it != ']') {
+            return nullptr;
+        }
+
+        ++it;
+        cond.val = *lower;
+        cond.upperVal = *upper;
+    } else if (*it == '"') {
+        auto str = parseQuotedStr(it, end);
+
+        if (!str) {
+            return nullptr;
+        }
+
+        cond.val = std::move(*str);
+    } else {
+        const auto val = parseSignedInt(it, end);
+
+        if (!val) {
+            return nullptr;
+        }
+
+        cond.val = *val;
+    }
+
+    return std::make_unique<const ErFieldSearchQuery>(std::move(*path), std::move(cond),
+                                                      isTraceWide, isBackward);
+}
+
+boost::optional<unsigned int> hexDigitVal(const char ch)
+{
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    } else if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    } else if (ch >= 'A' && ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+
+    return boost::none;
+}
+
+std::unique_ptr<const SearchQuery> parseBytePattern(std::string::const_iterator& it,
+                                                    std::string::const_iterator end,
+                                                    const bool isDiff)
+{
+    if (isDiff) {
+        return nullptr;
+    }
+
+    // skip '&'
+    ++it;
+
+    BytePatternFinder::Pattern pattern;
+
+    // sequence of hexadecimal bytes and of double-quoted strings
+    while (true) {
+        skipWs(it, end);
+
+        if (it == end) {
+            break;
+        }
+
+        if (*it == '"') {
+            const auto str = parseQuotedStr(it, end);
+
+            if (!str) {
+                return nullptr;
+            }
+
+            std::copy(str->begin(), str->end(), std::back_inserter(pattern));
+            continue;
+        }
+
+        const auto highDigitVal = hexDigitVal(*it);
+
+        ++it;
+
+        if (!highDigitVal || it == end) {
+            return nullptr;
+        }
+
+        const auto lowDigitVal = hexDigitVal(*it);
+
+        ++it;
+
+        if (!lowDigitVal) {
+            return nullptr;
+        }
+
+        pattern.push_back(static_cast<std::uint8_t>(*highDigitVal * 16 + *lowDigitVal));
+    }
+
+    if (pattern.empty()) {
+        return nullptr;
+    }
+
+    return std::make_unique<const BytePatternSearchQuery>(std::move(pattern));
 }
 
 } // namespace
@@ -321,6 +668,18 @@ std::unique_ptr<const SearchQuery> parseSearchQuery(const std::string& input)
         return nullptr;
     }
 
+    bool isTraceWide = false;
+
+    // trace-wide search?
+    if (*it == '~') {
+        isTraceWide = true;
+        ++it;
+
+        if (it == input.end()) {
+            return nullptr;
+        }
+    }
+
     bool isDiff = false;
     auto mul = 1LL;
 
@@ -341,6 +700,17 @@ std::unique_ptr<const SearchQuery> parseSearchQuery(const std::string& input)
 
     std::unique_ptr<const SearchQuery> ret;
 
+    /*
+     * For event record searches, a differential search means the next
+     * (`+`) or the previous (`-`) matching event record.
+     */
+    const auto isBackward = isDiff && mul < 0;
+
+    if (isTraceWide && *it != '%' && *it != '/' && *it != '?' && *it != '*') {
+        // only event record and timestamp searches may be trace-wide
+        return nullptr;
+    }
+
     switch (*it) {
     case '#':
     case '@':
@@ -363,15 +733,23 @@ std::unique_ptr<const SearchQuery> parseSearchQuery(const std::string& input)
         break;
 
     case '*':
-        ret = parseTs(it, input.end(), isDiff, mul);
+        ret = parseTs(it, input.end(), isDiff, mul, isTraceWide);
         break;
 
     case '%':
-        ret = parseErtId(it, input.end(), isDiff);
+        ret = parseErtId(it, input.end(), isTraceWide, isBackward);
         break;
 
     case '/':
-        ret = parseErtName(it, input.end(), isDiff);
+        ret = parseErtName(it, input.end(), isTraceWide, isBackward);
+        break;
+
+    case '?':
+        ret = parseErField(it, input.end(), isTraceWide, isBackward);
+        break;
+
+    case '&':
+        ret = parseBytePattern(it, input.end(), isDiff);
         break;
 
     default:
@@ -394,4 +772,51 @@ std::unique_ptr<const SearchQuery> parseSearchQuery(const std::string& input)
     return ret;
 }
 
+ErFinder::Pred erPredFromSearchQuery(const SearchQuery& query, const Metadata& metadata)
+{
+    if (const auto sQuery = dynamic_cast<const ErtIdSearchQuery *>(&query)) {
+        if (sQuery->val() < 0) {
+            return {};
+        }
+
+        const auto id = static_cast<Index>(sQuery->val());
+
+        return [id](const PktIndexEntry&, const Er& er) {
+            if (!er.type()) {
+                return false;
+            }
+
+            return er.type()->id() == id;
+        };
+    } else if (const auto sQuery = dynamic_cast<const ErtNameSearchQuery *>(&query)) {
+        /*
+         * Match the pattern once against each event record type name
+         * of the trace type instead of once per visited event record.
+         */
+        const auto ertIdSet = std::make_shared<const ErtIdSet>(metadata.traceType(),
+                                                               [sQuery](const auto& ert) {
+            if (!ert.name()) {
+                return false;
+            }
+
+            return sQuery->matches(*ert.name());
+        });
+
+        if (ertIdSet->isEmpty()) {
+            // no event record type matches: don't decode anything
+            return ErFinder::NoErPred {};
+        }
+
+        return [ertIdSet](const PktIndexEntry& pktIndexEntry, const Er& er) {
+            if (!er.type() || !pktIndexEntry.dst()) {
+                return false;
+            }
+
+            return ertIdSet->contains(*pktIndexEntry.dst(), *er.type());
+        };
+    }
+
+    return {};
+}
+
 } // namespace jacques
@@ -13,13 +13,18 @@
 #include <boost/optional.hpp>
 
 #include "utils.hpp"
+#include "data/er.hpp"
+#include "data/er-finder.hpp"
+#include "data/metadata.hpp"
+#include "data/er-field-pred.hpp"
+#include "data/byte-pattern-finder.hpp"
 
 namespace jacques {
 
 class SearchQuery
 {
 protected:
-    SearchQuery(bool isDiff) noexcept;
+    SearchQuery(bool isDiff, bool isTraceWide = false, bool isBackward = false) noexcept;
 
 public:
     virtual ~SearchQuery() = default;
@@ -29,15 +34,36 @@ public:
         return _isDiff;
     }
 
+    /*
+     * True if this query applies to all the data stream files instead
+     * of only to the active one.
+     */
+    bool isTraceWide() const noexcept
+    {
+        return _isTraceWide;
+    }
+
+    /*
+     * True if this query searches the previous matching element
+     * instead of the next one.
+     */
+    bool isBackward() const noexcept
+    {
+        return _isBackward;
+    }
+
 private:
     const bool _isDiff;
+    const bool _isTraceWide;
+    const bool _isBackward;
 };
 
 class SimpleValSearchQuery :
     public SearchQuery
 {
 protected:
-    explicit SimpleValSearchQuery(bool isDiff, long long val) noexcept;
+    explicit SimpleValSearchQuery(bool isDiff, long long val, bool isTraceWide = false,
+                                  bool isBackward = false) noexcept;
 
 public:
     long long val() const noexcept
@@ -103,7 +129,8 @@ public:
     };
 
 public:
-    explicit TimestampSearchQuery(bool isDiff, long long val, Unit unit) noexcept;
+    explicit TimestampSearchQuery(bool isDiff, long long val, Unit unit,
+                                  bool isTraceWide = false) noexcept;
 
     Unit unit() const noexcept
     {
@@ -118,7 +145,8 @@ class ErtNameSearchQuery final :
     public SearchQuery
 {
 public:
-    explicit ErtNameSearchQuery(std::string pattern);
+    explicit ErtNameSearchQuery(std::string pattern, bool isTraceWide = false,
+                                bool isBackward = false);
 
     const std::string& pattern() const noexcept
     {
@@ -138,11 +166,72 @@ class ErtIdSearchQuery final :
     public SimpleValSearchQuery
 {
 public:
-    explicit ErtIdSearchQuery(long long val) noexcept;
+    explicit ErtIdSearchQuery(long long val, bool isTraceWide = false,
+                              bool isBackward = false) noexcept;
+};
+
+/*
+ * Event record field search query, for example `?payload.fd == 17` or
+ * `?ctx.tid in [100, 200]`.
+ */
+class ErFieldSearchQuery final :
+    public SearchQuery
+{
+public:
+    explicit ErFieldSearchQuery(ErFieldPred::Path path, ErFieldPred::Cond cond,
+                                bool isTraceWide = false, bool isBackward = false);
+
+    const ErFieldPred::Path& path() const noexcept
+    {
+        return _path;
+    }
+
+    const ErFieldPred::Cond& cond() const noexcept
+    {
+        return _cond;
+    }
+
+private:
+    const ErFieldPred::Path _path;
+    const ErFieldPred::Cond _cond;
+};
+
+/*
+ * Byte pattern search query, for example `&de ad be ef` or
+ * `&"GET" 20 2f`.
+ */
+class BytePatternSearchQuery final :
+    public SearchQuery
+{
+public:
+    explicit BytePatternSearchQuery(BytePatternFinder::Pattern pattern);
+
+    const BytePatternFinder::Pattern& pattern() const noexcept
+    {
+        return _pattern;
+    }
+
+private:
+    const BytePatternFinder::Pattern _pattern;
 };
 
 std::unique_ptr<const SearchQuery> parseSearchQuery(const std::string& input);
 
+/*
+ * Returns an event record predicate which corresponds to `query` for
+ * the data stream files described by `metadata`, or an empty function
+ * if `query` doesn't search for an event record having some property.
+ *
+ * If no event record type of `metadata` can match `query`, the
+ * returned predicate wraps an `ErFinder::NoErPred`, so that ErFinder
+ * doesn't decode anything.
+ *
+ * The returned predicate doesn't modify anything: you may call it
+ * concurrently from many threads, but `query` and `metadata` must
+ * exist as long as you use it.
+ */
+ErFinder::Pred erPredFromSearchQuery(const SearchQuery& query, const Metadata& metadata);
+
 } // namespace jacques
 
 #endif // _JACQUES_INSPECT_COMMON_SEARCH_QUERY_HPP
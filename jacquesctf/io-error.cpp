@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include "io-error.hpp"
+
+namespace jacques {
+
+void throwIOError(const boost::filesystem::path& path, const char * const what)
+{
+    std::ostringstream ss;
+
+    ss << "Cannot " << what << " file `" << path.string() << "`: " << std::strerror(errno) << ".";
+    throw IOError {path, ss.str()};
+}
+
+} // namespace jacques
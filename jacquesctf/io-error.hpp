@@ -10,6 +10,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <boost/filesystem.hpp>
 
 namespace jacques {
 
@@ -32,6 +33,13 @@ private:
     const boost::filesystem::path _path;
 };
 
+/*
+ * Throws an I/O error about the failed operation `what` (for example,
+ * `open` or `write`) on the file `path`, with the message of the
+ * current `errno` value.
+ */
+[[noreturn]] void throwIOError(const boost::filesystem::path& path, const char *what);
+
 } // namespace jacques
 
 #endif // _JACQUES_IO_ERROR_HPP
@@ -18,8 +18,18 @@
 #include "utils.hpp"
 #include "print-metadata-text-cmd.hpp"
 #include "list-pkts-cmd.hpp"
+#include "list-ers-cmd.hpp"
 #include "copy-pkts-cmd.hpp"
 #include "create-lttng-index-cmd.hpp"
+#include "slice-cmd.hpp"
+#include "stats-cmd.hpp"
+#include "check-cmd.hpp"
+#include "diff-pkts-cmd.hpp"
+#include "merge-pkts-cmd.hpp"
+#include "query-cmd.hpp"
+#include "serve-cmd.hpp"
+#include "export-columnar-cmd.hpp"
+#include "split-cmd.hpp"
 
 #ifdef JACQUES_HAS_INSPECT_CMD
 # include "inspect-cmd/ui/inspect-cmd.hpp"
@@ -60,14 +70,63 @@ void printCliUsage(const char * const cmdName)
     std::puts("");
     std::puts("`list-packets` command");
     std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
-    std::puts("Usage: list-packets --machine [--header] PATH");
+    std::puts("Usage: list-packets (--machine [--header] | --json | --binary) [--where=EXPR]");
+    std::puts("                    PATH...");
     std::puts("");
-    std::puts("Print the list of packets of CTF data stream file PATH and their properties.");
+    std::puts("Print the list of packets of CTF data stream files and their properties.");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("With more than one data stream file, the first CSV column is the path of the");
+    std::puts("data stream file.");
+    std::puts("");
+    std::puts("List the data stream files in the given order, except that the ones of a same");
+    std::puts("trace directory are grouped where this directory first appears.");
+    std::puts("");
+    std::puts("Except with --binary, print nothing (not even the header) if there's no packet.");
     std::puts("");
     std::puts("Options:");
     std::puts("");
+    std::puts("  --binary       Print compact little-endian binary records");
     std::puts("  --header       Print table header");
+    std::puts("  --json         Print JSON lines");
     std::puts("  --machine, -m  Print machine-readable data (CSV)");
+    std::puts("  --where=EXPR   Only print the packets satisfying the expression EXPR");
+    std::puts("");
+    std::puts("EXPR combines packet properties, integers, the `+`, `-`, `*`, `/`, and `%`");
+    std::puts("operators, the `==`, `!=`, `<`, `<=`, `>`, and `>=` comparisons, and the `and`,");
+    std::puts("`or`, and `not` logical operators. Packet properties are:");
+    std::puts("");
+    std::puts("  index, offset_bytes, total_len_bits, content_len_bits, begin_ts_cycles,");
+    std::puts("  begin_ts_ns, end_ts_cycles, end_ts_ns, duration_cycles, duration_ns,");
+    std::puts("  seq_num, ds_id, dst_id, disc_er_counter, is_invalid");
+    std::puts("");
+    std::puts("`delta(PROP)` is the difference between the property PROP of a packet and the");
+    std::puts("one of the previous packet. An integer may have the `ns`, `us`, `ms`, or `s`");
+    std::puts("suffix to express a duration in nanoseconds. A packet without a given");
+    std::puts("property never satisfies a comparison involving it.");
+    std::puts("");
+    std::puts("`list-events` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: list-events [--json | --header] [--payload | --time-order] PATH...");
+    std::puts("");
+    std::puts("Print the list of event records of CTF data stream files and their properties");
+    std::puts("(CSV by default).");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("If a packet can't be fully decoded, print an error and exit with status 1");
+    std::puts("(with --time-order, stop at this packet).");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --header      Print table header");
+    std::puts("  --json        Print JSON lines instead of CSV");
+    std::puts("  --payload     Also print the payload of each event record (JSON object)");
+    std::puts("  --time-order  Merge the event records of all the data stream files in");
+    std::puts("                timestamp order instead of printing them file by file");
     std::puts("");
     std::puts("`copy-packets` command");
     std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
@@ -102,12 +161,222 @@ void printCliUsage(const char * const cmdName)
     std::puts("");
     std::puts("`create-lttng-index` command");
     std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
-    std::puts("Usage: create-lttng-index PATH...");
+    std::puts("Usage: create-lttng-index [--force] PATH...");
     std::puts("");
     std::puts("Create an LTTng index file for each specified CTF data stream file.");
     std::puts("");
+    std::puts("Skip the data stream files of which the LTTng index file is newer than them and");
+    std::puts("consistent with them, unless --force is specified.");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("`slice` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: slice [--cycles] BEGIN END DST-DIR PATH...");
+    std::puts("");
+    std::puts("Copy the packets of CTF data stream files which overlap the time range");
+    std::puts("[BEGIN, END] to the new trace directory DST-DIR, with the metadata stream file");
+    std::puts("of each trace, and create their LTTng index files.");
+    std::puts("");
+    std::puts("BEGIN and END are nanoseconds from origin, or clock cycles with --cycles.");
+    std::puts("Packets without beginning and end timestamps are not copied.");
+    std::puts("");
     std::puts("If PATH is a CTF data stream file, use this file.");
     std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("DST-DIR keeps the directory layout of the traces relative to their deepest");
+    std::puts("common directory.");
+    std::puts("");
+    std::puts("`stats` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: stats [--csv] [--sample=N] PATH...");
+    std::puts("");
+    std::puts("Print, for each event record type, the count, total, mean, and maximum sizes,");
+    std::puts("and rate (event records/s) of the event records of each CTF data stream file");
+    std::puts("and of each trace.");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("If a packet can't be fully decoded, print an error after the statistics and");
+    std::puts("exit with status 1.");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --csv         Print CSV instead of tables");
+    std::puts("  --sample=N    Only decode one packet out of N of each data stream file and");
+    std::puts("                extrapolate the counts and total sizes (approximate)");
+    std::puts("");
+    std::puts("`check` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: check [--json] [--fail-fast] PATH...");
+    std::puts("");
+    std::puts("Fully decode all the packets of CTF data stream files and print one line per");
+    std::puts("invalid packet (CSV by default): data stream file path, packet index, packet");
+    std::puts("offset (bytes), offset of the error in the data stream file (bits), and reason.");
+    std::puts("");
+    std::puts("Exit with status 0 if all the packets are valid, 2 if there's at least one");
+    std::puts("invalid packet, or 1 on any other error.");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --fail-fast  Stop at the first invalid packet");
+    std::puts("  --json       Print JSON lines instead of CSV");
+    std::puts("");
+    std::puts("`diff-packets` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: diff-packets [--align=KEY] [--json] PATH-A PATH-B");
+    std::puts("");
+    std::puts("Pair the packets of the CTF data stream files PATH-A and PATH-B, compare the");
+    std::puts("hashes of their contents, and print one line per added, removed, or changed");
+    std::puts("packet (CSV by default): kind, key, packet indexes, packet offsets (bytes),");
+    std::puts("first differing byte within the packet, and event record containing it.");
+    std::puts("");
+    std::puts("Only the changed packets of PATH-A are decoded.");
+    std::puts("");
+    std::puts("Exit with status 0 if both data stream files have the same packets, 2 if");
+    std::puts("they differ, or 1 on any other error.");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --align=KEY  Pair packets by KEY: `seq-num` (sequence number), `ts`");
+    std::puts("               (beginning timestamp), or `index` (default: sequence number");
+    std::puts("               if all packets have one, otherwise beginning timestamp if all");
+    std::puts("               packets have one, otherwise index); fail if a packet doesn't");
+    std::puts("               have the explicit key");
+    std::puts("  --json       Print JSON lines instead of CSV");
+    std::puts("");
+    std::puts("`merge-packets` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: merge-packets [--order=KEY] [--drop-duplicates] DST-PATH SRC-PATH...");
+    std::puts("");
+    std::puts("Write the packets of the CTF data stream files SRC-PATH, which must be part of");
+    std::puts("the same data stream, to the data stream file DST-PATH, ordered by KEY.");
+    std::puts("");
+    std::puts("This command doesn't decode the packets: it only uses their indexes.");
+    std::puts("");
+    std::puts("Fail if two packets have the same sequence number, unless --drop-duplicates");
+    std::puts("is specified.");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --drop-duplicates  Only keep the first packet having a given sequence number");
+    std::puts("  --order=KEY        Order packets by KEY: `seq-num` (sequence number) or `ts`");
+    std::puts("                     (beginning timestamp) (default: sequence number if all");
+    std::puts("                     packets have one, otherwise beginning timestamp)");
+    std::puts("");
+    std::puts("`query` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: query [--all] [--json] [-e QUERY]... PATH...");
+    std::puts("");
+    std::puts("Run the search queries QUERY (same syntax as with the `inspect` command), or");
+    std::puts("the ones read from the standard input (one per line) if there's no -e option,");
+    std::puts("in order, without a user interface, and print the resulting locations (CSV by");
+    std::puts("default): query, status, data stream file path, packet index, event record");
+    std::puts("index, offset (bits), and timestamp (cycles and ns from origin).");
+    std::puts("");
+    std::puts("Like with the `inspect` command, each query starts at the location of the");
+    std::puts("previous one, and the packets stay in memory between queries.");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --all                  Print all the event records matching each event");
+    std::puts("                         record query instead of going to the next one");
+    std::puts("                         (within all the data stream files if the query is");
+    std::puts("                         trace-wide), or all the occurrences of each byte");
+    std::puts("                         pattern query within the current data stream file");
+    std::puts("                         (without any event record index or timestamp)");
+    std::puts("  --json                 Print JSON lines instead of CSV");
+    std::puts("  --query=QUERY, -e      Run QUERY (can be repeated)");
+    std::puts("");
+    std::puts("`serve` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: serve [--mem-budget=MIB] SOCKET-PATH PATH...");
+    std::puts("");
+    std::puts("Index the data stream files once, then answer the requests of any number of");
+    std::puts("concurrent clients connected to the Unix domain socket SOCKET-PATH until");
+    std::puts("interrupted.");
+    std::puts("");
+    std::puts("A request is a frame (32-bit little-endian length followed with as many bytes)");
+    std::puts("containing a request name and its arguments, separated with spaces. The");
+    std::puts("server replies with a frame containing `ok` and a newline followed with JSON");
+    std::puts("lines, or `error` and a newline followed with an error message.");
+    std::puts("");
+    std::puts("Indexes are natural (1-based). Requests:");
+    std::puts("");
+    std::puts("  info                          List the data stream files");
+    std::puts("  packets DSF [PKT [COUNT]]     List the packets of data stream file DSF");
+    std::puts("  search DSF QUERY              List all the event records of data stream");
+    std::puts("                                file DSF matching the event record search");
+    std::puts("                                query QUERY (same syntax as with the");
+    std::puts("                                `inspect` command)");
+    std::puts("  event-record DSF PKT ER       Decode event record ER of packet PKT of data");
+    std::puts("                                stream file DSF, including its payload");
+    std::puts("  regions DSF PKT [OFF [LEN]]   List the regions, with their data, of packet");
+    std::puts("                                PKT of data stream file DSF, from the offset");
+    std::puts("                                OFF to the offset OFF + LEN (bits)");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --mem-budget=MIB  Keep at most about MIB MiB of decoded packets in memory");
+    std::puts("                    (default: 512)");
+    std::puts("");
+    std::puts("`export-columnar` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: export-columnar DST-DIR-PATH PATH...");
+    std::puts("");
+    std::puts("Decode all the event records and write, for each event record type, one");
+    std::puts("column file set per scalar field (not within an array) and per location");
+    std::puts("(data stream file, packet, and event record indexes, offset, timestamp) to the");
+    std::puts("new or empty directory DST-DIR-PATH, with a `manifest.json` file describing");
+    std::puts("them.");
+    std::puts("");
+    std::puts("For each column, `N.validity` has one byte per row (1 if the row has a value),");
+    std::puts("and `N.values` has 8 little-endian bytes (`u64`, `s64`, `f64`) or 1 byte");
+    std::puts("(`bool`) per row. For `string` and `blob` columns, `N.values` is the");
+    std::puts("concatenated values and `N.offsets` has row count + 1 little-endian 64-bit");
+    std::puts("offsets within it.");
+    std::puts("");
+    std::puts("If PATH is a CTF data stream file, use this file.");
+    std::puts("If PATH is a directory, use all the CTF data stream files found recursively.");
+    std::puts("");
+    std::puts("If a packet can't be fully decoded, export its event records preceding the");
+    std::puts("error, print an error once done, and exit with status 1.");
+    std::puts("");
+    std::puts("`split` command");
+    std::puts("¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯");
+    std::puts("Usage: split [--max-size=SIZE] [--max-packets=COUNT] [--max-duration=DURATION]");
+    std::puts("             DST-DIR SRC-PATH");
+    std::puts("");
+    std::puts("Split the CTF data stream file SRC-PATH, at packet boundaries, into the data");
+    std::puts("stream files `NAME-1`, `NAME-2`, and so on of the new directory DST-DIR, with");
+    std::puts("the metadata stream file of the trace, and create their LTTng index files.");
+    std::puts("");
+    std::puts("NAME is the name of SRC-PATH. The part numbers are zero-padded to the width of");
+    std::puts("the largest one so that the names sort naturally (for example, `NAME-01` to");
+    std::puts("`NAME-12`).");
+    std::puts("");
+    std::puts("A new data stream file begins when the next packet would exceed any of the");
+    std::puts("given limits. A packet larger than SIZE is alone in its data stream file.");
+    std::puts("");
+    std::puts("Options:");
+    std::puts("");
+    std::puts("  --max-duration=DURATION  Maximum duration between the beginning of the first");
+    std::puts("                           packet and the end of the last packet (nanoseconds,");
+    std::puts("                           or with the `us`, `ms`, or `s` suffix)");
+    std::puts("  --max-packets=COUNT      Maximum packet count");
+    std::puts("  --max-size=SIZE          Maximum size (bytes, or with the `K`, `M`, or `G`");
+    std::puts("                           binary suffix)");
 }
 
 void printVersion()
@@ -115,7 +384,10 @@ void printVersion()
     std::cout << "Jacques CTF " JACQUES_VERSION << std::endl;
 }
 
-void jacques(const int argc, const char *argv[])
+/*
+ * Returns the exit status.
+ */
+int jacques(const int argc, const char *argv[])
 {
     const auto cfg = cfgFromArgs(argc, argv);
 
@@ -127,10 +399,40 @@ void jacques(const int argc, const char *argv[])
         printMetadataTextCmd(*specCfg);
     } else if (const auto specCfg = dynamic_cast<const ListPktsCfg *>(cfg.get())) {
         listPktsCmd(*specCfg);
+    } else if (const auto specCfg = dynamic_cast<const ListErsCfg *>(cfg.get())) {
+        if (!listErsCmd(*specCfg)) {
+            return 1;
+        }
     } else if (const auto specCfg = dynamic_cast<const CopyPktsCfg *>(cfg.get())) {
         copyPktsCmd(*specCfg);
     } else if (const auto specCfg = dynamic_cast<const CreateLttngIndexCfg *>(cfg.get())) {
         createLttngIndexCmd(*specCfg);
+    } else if (const auto specCfg = dynamic_cast<const SliceCfg *>(cfg.get())) {
+        sliceCmd(*specCfg);
+    } else if (const auto specCfg = dynamic_cast<const StatsCfg *>(cfg.get())) {
+        if (!statsCmd(*specCfg)) {
+            return 1;
+        }
+    } else if (const auto specCfg = dynamic_cast<const CheckCfg *>(cfg.get())) {
+        if (!checkCmd(*specCfg)) {
+            return 2;
+        }
+    } else if (const auto specCfg = dynamic_cast<const DiffPktsCfg *>(cfg.get())) {
+        if (!diffPktsCmd(*specCfg)) {
+            return 2;
+        }
+    } else if (const auto specCfg = dynamic_cast<const MergePktsCfg *>(cfg.get())) {
+        mergePktsCmd(*specCfg);
+    } else if (const auto specCfg = dynamic_cast<const QueryCfg *>(cfg.get())) {
+        queryCmd(*specCfg);
+    } else if (const auto specCfg = dynamic_cast<const ServeCfg *>(cfg.get())) {
+        serveCmd(*specCfg);
+    } else if (const auto specCfg = dynamic_cast<const ExportColumnarCfg *>(cfg.get())) {
+        if (!exportColumnarCmd(*specCfg)) {
+            return 1;
+        }
+    } else if (const auto specCfg = dynamic_cast<const SplitCfg *>(cfg.get())) {
+        splitCmd(*specCfg);
     } else if (const auto specCfg = dynamic_cast<const InspectCfg *>(cfg.get())) {
 #ifdef JACQUES_HAS_INSPECT_CMD
         inspectCmd(*specCfg);
@@ -140,6 +442,8 @@ void jacques(const int argc, const char *argv[])
     } else {
         std::abort();
     }
+
+    return 0;
 }
 
 } // namespace
@@ -147,12 +451,15 @@ void jacques(const int argc, const char *argv[])
 
 int main(const int argc, const char *argv[])
 {
-    const auto exStr = jacques::utils::tryFunc([argc, argv] {
-        jacques::jacques(argc, argv);
+    auto status = 0;
+    const auto exStr = jacques::utils::tryFunc([argc, argv, &status] {
+        status = jacques::jacques(argc, argv);
     });
 
     if (exStr) {
         jacques::utils::error() << *exStr << std::endl;
         return 1;
     }
+
+    return status;
 }
@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <sstream>
+#include <unistd.h>
+
+#include "cfg.hpp"
+#include "list-ers-cmd.hpp"
+#include "buf-writer.hpp"
+#include "ordered-chunk-queue.hpp"
+#include "payload-json-formatter.hpp"
+#include "utils.hpp"
+#include "worker-pool.hpp"
+#include "ds-file-set.hpp"
+#include "data/trace.hpp"
+#include "data/ds-file.hpp"
+#include "data/pkt-decoder.hpp"
+#include "data/merged-er-iterator.hpp"
+
+namespace jacques {
+
+namespace {
+
+/*
+ * Event record row formatter.
+ *
+ * `dsFilePathField` is the already escaped (CSV field or JSON string)
+ * path of the data stream file.
+ */
+class RowFormatter final
+{
+public:
+    explicit RowFormatter(const ListErsCfg::Fmt fmt) :
+        _fmt {fmt}
+    {
+    }
+
+    void appendHeader(std::string& out, const bool withPayload) const
+    {
+        assert(_fmt == ListErsCfg::Fmt::CSV);
+        out += "Data stream file,Packet index,Index,Offset in data stream file (bits),"
+               "Event record type ID,Event record type name,Timestamp (cycles),"
+               "Timestamp (ns)";
+
+        if (withPayload) {
+            out += ",Payload";
+        }
+
+        out += '\n';
+    }
+
+    void appendRow(std::string& out, const std::string& dsFilePathField,
+                   const PktIndexEntry& pktIndexEntry, Index indexInPkt,
+                   const PktSegment& segment, const yactfr::EventRecordType *ert,
+                   const boost::optional<Ts>& ts, const std::string *payloadJson) const;
+
+private:
+    const ListErsCfg::Fmt _fmt;
+};
+
+void RowFormatter::appendRow(std::string& out, const std::string& dsFilePathField,
+                             const PktIndexEntry& pktIndexEntry, const Index indexInPkt,
+                             const PktSegment& segment, const yactfr::EventRecordType * const ert,
+                             const boost::optional<Ts>& ts,
+                             const std::string * const payloadJson) const
+{
+    const auto offsetInDsFileBits = pktIndexEntry.offsetInDsFileBits() +
+                                    segment.offsetInPktBits();
+
+    if (_fmt == ListErsCfg::Fmt::CSV) {
+        out += dsFilePathField;
+        out += ',';
+        utils::appendUInt(out, pktIndexEntry.natIndexInDsFile());
+        out += ',';
+        utils::appendUInt(out, indexInPkt + 1);
+        out += ',';
+        utils::appendUInt(out, offsetInDsFileBits);
+        out += ',';
+
+        if (ert) {
+            utils::appendUInt(out, ert->id());
+        }
+
+        out += ',';
+
+        if (ert && ert->name()) {
+            utils::appendCsvField(out, *ert->name());
+        }
+
+        out += ',';
+
+        if (ts) {
+            utils::appendUInt(out, ts->cycles());
+            out += ',';
+            utils::appendInt(out, ts->nsFromOrigin());
+        } else {
+            out += ',';
+        }
+
+        if (payloadJson) {
+            out += ',';
+            utils::appendCsvField(out, *payloadJson);
+        }
+
+        out += '\n';
+        return;
+    }
+
+    out += "{\"path\":";
+    out += dsFilePathField;
+    out += ",\"packet-index\":";
+    utils::appendUInt(out, pktIndexEntry.natIndexInDsFile());
+    out += ",\"index\":";
+    utils::appendUInt(out, indexInPkt + 1);
+    out += ",\"offset-bits\":";
+    utils::appendUInt(out, offsetInDsFileBits);
+    out += ",\"type-id\":";
+
+    if (ert) {
+        utils::appendUInt(out, ert->id());
+    } else {
+        out += "null";
+    }
+
+    out += ",\"type-name\":";
+
+    if (ert && ert->name()) {
+        utils::appendJsonStr(out, *ert->name());
+    } else {
+        out += "null";
+    }
+
+    if (ts) {
+        out += ",\"ts-cycles\":";
+        utils::appendUInt(out, ts->cycles());
+        out += ",\"ts-ns\":";
+        utils::appendInt(out, ts->nsFromOrigin());
+    } else {
+        out += ",\"ts-cycles\":null,\"ts-ns\":null";
+    }
+
+    if (payloadJson) {
+        out += ",\"payload\":";
+
+        if (payloadJson->empty()) {
+            // no payload
+            out += "null";
+        } else {
+            out += *payloadJson;
+        }
+    }
+
+    out += "}\n";
+}
+
+std::string dsFilePathField(const DsFile& dsFile, const ListErsCfg::Fmt fmt)
+{
+    std::string field;
+
+    if (fmt == ListErsCfg::Fmt::CSV) {
+        utils::appendCsvField(field, dsFile.path().string());
+    } else {
+        utils::appendJsonStr(field, dsFile.path().string());
+    }
+
+    return field;
+}
+
+/*
+ * Formatted rows of a packet.
+ */
+struct PktRows
+{
+    std::string rows;
+
+    // error message if the packet couldn't be fully decoded
+    std::string errorMsg;
+};
+
+/*
+ * Lists the event records of `dsFiles` in data stream file order,
+ * decoding the packets in parallel.
+ *
+ * Each packet is a work unit: a worker decodes it and formats all its
+ * rows to a single chunk, then puts this chunk into an ordered chunk
+ * queue from which this thread writes the chunks in packet order.
+ *
+ * Prints an error for each packet which can't be fully decoded
+ * (having listed its event records up to the error) and returns
+ * `false` if there's any.
+ */
+bool listErsInFileOrder(const std::vector<const DsFile *>& dsFiles, const ListErsCfg& cfg,
+                        BufWriter& writer)
+{
+    struct Unit
+    {
+        Index dsFileIndex;
+        const PktIndexEntry *pktIndexEntry;
+    };
+
+    std::vector<Unit> units;
+    std::vector<std::string> pathFields;
+
+    for (Index dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+        const auto& dsFile = *dsFiles[dsFileIndex];
+
+        for (const auto& pktIndexEntry : dsFile.pktIndexEntries()) {
+            units.push_back({dsFileIndex, &pktIndexEntry});
+        }
+
+        pathFields.push_back(dsFilePathField(dsFile, cfg.format()));
+    }
+
+    if (units.empty()) {
+        return true;
+    }
+
+    const WorkerPool pool;
+    const RowFormatter rowFormatter {cfg.format()};
+    OrderedChunkQueue<PktRows> queue {pool.workerCount() * 4};
+    std::atomic<Index> nextUnitIndex {0};
+    std::exception_ptr exc;
+
+    const auto work = [&](Index) {
+        /*
+         * Units are ordered by data stream file, so a worker mostly
+         * gets consecutive packets of the same data stream file: only
+         * keep the decoder of the current one.
+         */
+        std::unique_ptr<PktDecoder> decoder;
+        PayloadJsonFormatter payloadFormatter;
+        PktRows chunk;
+
+        PktDecoder::ErElemFunc erElemFunc;
+
+        if (cfg.withPayload()) {
+            erElemFunc = [&payloadFormatter](const yactfr::Element& elem) {
+                payloadFormatter.feed(elem);
+            };
+        }
+
+        try {
+            while (true) {
+                const auto unitIndex = nextUnitIndex++;
+
+                if (unitIndex >= units.size()) {
+                    return;
+                }
+
+                const auto& unit = units[unitIndex];
+                const auto& dsf = *dsFiles[unit.dsFileIndex];
+
+                if (!decoder || &decoder->dsFile() != &dsf) {
+                    decoder = std::make_unique<PktDecoder>(dsf);
+                }
+
+                chunk.rows.clear();
+                chunk.errorMsg.clear();
+                payloadFormatter.reset();
+                decoder->forEachEr(*unit.pktIndexEntry, [&](const Er& er) {
+                    rowFormatter.appendRow(chunk.rows, pathFields[unit.dsFileIndex],
+                                           *unit.pktIndexEntry, er.indexInPkt(), er.segment(),
+                                           er.type(), er.ts(),
+                                           cfg.withPayload() ? &payloadFormatter.json() :
+                                           nullptr);
+                    payloadFormatter.reset();
+                    return true;
+                }, erElemFunc);
+
+                if (const auto& error = decoder->lastDecodingError()) {
+                    std::ostringstream ss;
+
+                    ss << "Cannot decode packet " << unit.pktIndexEntry->natIndexInDsFile() <<
+                          " of data stream file `" << dsf.path().string() <<
+                          "` at offset " <<
+                          error->offset() << " bits: " << error->reason();
+                    chunk.errorMsg = ss.str();
+                }
+
+                if (!queue.put(unitIndex, std::move(chunk))) {
+                    // cancelled
+                    return;
+                }
+            }
+        } catch (...) {
+            // make the writer stop waiting for this chunk
+            queue.cancel();
+            throw;
+        }
+    };
+
+    std::thread producer {[&pool, &work, &units, &exc] {
+        try {
+            pool.run(work, units.size());
+        } catch (...) {
+            exc = std::current_exception();
+        }
+    }};
+
+    auto isSuccess = true;
+
+    try {
+        PktRows chunk;
+
+        for (Index unitIndex = 0; unitIndex < units.size(); ++unitIndex) {
+            if (!queue.take(chunk)) {
+                break;
+            }
+
+            writer.write(chunk.rows);
+
+            if (!chunk.errorMsg.empty()) {
+                utils::error() << chunk.errorMsg << std::endl;
+                isSuccess = false;
+            }
+        }
+    } catch (...) {
+        queue.cancel();
+        producer.join();
+        throw;
+    }
+
+    producer.join();
+
+    if (exc) {
+        std::rethrow_exception(exc);
+    }
+
+    return isSuccess;
+}
+
+/*
+ * Lists the event records of `dsFiles` in timestamp order.
+ *
+ * Throws `yactfr::DecodingError` if a packet can't be fully decoded:
+ * the following event records of its data stream file are missing.
+ */
+void listErsInTimeOrder(const std::vector<const DsFile *>& dsFiles, const ListErsCfg& cfg,
+                        BufWriter& writer)
+{
+    const RowFormatter rowFormatter {cfg.format()};
+    std::vector<std::string> pathFields;
+
+    for (const auto dsFile : dsFiles) {
+        pathFields.push_back(dsFilePathField(*dsFile, cfg.format()));
+    }
+
+    MergedErIterator it {dsFiles};
+    std::string row;
+
+    while (const auto entry = it.next()) {
+        row.clear();
+        rowFormatter.appendRow(row, pathFields[entry->dsFileIndex], *entry->pktIndexEntry,
+                               entry->indexInPkt, entry->segment, entry->type, entry->ts,
+                               nullptr);
+        writer.write(row);
+    }
+}
+
+} // namespace
+
+bool listErsCmd(const ListErsCfg& cfg)
+{
+    DsFileSet dsFileSet {cfg.paths()};
+
+    dsFileSet.buildIndexes();
+
+    const auto dsFiles = dsFileSet.constDsFiles();
+    BufWriter writer {STDOUT_FILENO, "standard output"};
+
+    if (cfg.withHeader()) {
+        std::string header;
+
+        RowFormatter {cfg.format()}.appendHeader(header, cfg.withPayload());
+        writer.write(header);
+    }
+
+    auto isSuccess = true;
+
+    if (cfg.timeOrder()) {
+        try {
+            listErsInTimeOrder(dsFiles, cfg, writer);
+        } catch (const yactfr::DecodingError&) {
+            // keep the event records listed so far
+            writer.flush();
+            throw;
+        }
+    } else {
+        isSuccess = listErsInFileOrder(dsFiles, cfg, writer);
+    }
+
+    writer.flush();
+    return isSuccess;
+}
+
+} // namespace jacques
@@ -5,51 +5,238 @@
  * prohibited. Proprietary and confidential.
  */
 
-#include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <unistd.h>
+#include <boost/endian/buffers.hpp>
 
 #include "cfg.hpp"
 #include "list-pkts-cmd.hpp"
+#include "buf-writer.hpp"
+#include "ds-file-set.hpp"
+#include "pkt-filter.hpp"
+#include "utils.hpp"
 #include "data/trace.hpp"
 #include "data/ds-file.hpp"
 #include "data/time-ops.hpp"
 
 namespace jacques {
+
+namespace bendian = boost::endian;
+
 namespace {
 
-void printHeader(const ListPktsCfg::Fmt fmt)
+/*
+ * Binary output format (all integers are little-endian):
+ *
+ * 1. Header (`BinHeader`).
+ *
+ * 2. For each data stream file:
+ *
+ *    a) Data stream file record (`BinDsFileRecord`), followed with
+ *       the path of the data stream file (`pathLen` bytes, not
+ *       null-terminated).
+ *
+ *    b) `pktCount` packet records (`BinPktRecord`).
+ *
+ * A packet record field is only meaningful if its corresponding bit
+ * of `flags` is set (see the `BIN_PKT_FLAG_*` constants).
+ */
+struct BinHeader {
+    // `JCPL`
+    bendian::little_uint32_buf_t magic;
+
+    bendian::little_uint32_buf_t version;
+    bendian::little_uint32_buf_t pktRecordSizeBytes;
+    bendian::little_uint32_buf_t dsFileCount;
+};
+
+struct BinDsFileRecord {
+    bendian::little_uint64_buf_t pktCount;
+    bendian::little_uint32_buf_t pathLen;
+};
+
+struct BinPktRecord {
+    bendian::little_uint64_buf_t index;
+    bendian::little_uint64_buf_t offsetBytes;
+    bendian::little_uint64_buf_t totalLenBytes;
+    bendian::little_uint64_buf_t contentLenBits;
+    bendian::little_uint64_buf_t beginTsCycles;
+    bendian::little_int64_buf_t beginTsNs;
+    bendian::little_uint64_buf_t endTsCycles;
+    bendian::little_int64_buf_t endTsNs;
+    bendian::little_uint64_buf_t dstId;
+    bendian::little_uint64_buf_t dsId;
+    bendian::little_uint64_buf_t seqNum;
+    bendian::little_uint64_buf_t discErCounterSnap;
+    bendian::little_uint64_buf_t flags;
+};
+
+static_assert(sizeof(BinHeader) == 4 * 4, "Binary header structure has the expected size.");
+static_assert(sizeof(BinDsFileRecord) == 8 + 4,
+              "Binary data stream file record structure has the expected size.");
+static_assert(sizeof(BinPktRecord) == 13 * 8,
+              "Binary packet record structure has the expected size.");
+
+constexpr std::uint64_t BIN_PKT_FLAG_HAS_BEGIN_TS = 1 << 0;
+constexpr std::uint64_t BIN_PKT_FLAG_HAS_END_TS = 1 << 1;
+constexpr std::uint64_t BIN_PKT_FLAG_HAS_DST_ID = 1 << 2;
+constexpr std::uint64_t BIN_PKT_FLAG_HAS_DS_ID = 1 << 3;
+constexpr std::uint64_t BIN_PKT_FLAG_HAS_SEQ_NUM = 1 << 4;
+constexpr std::uint64_t BIN_PKT_FLAG_HAS_DISC_ER_COUNTER_SNAP = 1 << 5;
+constexpr std::uint64_t BIN_PKT_FLAG_IS_VALID = 1 << 6;
+
+template <typename DataT>
+void writeData(BufWriter& writer, const DataT& data)
+{
+    writer.write(reinterpret_cast<const char *>(&data), sizeof(data));
+}
+
+void writeBinHeader(BufWriter& writer, const std::vector<DsFile *>& dsFiles)
+{
+    BinHeader header;
+
+    header.magic = 0x4c50434aU;
+    header.version = 1;
+    header.pktRecordSizeBytes = sizeof(BinPktRecord);
+    header.dsFileCount = static_cast<std::uint32_t>(dsFiles.size());
+    writeData(writer, header);
+}
+
+void writeBinDsFileRecord(BufWriter& writer, const DsFile& dsf, const Size pktCount)
+{
+    BinDsFileRecord record;
+    const auto& path = dsf.path().string();
+
+    record.pktCount = pktCount;
+    record.pathLen = static_cast<std::uint32_t>(path.size());
+    writeData(writer, record);
+    writer.write(path);
+}
+
+void writeBinPktRecord(BufWriter& writer, const PktIndexEntry& indexEntry)
+{
+    BinPktRecord record;
+    std::uint64_t flags = 0;
+
+    record.index = indexEntry.natIndexInDsFile();
+    record.offsetBytes = indexEntry.offsetInDsFileBytes();
+    record.totalLenBytes = indexEntry.effectiveTotalLen().bytes();
+    record.contentLenBits = indexEntry.effectiveContentLen().bits();
+    record.beginTsCycles = 0;
+    record.beginTsNs = 0;
+
+    if (indexEntry.beginTs()) {
+        record.beginTsCycles = indexEntry.beginTs()->cycles();
+        record.beginTsNs = indexEntry.beginTs()->nsFromOrigin();
+        flags |= BIN_PKT_FLAG_HAS_BEGIN_TS;
+    }
+
+    record.endTsCycles = 0;
+    record.endTsNs = 0;
+
+    if (indexEntry.endTs()) {
+        record.endTsCycles = indexEntry.endTs()->cycles();
+        record.endTsNs = indexEntry.endTs()->nsFromOrigin();
+        flags |= BIN_PKT_FLAG_HAS_END_TS;
+    }
+
+    record.dstId = 0;
+
+    if (indexEntry.dst()) {
+        record.dstId = indexEntry.dst()->id();
+        flags |= BIN_PKT_FLAG_HAS_DST_ID;
+    }
+
+    record.dsId = 0;
+
+    if (indexEntry.dsId()) {
+        record.dsId = *indexEntry.dsId();
+        flags |= BIN_PKT_FLAG_HAS_DS_ID;
+    }
+
+    record.seqNum = 0;
+
+    if (indexEntry.seqNum()) {
+        record.seqNum = *indexEntry.seqNum();
+        flags |= BIN_PKT_FLAG_HAS_SEQ_NUM;
+    }
+
+    record.discErCounterSnap = 0;
+
+    if (indexEntry.discErCounterSnap()) {
+        record.discErCounterSnap = *indexEntry.discErCounterSnap();
+        flags |= BIN_PKT_FLAG_HAS_DISC_ER_COUNTER_SNAP;
+    }
+
+    if (!indexEntry.isInvalid()) {
+        flags |= BIN_PKT_FLAG_IS_VALID;
+    }
+
+    record.flags = flags;
+    writeData(writer, record);
+}
+
+void appendHeader(std::string& out, const bool withPath)
 {
-    assert(fmt == ListPktsCfg::Fmt::MACHINE);
-
-    std::cout << "Index,Offset (bytes),Total length (bytes)," <<
-                 "Content length (bits),Beginning time (cycles)," <<
-                 "Beginning timestamp (ns),End timestamp (cycles),End timestamp (ns)," <<
-                 "Duration (cycles),Duration (ns),Data stream type ID," <<
-                 "Data stream ID,Sequence number," <<
-                 "Discarded event record counter snapshot,Is valid?" << std::endl;
+    if (withPath) {
+        out += "Data stream file,";
+    }
+
+    out += "Index,Offset (bytes),Total length (bytes),"
+           "Content length (bits),Beginning time (cycles),"
+           "Beginning timestamp (ns),End timestamp (cycles),End timestamp (ns),"
+           "Duration (cycles),Duration (ns),Data stream type ID,"
+           "Data stream ID,Sequence number,"
+           "Discarded event record counter snapshot,Is valid?\n";
 }
 
-void printRow(const PktIndexEntry& indexEntry, const ListPktsCfg::Fmt fmt)
+template <typename ValT>
+void appendOptUInt(std::string& out, const boost::optional<ValT>& val)
 {
-    assert(fmt == ListPktsCfg::Fmt::MACHINE);
+    if (val) {
+        utils::appendUInt(out, *val);
+    }
 
-    std::cout << indexEntry.natIndexInDsFile() << "," <<
-                 indexEntry.offsetInDsFileBytes() << "," <<
-                 indexEntry.effectiveTotalLen().bytes() << "," <<
-                 indexEntry.effectiveContentLen().bits() << ",";
+    out += ',';
+}
+
+void appendCsvRow(std::string& out, const std::string *pathField,
+                  const PktIndexEntry& indexEntry)
+{
+    if (pathField) {
+        out += *pathField;
+        out += ',';
+    }
+
+    utils::appendUInt(out, indexEntry.natIndexInDsFile());
+    out += ',';
+    utils::appendUInt(out, indexEntry.offsetInDsFileBytes());
+    out += ',';
+    utils::appendUInt(out, indexEntry.effectiveTotalLen().bytes());
+    out += ',';
+    utils::appendUInt(out, indexEntry.effectiveContentLen().bits());
+    out += ',';
 
     if (indexEntry.beginTs()) {
-        std::cout << indexEntry.beginTs()->cycles() << "," <<
-                     indexEntry.beginTs()->nsFromOrigin() << ",";
+        utils::appendUInt(out, indexEntry.beginTs()->cycles());
+        out += ',';
+        utils::appendInt(out, indexEntry.beginTs()->nsFromOrigin());
+        out += ',';
     } else {
-        std::cout << ",,";
+        out += ",,";
     }
 
     if (indexEntry.endTs()) {
-        std::cout << indexEntry.endTs()->cycles() << "," <<
-                     indexEntry.endTs()->nsFromOrigin() << ",";
+        utils::appendUInt(out, indexEntry.endTs()->cycles());
+        out += ',';
+        utils::appendInt(out, indexEntry.endTs()->nsFromOrigin());
+        out += ',';
     } else {
-        std::cout << ",,";
+        out += ",,";
     }
 
     if (indexEntry.beginTs() && indexEntry.endTs() &&
@@ -59,59 +246,174 @@ void printRow(const PktIndexEntry& indexEntry, const ListPktsCfg::Fmt fmt)
         const auto durCycles = indexEntry.endTs()->cycles() -
                                indexEntry.beginTs()->cycles();
 
-        std::cout << durCycles << "," << duration.ns() << ",";
+        utils::appendUInt(out, durCycles);
+        out += ',';
+        utils::appendUInt(out, duration.ns());
+        out += ',';
     } else {
-        std::cout << ",,";
+        out += ",,";
     }
 
     if (indexEntry.dst()) {
-        std::cout << indexEntry.dst()->id() << ",";
-    } else {
-        std::cout << ",";
+        utils::appendUInt(out, indexEntry.dst()->id());
     }
 
-    if (indexEntry.dsId()) {
-        std::cout << *indexEntry.dsId() << ",";
+    out += ',';
+    appendOptUInt(out, indexEntry.dsId());
+    appendOptUInt(out, indexEntry.seqNum());
+    appendOptUInt(out, indexEntry.discErCounterSnap());
+    out += indexEntry.isInvalid() ? "no\n" : "yes\n";
+}
+
+void appendJsonRow(std::string& out, const std::string& pathField,
+                   const PktIndexEntry& indexEntry)
+{
+    out += "{\"path\":";
+    out += pathField;
+    out += ",\"index\":";
+    utils::appendUInt(out, indexEntry.natIndexInDsFile());
+    out += ",\"offset-bytes\":";
+    utils::appendUInt(out, indexEntry.offsetInDsFileBytes());
+    out += ",\"total-len-bytes\":";
+    utils::appendUInt(out, indexEntry.effectiveTotalLen().bytes());
+    out += ",\"content-len-bits\":";
+    utils::appendUInt(out, indexEntry.effectiveContentLen().bits());
+    utils::appendJsonTs(out, "begin-ts", indexEntry.beginTs());
+    utils::appendJsonTs(out, "end-ts", indexEntry.endTs());
+    out += ",\"dst-id\":";
+
+    if (indexEntry.dst()) {
+        utils::appendUInt(out, indexEntry.dst()->id());
     } else {
-        std::cout << ",";
+        out += "null";
     }
 
-    if (indexEntry.seqNum()) {
-        std::cout << *indexEntry.seqNum() << ",";
+    utils::appendJsonOptUInt(out, "ds-id", indexEntry.dsId());
+    utils::appendJsonOptUInt(out, "seq-num", indexEntry.seqNum());
+    utils::appendJsonOptUInt(out, "disc-er-counter-snap", indexEntry.discErCounterSnap());
+    out += ",\"is-valid\":";
+    out += indexEntry.isInvalid() ? "false}\n" : "true}\n";
+}
+
+/*
+ * Writes the rows of all the packets of `dsf`, or only of the ones of
+ * which the corresponding element of `matches` is 1 if it's set.
+ *
+ * `rows` is a reusable buffer: this function formats many rows at
+ * once before writing them.
+ */
+void writeTextRows(BufWriter& writer, const DsFile& dsf, const ListPktsCfg::Fmt fmt,
+                   const bool withPath, const std::vector<std::uint8_t> * const matches,
+                   std::string& rows)
+{
+    std::string pathField;
+
+    if (fmt == ListPktsCfg::Fmt::MACHINE) {
+        utils::appendCsvField(pathField, dsf.path().string());
     } else {
-        std::cout << ",";
+        utils::appendJsonStr(pathField, dsf.path().string());
     }
 
-    if (indexEntry.discErCounterSnap()) {
-        std::cout << *indexEntry.discErCounterSnap() << ",";
-    } else {
-        std::cout << ",";
+    for (const auto& indexEntry : dsf.pktIndexEntries()) {
+        if (matches && !(*matches)[indexEntry.indexInDsFile()]) {
+            continue;
+        }
+
+        if (fmt == ListPktsCfg::Fmt::MACHINE) {
+            appendCsvRow(rows, withPath ? &pathField : nullptr, indexEntry);
+        } else {
+            appendJsonRow(rows, pathField, indexEntry);
+        }
+
+        if (rows.size() >= 64 * 1024) {
+            writer.write(rows);
+            rows.clear();
+        }
     }
 
-    std::cout << (indexEntry.isInvalid() ? "no" : "yes") << std::endl;
+    writer.write(rows);
+    rows.clear();
 }
 
 } // namespace
 
 void listPktsCmd(const ListPktsCfg& cfg)
 {
-    Trace trace {{cfg.path()}};
-    auto& dsf = *trace.dsFiles().front();
+    DsFileSet dsFileSet {cfg.paths()};
+
+    dsFileSet.buildIndexes();
 
-    dsf.buildIndex();
+    const auto& dsFiles = dsFileSet.dsFiles();
+    const auto hasPkts = std::any_of(dsFiles.begin(), dsFiles.end(), [](const auto dsf) {
+        return dsf->pktCount() > 0;
+    });
 
-    if (dsf.pktCount() == 0) {
+    if (!hasPkts && cfg.format() != ListPktsCfg::Fmt::BINARY) {
         // nothing to print
         return;
     }
 
+    std::unique_ptr<PktFilter> filter;
+
+    // packets of each data stream file satisfying the filter
+    std::vector<std::vector<std::uint8_t>> matches;
+
+    if (cfg.whereExpr()) {
+        filter = std::make_unique<PktFilter>(*cfg.whereExpr());
+        matches.resize(dsFiles.size());
+
+        for (Index i = 0; i < dsFiles.size(); ++i) {
+            filter->filter(dsFiles[i]->pktIndexEntries(), matches[i]);
+        }
+    }
+
+    const auto dsFileMatches = [&matches](const Index dsFileIndex) {
+        return matches.empty() ? nullptr : &matches[dsFileIndex];
+    };
+
+    BufWriter writer {STDOUT_FILENO, "standard output"};
+
+    if (cfg.format() == ListPktsCfg::Fmt::BINARY) {
+        writeBinHeader(writer, dsFiles);
+
+        for (Index i = 0; i < dsFiles.size(); ++i) {
+            const auto& dsf = *dsFiles[i];
+            const auto dsfMatches = dsFileMatches(i);
+            auto pktCount = dsf.pktCount();
+
+            if (dsfMatches) {
+                pktCount = std::count(dsfMatches->begin(), dsfMatches->end(), 1);
+            }
+
+            writeBinDsFileRecord(writer, dsf, pktCount);
+
+            for (const auto& indexEntry : dsf.pktIndexEntries()) {
+                if (dsfMatches && !(*dsfMatches)[indexEntry.indexInDsFile()]) {
+                    continue;
+                }
+
+                writeBinPktRecord(writer, indexEntry);
+            }
+        }
+
+        writer.flush();
+        return;
+    }
+
+    // keep the original columns when listing a single data stream file
+    const auto withPath = dsFiles.size() > 1;
+    std::string rows;
+
     if (cfg.withHeader()) {
-        printHeader(cfg.format());
+        appendHeader(rows, withPath);
     }
 
-    for (const auto& indexEntry : dsf.pktIndexEntries()) {
-        printRow(indexEntry, cfg.format());
+    for (Index i = 0; i < dsFiles.size(); ++i) {
+        writeTextRows(writer, *dsFiles[i], cfg.format(), withPath, dsFileMatches(i), rows);
     }
+
+    writer.write(rows);
+    writer.flush();
 }
 
 } // namespace jacques
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cerrno>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <boost/endian/buffers.hpp>
+
+#include "lttng-index.hpp"
+#include "io-error.hpp"
+
+namespace jacques {
+
+namespace bfs = boost::filesystem;
+namespace bendian = boost::endian;
+
+namespace {
+
+struct LTTngIndexHeader {
+    bendian::big_uint32_buf_t magic;
+    bendian::big_uint32_buf_t indexMajor;
+    bendian::big_uint32_buf_t indexMinor;
+    bendian::big_uint32_buf_t indexEntrySizeBytes;
+};
+
+struct LTTngIndexEntryBase {
+    bendian::big_uint64_buf_t offsetBytes;
+    bendian::big_uint64_buf_t totalLenBits;
+    bendian::big_uint64_buf_t contentLenBits;
+    bendian::big_uint64_buf_t beginTs;
+    bendian::big_uint64_buf_t endTs;
+    bendian::big_uint64_buf_t discErCounterSnap;
+    bendian::big_uint64_buf_t dstId;
+};
+
+struct LTTngIndexEntry11Addon {
+    bendian::big_uint64_buf_t dsId;
+    bendian::big_uint64_buf_t seqNum;
+};
+
+static_assert(sizeof(LTTngIndexHeader) == 4 * 4,
+              "LTTng index header structure has the expected size.");
+static_assert(sizeof(LTTngIndexEntryBase) == 7 * 8,
+              "LTTng index entry base structure has the expected size.");
+static_assert(sizeof(LTTngIndexEntry11Addon) == 2 * 8,
+              "LTTng index entry v1.1 addon structure has the expected size.");
+
+bool entryHas11Addon(const std::vector<LttngIndexPkt>& pkts) noexcept
+{
+    return !pkts.empty() && pkts.front().pktIndexEntry->dsId() &&
+           pkts.front().pktIndexEntry->seqNum();
+}
+
+template <typename DataT>
+void appendData(std::string& buf, const DataT& data)
+{
+    buf.append(reinterpret_cast<const char *>(&data), sizeof(data));
+}
+
+void appendLttngIndexHeader(std::string& buf, const std::vector<LttngIndexPkt>& pkts)
+{
+    LTTngIndexHeader header;
+
+    header.magic = 0xc1f1dcc1U;
+    header.indexMajor = 1;
+    header.indexMinor = 0;
+    header.indexEntrySizeBytes = sizeof(LTTngIndexEntryBase);
+
+    if (entryHas11Addon(pkts)) {
+        header.indexMinor = 1;
+        header.indexEntrySizeBytes = header.indexEntrySizeBytes.value() +
+                                     sizeof(LTTngIndexEntry11Addon);
+    }
+
+    appendData(buf, header);
+}
+
+void appendLttngIndexEntry(std::string& buf, const bool has11Addon, const LttngIndexPkt& pkt)
+{
+    const auto& indexEntry = *pkt.pktIndexEntry;
+    LTTngIndexEntryBase entryBase;
+
+    entryBase.offsetBytes = pkt.offsetInDsFileBytes;
+    entryBase.totalLenBits = indexEntry.effectiveTotalLen().bits();
+    entryBase.contentLenBits = indexEntry.effectiveContentLen().bits();
+    entryBase.beginTs = 0;
+
+    if (indexEntry.beginTs()) {
+        entryBase.beginTs = indexEntry.beginTs()->cycles();
+    }
+
+    entryBase.endTs = 0;
+
+    if (indexEntry.endTs()) {
+        entryBase.endTs = indexEntry.endTs()->cycles();
+    }
+
+    entryBase.discErCounterSnap = 0;
+
+    if (indexEntry.discErCounterSnap()) {
+        entryBase.discErCounterSnap = *indexEntry.discErCounterSnap();
+    }
+
+    entryBase.dstId = 0;
+
+    if (indexEntry.dst()) {
+        entryBase.dstId = indexEntry.dst()->id();
+    }
+
+    appendData(buf, entryBase);
+
+    if (has11Addon) {
+        LTTngIndexEntry11Addon addon;
+
+        addon.dsId = *indexEntry.dsId();
+        addon.seqNum = *indexEntry.seqNum();
+        appendData(buf, addon);
+    }
+}
+
+} // namespace
+
+bfs::path lttngIndexFilePath(const bfs::path& dsFilePath)
+{
+    return dsFilePath.parent_path() / "index" / (dsFilePath.filename().string() + ".idx");
+}
+
+namespace {
+
+/*
+ * Writes `buf` to a temporary file, then renames it to `path`, so that
+ * `path` is either the previous file or the complete new one.
+ */
+void writeFileAtomically(const bfs::path& path, const std::string& buf)
+{
+    const auto tmpPath = bfs::path {path.string() + ".tmp"};
+    const auto fd = open(tmpPath.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        throwIOError(tmpPath, "create");
+    }
+
+    auto data = buf.data();
+    auto remLen = buf.size();
+
+    while (remLen > 0) {
+        const auto ret = write(fd, data, remLen);
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const auto writeErrno = errno;
+
+            static_cast<void>(close(fd));
+            static_cast<void>(unlink(tmpPath.string().c_str()));
+            errno = writeErrno;
+            throwIOError(tmpPath, "write");
+        }
+
+        data += ret;
+        remLen -= static_cast<std::size_t>(ret);
+    }
+
+    if (close(fd) != 0) {
+        const auto closeErrno = errno;
+
+        static_cast<void>(unlink(tmpPath.string().c_str()));
+        errno = closeErrno;
+        throwIOError(tmpPath, "close");
+    }
+
+    if (rename(tmpPath.string().c_str(), path.string().c_str()) != 0) {
+        const auto renameErrno = errno;
+
+        static_cast<void>(unlink(tmpPath.string().c_str()));
+        errno = renameErrno;
+        throwIOError(path, "rename temporary file to");
+    }
+}
+
+} // namespace
+
+void writeLttngIndexFile(const bfs::path& dsFilePath, const std::vector<LttngIndexPkt>& pkts)
+{
+    const auto idxFilePath = lttngIndexFilePath(dsFilePath);
+    const auto has11Addon = entryHas11Addon(pkts);
+    auto entrySize = sizeof(LTTngIndexEntryBase);
+
+    if (has11Addon) {
+        entrySize += sizeof(LTTngIndexEntry11Addon);
+    }
+
+    // build the whole index in memory
+    std::string buf;
+
+    buf.reserve(sizeof(LTTngIndexHeader) + pkts.size() * entrySize);
+    appendLttngIndexHeader(buf, pkts);
+
+    for (const auto& pkt : pkts) {
+        appendLttngIndexEntry(buf, has11Addon, pkt);
+    }
+
+    bfs::create_directories(idxFilePath.parent_path());
+    writeFileAtomically(idxFilePath, buf);
+}
+
+bool lttngIndexFileIsUpToDate(const bfs::path& dsFilePath)
+{
+    const auto idxFilePath = lttngIndexFilePath(dsFilePath);
+    boost::system::error_code ec;
+
+    if (!bfs::is_regular_file(idxFilePath, ec)) {
+        return false;
+    }
+
+    const auto idxFileTime = bfs::last_write_time(idxFilePath, ec);
+
+    if (ec || idxFileTime < bfs::last_write_time(dsFilePath)) {
+        // older than the data stream file
+        return false;
+    }
+
+    const auto idxFileSize = bfs::file_size(idxFilePath, ec);
+
+    if (ec || idxFileSize < sizeof(LTTngIndexHeader)) {
+        return false;
+    }
+
+    std::ifstream idxStream {idxFilePath.c_str(), std::ios::binary};
+    LTTngIndexHeader header;
+
+    if (!idxStream.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        return false;
+    }
+
+    const auto entrySize = static_cast<Size>(header.indexEntrySizeBytes.value());
+
+    if (header.magic.value() != 0xc1f1dcc1U || header.indexMajor.value() != 1 ||
+            entrySize < sizeof(LTTngIndexEntryBase) ||
+            (idxFileSize - sizeof(header)) % entrySize != 0) {
+        return false;
+    }
+
+    const auto entryCount = (idxFileSize - sizeof(header)) / entrySize;
+    const auto dsFileSize = bfs::file_size(dsFilePath);
+
+    if (entryCount == 0) {
+        return dsFileSize == 0;
+    }
+
+    // the last packet must end exactly at the end of the data stream file
+    LTTngIndexEntryBase lastEntry;
+
+    idxStream.seekg(sizeof(header) + (entryCount - 1) * entrySize);
+
+    if (!idxStream.read(reinterpret_cast<char *>(&lastEntry), sizeof(lastEntry))) {
+        return false;
+    }
+
+    return lastEntry.offsetBytes.value() + lastEntry.totalLenBits.value() / 8 == dsFileSize;
+}
+
+} // namespace jacques
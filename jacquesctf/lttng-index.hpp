@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_LTTNG_INDEX_HPP
+#define _JACQUES_LTTNG_INDEX_HPP
+
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "aliases.hpp"
+#include "data/pkt-index-entry.hpp"
+
+namespace jacques {
+
+/*
+ * Packet of an LTTng index file.
+ *
+ * `offsetInDsFileBytes` may differ from the offset of
+ * `*pktIndexEntry` when the packet is copied to another data stream
+ * file.
+ */
+struct LttngIndexPkt
+{
+    const PktIndexEntry *pktIndexEntry;
+    Index offsetInDsFileBytes;
+};
+
+/*
+ * Returns the path of the LTTng index file of the data stream file
+ * `dsFilePath`, that is, `index/NAME.idx` within the directory of the
+ * data stream file.
+ */
+boost::filesystem::path lttngIndexFilePath(const boost::filesystem::path& dsFilePath);
+
+/*
+ * Writes the LTTng index file of the data stream file `dsFilePath`
+ * having the packets `pkts`, creating its `index` directory if needed.
+ *
+ * This function builds the whole index in memory, then writes it to a
+ * temporary file which it renames, so that a reader never sees a
+ * partial index file.
+ */
+void writeLttngIndexFile(const boost::filesystem::path& dsFilePath,
+                         const std::vector<LttngIndexPkt>& pkts);
+
+/*
+ * Returns whether or not the LTTng index file of the data stream file
+ * `dsFilePath` exists, is not older than the data stream file, and is
+ * consistent with it (valid header, whole entries, and last packet
+ * ending at the end of the data stream file).
+ *
+ * This function doesn't decode the data stream file.
+ */
+bool lttngIndexFileIsUpToDate(const boost::filesystem::path& dsFilePath);
+
+} // namespace jacques
+
+#endif // _JACQUES_LTTNG_INDEX_HPP
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+#include <boost/optional.hpp>
+#include <yactfr/yactfr.hpp>
+
+#include "cfg.hpp"
+#include "merge-pkts-cmd.hpp"
+#include "cmd-error.hpp"
+#include "ds-file-set.hpp"
+#include "file-range-copier.hpp"
+#include "data/ds-file.hpp"
+
+namespace jacques {
+namespace {
+
+/*
+ * Packet of a source data stream file, with its ordering key.
+ *
+ * Kept small: there's one per packet.
+ */
+struct PktRef
+{
+    unsigned long long key;
+    std::uint32_t dsFileIndex;
+    Index pktIndex;
+};
+
+bool pktRefLt(const PktRef& a, const PktRef& b) noexcept
+{
+    if (a.key != b.key) {
+        return a.key < b.key;
+    }
+
+    // keep the order of the source data stream files and packets
+    if (a.dsFileIndex != b.dsFileIndex) {
+        return a.dsFileIndex < b.dsFileIndex;
+    }
+
+    return a.pktIndex < b.pktIndex;
+}
+
+/*
+ * Throws if the packets of `dsFiles` are not all valid packets of the
+ * same data stream.
+ */
+void checkSameDs(const std::vector<const DsFile *>& dsFiles)
+{
+    const auto dstId = [](const PktIndexEntry& entry) {
+        boost::optional<yactfr::TypeId> id;
+
+        if (entry.dst()) {
+            id = entry.dst()->id();
+        }
+
+        return id;
+    };
+
+    const PktIndexEntry *firstEntry = nullptr;
+
+    for (const auto dsf : dsFiles) {
+        for (const auto& entry : dsf->pktIndexEntries()) {
+            if (entry.isInvalid()) {
+                std::ostringstream ss;
+
+                ss << "Packet " << entry.natIndexInDsFile() << " of data stream file `" <<
+                      dsf->path().string() << "` is invalid.";
+                throw CmdError {ss.str()};
+            }
+
+            if (!firstEntry) {
+                firstEntry = &entry;
+                continue;
+            }
+
+            if (dstId(entry) != dstId(*firstEntry) || entry.dsId() != firstEntry->dsId()) {
+                std::ostringstream ss;
+
+                ss << "Packet " << entry.natIndexInDsFile() << " of data stream file `" <<
+                      dsf->path().string() << "` is not part of the same data stream as the " <<
+                      "first packet (different data stream type or data stream ID).";
+                throw CmdError {ss.str()};
+            }
+        }
+    }
+}
+
+bool allPktsHave(const std::vector<const DsFile *>& dsFiles,
+                 bool (*pred)(const PktIndexEntry&))
+{
+    for (const auto dsf : dsFiles) {
+        const auto& entries = dsf->pktIndexEntries();
+
+        if (!std::all_of(entries.begin(), entries.end(), pred)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool hasSeqNum(const PktIndexEntry& entry)
+{
+    return static_cast<bool>(entry.seqNum());
+}
+
+bool hasBeginTs(const PktIndexEntry& entry)
+{
+    return static_cast<bool>(entry.beginTs());
+}
+
+/*
+ * Returns the ordering key of `entry`: its sequence number if
+ * `bySeqNum` is true, or its beginning timestamp otherwise.
+ */
+unsigned long long pktKey(const PktIndexEntry& entry, const bool bySeqNum) noexcept
+{
+    if (bySeqNum) {
+        return *entry.seqNum();
+    }
+
+    // flip the sign bit to keep the order of negative values
+    return static_cast<unsigned long long>(entry.beginTs()->nsFromOrigin()) ^ (1ULL << 63);
+}
+
+/*
+ * Returns the references of all the packets of `dsFiles`, with their
+ * key (see pktKey()).
+ */
+std::vector<PktRef> pktRefs(const std::vector<const DsFile *>& dsFiles, const bool bySeqNum)
+{
+    std::vector<PktRef> refs;
+    Size pktCount = 0;
+
+    for (const auto dsf : dsFiles) {
+        pktCount += dsf->pktCount();
+    }
+
+    refs.reserve(pktCount);
+
+    for (std::uint32_t dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+        const auto& entries = dsFiles[dsFileIndex]->pktIndexEntries();
+
+        for (Index pktIndex = 0; pktIndex < entries.size(); ++pktIndex) {
+            refs.push_back({pktKey(entries[pktIndex], bySeqNum), dsFileIndex, pktIndex});
+        }
+    }
+
+    return refs;
+}
+
+/*
+ * Removes the packets of `refs` (sorted by sequence number) of which
+ * the sequence number is the same as the previous one, or throws if
+ * `drop` is false.
+ */
+void handleDupSeqNums(std::vector<PktRef>& refs, const std::vector<const DsFile *>& dsFiles,
+                      const bool drop)
+{
+    const auto sameSeqNum = [](const PktRef& a, const PktRef& b) {
+        return a.key == b.key;
+    };
+
+    if (drop) {
+        refs.erase(std::unique(refs.begin(), refs.end(), sameSeqNum), refs.end());
+        return;
+    }
+
+    const auto it = std::adjacent_find(refs.begin(), refs.end(), sameSeqNum);
+
+    if (it == refs.end()) {
+        return;
+    }
+
+    const auto pktStr = [&dsFiles](const PktRef& ref) {
+        std::ostringstream ss;
+
+        ss << "packet " << ref.pktIndex + 1 << " of `" <<
+              dsFiles[ref.dsFileIndex]->path().string() << "`";
+        return ss.str();
+    };
+
+    std::ostringstream ss;
+
+    ss << "Duplicate sequence number " << it->key << ": " << pktStr(*it) << " and " <<
+          pktStr(*(it + 1)) << " (use --drop-duplicates to only keep the first one).";
+    throw CmdError {ss.str()};
+}
+
+} // namespace
+
+void mergePktsCmd(const MergePktsCfg& cfg)
+{
+    DsFileSet dsFileSet {cfg.srcPaths()};
+
+    dsFileSet.buildIndexes();
+
+    /*
+     * DsFileSet groups the data stream files by trace directory
+     * (otherwise keeping the given order): use its order for the
+     * source indexes.
+     */
+    const auto dsFiles = dsFileSet.constDsFiles();
+
+    checkSameDs(dsFiles);
+
+    const auto haveSeqNums = allPktsHave(dsFiles, hasSeqNum);
+    auto bySeqNum = cfg.order() == MergePktsCfg::Order::SEQ_NUM;
+
+    if (cfg.order() == MergePktsCfg::Order::AUTO) {
+        bySeqNum = haveSeqNums;
+    }
+
+    if (bySeqNum && !haveSeqNums) {
+        throw CmdError {"Cannot order packets by sequence number: some packets have none."};
+    }
+
+    if (!bySeqNum && !allPktsHave(dsFiles, hasBeginTs)) {
+        throw CmdError {
+            "Cannot order packets by beginning timestamp: some packets have none."
+        };
+    }
+
+    std::vector<PktRef> refs;
+
+    if (haveSeqNums) {
+        // detect duplicates: sort by sequence number first
+        refs = pktRefs(dsFiles, true);
+        std::sort(refs.begin(), refs.end(), pktRefLt);
+        handleDupSeqNums(refs, dsFiles, cfg.dropDups());
+
+        if (!bySeqNum) {
+            // replace the keys with beginning timestamps
+            for (auto& ref : refs) {
+                ref.key = pktKey(dsFiles[ref.dsFileIndex]->pktIndexEntries()[ref.pktIndex],
+                                 false);
+            }
+
+            std::sort(refs.begin(), refs.end(), pktRefLt);
+        }
+    } else {
+        refs = pktRefs(dsFiles, false);
+        std::sort(refs.begin(), refs.end(), pktRefLt);
+    }
+
+    // coalesce the ranges of consecutive packets of the same source
+    std::vector<SrcFileRange> ranges;
+
+    for (const auto& ref : refs) {
+        const auto& entry = dsFiles[ref.dsFileIndex]->pktIndexEntries()[ref.pktIndex];
+
+        appendSrcFileRange(ranges, {
+            ref.dsFileIndex, {entry.offsetInDsFileBytes(), entry.effectiveTotalLen().bytes()}
+        });
+    }
+
+    std::vector<boost::filesystem::path> srcPaths;
+
+    for (const auto dsf : dsFiles) {
+        srcPaths.push_back(dsf->path());
+    }
+
+    FileRangeCopier copier {cfg.dstPath()};
+
+    copier.copy(srcPaths, ranges);
+    copier.close();
+}
+
+} // namespace jacques
@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_MERGE_PKTS_CMD_HPP
+#define _JACQUES_MERGE_PKTS_CMD_HPP
+
+#include "cfg.hpp"
+
+namespace jacques {
+
+void mergePktsCmd(const MergePktsCfg& cfg);
+
+} // namespace jacques
+
+#endif // _JACQUES_MERGE_PKTS_CMD_HPP
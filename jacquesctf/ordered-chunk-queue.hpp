@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_ORDERED_CHUNK_QUEUE_HPP
+#define _JACQUES_ORDERED_CHUNK_QUEUE_HPP
+
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <vector>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Bounded queue of chunks of type `ChunkT`, each one having a
+ * sequential index, which a single consumer takes in index order
+ * whatever the order in which producers put them.
+ *
+ * put() blocks while the chunk is too far ahead of the next chunk to
+ * take, which bounds the memory usage when the consumer is slower than
+ * the producers, or when a single chunk is slow to produce.
+ */
+template <typename ChunkT>
+class OrderedChunkQueue final :
+    boost::noncopyable
+{
+public:
+    explicit OrderedChunkQueue(const Size capacity) :
+        _chunks(capacity)
+    {
+    }
+
+    /*
+     * Puts the chunk `chunk` having the index `index`.
+     *
+     * Returns `false` if the queue is cancelled.
+     */
+    bool put(const Index index, ChunkT&& chunk)
+    {
+        std::unique_lock<std::mutex> lock {_mutex};
+
+        _putCond.wait(lock, [this, index] {
+            return _isCancelled || index < _nextIndex + _chunks.size();
+        });
+
+        if (_isCancelled) {
+            return false;
+        }
+
+        auto& slot = _chunks[index % _chunks.size()];
+
+        slot.chunk = std::move(chunk);
+        slot.isSet = true;
+
+        if (index == _nextIndex) {
+            _takeCond.notify_one();
+        }
+
+        return true;
+    }
+
+    /*
+     * Takes the next chunk into `chunk`.
+     *
+     * Returns `false` if the queue is cancelled.
+     */
+    bool take(ChunkT& chunk)
+    {
+        std::unique_lock<std::mutex> lock {_mutex};
+        auto& slot = _chunks[_nextIndex % _chunks.size()];
+
+        _takeCond.wait(lock, [this, &slot] {
+            return _isCancelled || slot.isSet;
+        });
+
+        if (_isCancelled) {
+            return false;
+        }
+
+        // swap to reuse the resources of `chunk`
+        std::swap(chunk, slot.chunk);
+        slot.isSet = false;
+        ++_nextIndex;
+        _putCond.notify_all();
+        return true;
+    }
+
+    void cancel()
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+
+        _isCancelled = true;
+        _putCond.notify_all();
+        _takeCond.notify_all();
+    }
+
+private:
+    struct _Slot
+    {
+        ChunkT chunk;
+        bool isSet = false;
+    };
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _putCond;
+    std::condition_variable _takeCond;
+    std::vector<_Slot> _chunks;
+    Index _nextIndex = 0;
+    bool _isCancelled = false;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_ORDERED_CHUNK_QUEUE_HPP
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include "payload-json-formatter.hpp"
+#include "utils.hpp"
+
+namespace jacques {
+
+void PayloadJsonFormatter::_beginVal(const std::string * const name)
+{
+    ++_valCount;
+
+    if (_containers.empty()) {
+        // root structure
+        return;
+    }
+
+    auto& container = _containers.back();
+
+    if (!container.isEmpty) {
+        _json += ',';
+    }
+
+    container.isEmpty = false;
+
+    const auto effName = name ? name : _pendingName;
+
+    _pendingName = nullptr;
+
+    if (container.isStruct) {
+        if (effName) {
+            utils::appendJsonStr(_json, *effName);
+        } else {
+            _json += "\"\"";
+        }
+
+        _json += ':';
+    }
+}
+
+void PayloadJsonFormatter::_beginContainer(const yactfr::Element& elem, const bool isStruct)
+{
+    this->_beginVal(elem);
+    _json += isStruct ? '{' : '[';
+    _containers.push_back({isStruct, true});
+}
+
+void PayloadJsonFormatter::_endContainer()
+{
+    assert(!_containers.empty());
+    _json += _containers.back().isStruct ? '}' : ']';
+    _containers.pop_back();
+}
+
+void PayloadJsonFormatter::_beginStr(const yactfr::Element& elem)
+{
+    this->_beginVal(elem);
+    _json += '"';
+    _inStr = true;
+    _strEnded = false;
+}
+
+void PayloadJsonFormatter::_beginVarOrOpt(const yactfr::Element& elem)
+{
+    if (const auto name = _memberName(elem)) {
+        _pendingName = name;
+    }
+}
+
+void PayloadJsonFormatter::_endOpt()
+{
+    assert(!_optValCounts.empty());
+
+    if (_optValCounts.back() == _valCount) {
+        // disabled
+        this->_beginVal(nullptr);
+        _json += "null";
+    }
+
+    _optValCounts.pop_back();
+}
+
+void PayloadJsonFormatter::feed(const yactfr::Element& elem)
+{
+    using ElemKind = yactfr::Element::Kind;
+
+    if (elem.kind() == ElemKind::SCOPE_BEGINNING) {
+        _inPayload = elem.asScopeBeginningElement().scope() ==
+                     yactfr::Scope::EVENT_RECORD_PAYLOAD;
+        return;
+    }
+
+    if (!_inPayload) {
+        return;
+    }
+
+    switch (elem.kind()) {
+    case ElemKind::SCOPE_END:
+        _inPayload = false;
+        break;
+
+    case ElemKind::FIXED_LENGTH_BIT_ARRAY:
+        this->_beginVal(elem);
+        utils::appendUInt(_json,
+                          elem.asFixedLengthBitArrayElement().unsignedIntegerValue());
+        break;
+
+    case ElemKind::FIXED_LENGTH_BOOLEAN:
+        this->_beginVal(elem);
+        _json += static_cast<const yactfr::FixedLengthBooleanElement&>(elem).value() ?
+                 "true" : "false";
+        break;
+
+    case ElemKind::FIXED_LENGTH_SIGNED_INTEGER:
+    case ElemKind::FIXED_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::FixedLengthSignedIntegerElement&>(elem);
+
+        this->_beginVal(elem);
+        utils::appendInt(_json, intElem.value());
+        break;
+    }
+
+    case ElemKind::FIXED_LENGTH_UNSIGNED_INTEGER:
+    case ElemKind::FIXED_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::FixedLengthUnsignedIntegerElement&>(elem);
+
+        this->_beginVal(elem);
+        utils::appendUInt(_json, intElem.value());
+        break;
+    }
+
+    case ElemKind::FIXED_LENGTH_FLOATING_POINT_NUMBER:
+    {
+        auto& fltElem = static_cast<const yactfr::FixedLengthFloatingPointNumberElement&>(elem);
+
+        this->_beginVal(elem);
+        utils::appendJsonDouble(_json, fltElem.value());
+        break;
+    }
+
+    case ElemKind::VARIABLE_LENGTH_SIGNED_INTEGER:
+    case ElemKind::VARIABLE_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::VariableLengthSignedIntegerElement&>(elem);
+
+        this->_beginVal(elem);
+        utils::appendInt(_json, intElem.value());
+        break;
+    }
+
+    case ElemKind::VARIABLE_LENGTH_UNSIGNED_INTEGER:
+    case ElemKind::VARIABLE_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& intElem = static_cast<const yactfr::VariableLengthUnsignedIntegerElement&>(elem);
+
+        this->_beginVal(elem);
+        utils::appendUInt(_json, intElem.value());
+        break;
+    }
+
+    case ElemKind::NULL_TERMINATED_STRING_BEGINNING:
+    case ElemKind::STATIC_LENGTH_STRING_BEGINNING:
+    case ElemKind::DYNAMIC_LENGTH_STRING_BEGINNING:
+        this->_beginStr(elem);
+        break;
+
+    case ElemKind::SUBSTRING:
+    {
+        if (!_inStr || _strEnded) {
+            break;
+        }
+
+        auto& substrElem = elem.asSubstringElement();
+        const auto end = substrElem.begin() + substrElem.size();
+        const auto strEnd = std::find(substrElem.begin(), end, '\0');
+
+        utils::appendJsonStrContent(_json, substrElem.begin(), strEnd);
+        _strEnded = strEnd != end;
+        break;
+    }
+
+    case ElemKind::NULL_TERMINATED_STRING_END:
+    case ElemKind::STATIC_LENGTH_STRING_END:
+    case ElemKind::DYNAMIC_LENGTH_STRING_END:
+        _json += '"';
+        _inStr = false;
+        break;
+
+    case ElemKind::STATIC_LENGTH_BLOB_BEGINNING:
+    case ElemKind::DYNAMIC_LENGTH_BLOB_BEGINNING:
+        this->_beginVal(elem);
+        _json += '"';
+        _inBlob = true;
+        break;
+
+    case ElemKind::BLOB_SECTION:
+    {
+        if (!_inBlob) {
+            break;
+        }
+
+        static constexpr const char *hexDigits = "0123456789abcdef";
+        auto& sectionElem = elem.asBlobSectionElement();
+
+        for (auto it = sectionElem.begin(); it != sectionElem.end(); ++it) {
+            _json += hexDigits[*it >> 4];
+            _json += hexDigits[*it & 0xf];
+        }
+
+        break;
+    }
+
+    case ElemKind::STATIC_LENGTH_BLOB_END:
+    case ElemKind::DYNAMIC_LENGTH_BLOB_END:
+        _json += '"';
+        _inBlob = false;
+        break;
+
+    case ElemKind::STRUCTURE_BEGINNING:
+        this->_beginContainer(elem, true);
+        break;
+
+    case ElemKind::STATIC_LENGTH_ARRAY_BEGINNING:
+    case ElemKind::DYNAMIC_LENGTH_ARRAY_BEGINNING:
+        this->_beginContainer(elem, false);
+        break;
+
+    case ElemKind::STRUCTURE_END:
+    case ElemKind::STATIC_LENGTH_ARRAY_END:
+    case ElemKind::DYNAMIC_LENGTH_ARRAY_END:
+        this->_endContainer();
+        break;
+
+    case ElemKind::VARIANT_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING:
+    case ElemKind::VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING:
+        this->_beginVarOrOpt(elem);
+        break;
+
+    case ElemKind::OPTIONAL_WITH_BOOLEAN_SELECTOR_BEGINNING:
+    case ElemKind::OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING:
+    case ElemKind::OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING:
+        this->_beginVarOrOpt(elem);
+        _optValCounts.push_back(_valCount);
+        break;
+
+    case ElemKind::OPTIONAL_WITH_BOOLEAN_SELECTOR_END:
+    case ElemKind::OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_END:
+    case ElemKind::OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_END:
+        this->_endOpt();
+        break;
+
+    default:
+        break;
+    }
+}
+
+} // namespace jacques
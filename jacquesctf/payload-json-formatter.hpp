@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_PAYLOAD_JSON_FORMATTER_HPP
+#define _JACQUES_PAYLOAD_JSON_FORMATTER_HPP
+
+#include <string>
+#include <vector>
+#include <boost/core/noncopyable.hpp>
+#include <yactfr/yactfr.hpp>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * Formats the elements of an event record payload as a JSON object.
+ *
+ * Feed all the elements of an event record, in order, to feed(), then
+ * get the resulting JSON text with json(), and call reset() before the
+ * next event record.
+ *
+ * Structures are JSON objects, arrays are JSON arrays, blobs are
+ * hexadecimal strings, and variants and optional data are transparent
+ * (a disabled optional field is `null`).
+ */
+class PayloadJsonFormatter final :
+    boost::noncopyable
+{
+public:
+    void feed(const yactfr::Element& elem);
+
+    const std::string& json() const noexcept
+    {
+        return _json;
+    }
+
+    void reset()
+    {
+        _json.clear();
+        _inPayload = false;
+        _containers.clear();
+        _pendingName = nullptr;
+        _optValCounts.clear();
+    }
+
+private:
+    struct _Container
+    {
+        bool isStruct;
+        bool isEmpty;
+    };
+
+private:
+    static const std::string *_memberName(const yactfr::Element& elem) noexcept
+    {
+        auto& dataElem = static_cast<const yactfr::DataElement&>(elem);
+        const auto memberType = dataElem.structureMemberType();
+
+        if (!memberType) {
+            return nullptr;
+        }
+
+        return memberType->displayName() ? &*memberType->displayName() : &memberType->name();
+    }
+
+    void _beginVal(const std::string *name);
+
+    void _beginVal(const yactfr::Element& elem)
+    {
+        this->_beginVal(_memberName(elem));
+    }
+
+    void _beginContainer(const yactfr::Element& elem, bool isStruct);
+    void _endContainer();
+    void _beginStr(const yactfr::Element& elem);
+    void _beginVarOrOpt(const yactfr::Element& elem);
+    void _endOpt();
+
+private:
+    std::string _json;
+    bool _inPayload = false;
+    std::vector<_Container> _containers;
+
+    // name of the variant or optional field which contains the next value
+    const std::string *_pendingName = nullptr;
+
+    // value count when beginning each current optional field
+    std::vector<Size> _optValCounts;
+
+    Size _valCount = 0;
+    bool _inStr = false;
+    bool _strEnded = false;
+    bool _inBlob = false;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_PAYLOAD_JSON_FORMATTER_HPP
@@ -0,0 +1,887 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "pkt-filter.hpp"
+
+namespace jacques {
+namespace {
+
+// number of packets of a block
+constexpr Size blockSize = 1024;
+
+/*
+ * Block of consecutive packet index entries.
+ */
+struct Block
+{
+    const std::vector<PktIndexEntry> *entries;
+    Index begin;
+    Size len;
+};
+
+enum class Col {
+    INDEX,
+    OFFSET_BYTES,
+    TOTAL_LEN_BITS,
+    CONTENT_LEN_BITS,
+    BEGIN_TS_CYCLES,
+    BEGIN_TS_NS,
+    END_TS_CYCLES,
+    END_TS_NS,
+    DURATION_CYCLES,
+    DURATION_NS,
+    SEQ_NUM,
+    DS_ID,
+    DST_ID,
+    DISC_ER_COUNTER,
+    IS_INVALID,
+};
+
+struct ColName
+{
+    const char *name;
+    Col col;
+};
+
+constexpr ColName colNames[] = {
+    {"index", Col::INDEX},
+    {"offset_bytes", Col::OFFSET_BYTES},
+    {"total_len_bits", Col::TOTAL_LEN_BITS},
+    {"content_len_bits", Col::CONTENT_LEN_BITS},
+    {"begin_ts_cycles", Col::BEGIN_TS_CYCLES},
+    {"begin_ts_ns", Col::BEGIN_TS_NS},
+    {"end_ts_cycles", Col::END_TS_CYCLES},
+    {"end_ts_ns", Col::END_TS_NS},
+    {"duration_cycles", Col::DURATION_CYCLES},
+    {"duration_ns", Col::DURATION_NS},
+    {"seq_num", Col::SEQ_NUM},
+    {"ds_id", Col::DS_ID},
+    {"dst_id", Col::DST_ID},
+    {"disc_er_counter", Col::DISC_ER_COUNTER},
+    {"is_invalid", Col::IS_INVALID},
+};
+
+enum class BinOp {
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    AND,
+    OR,
+};
+
+enum class UnaryOp {
+    NEG,
+    NOT,
+};
+
+} // namespace
+
+/*
+ * Expression node.
+ *
+ * eval() sets the first `block.len` elements of the value and validity
+ * buffers of the node.
+ */
+class PktFilter::Node :
+    boost::noncopyable
+{
+public:
+    virtual ~Node() = default;
+    virtual void eval(const Block& block) = 0;
+
+    const long long *vals() const noexcept
+    {
+        return _vals.data();
+    }
+
+    const std::uint8_t *valids() const noexcept
+    {
+        return _valids.data();
+    }
+
+protected:
+    explicit Node() :
+        _vals(blockSize),
+        _valids(blockSize)
+    {
+    }
+
+protected:
+    std::vector<long long> _vals;
+    std::vector<std::uint8_t> _valids;
+};
+
+namespace {
+
+class ConstNode final :
+    public PktFilter::Node
+{
+public:
+    explicit ConstNode(const long long val)
+    {
+        std::fill(_vals.begin(), _vals.end(), val);
+        std::fill(_valids.begin(), _valids.end(), 1);
+    }
+
+    void eval(const Block&) override
+    {
+    }
+};
+
+/*
+ * Packet property; if `prev` is true, property of the previous packet
+ * instead.
+ */
+class ColNode final :
+    public PktFilter::Node
+{
+public:
+    explicit ColNode(const Col col, const bool prev) :
+        _col {col},
+        _prev {prev}
+    {
+    }
+
+    void eval(const Block& block) override;
+
+private:
+    /*
+     * Calls `func` with each entry of `block` and the corresponding
+     * value to set; `func` returns whether or not the value exists.
+     */
+    template <typename FuncT>
+    void _fill(const Block& block, FuncT&& func)
+    {
+        for (Index i = 0; i < block.len; ++i) {
+            auto entryIndex = block.begin + i;
+
+            if (_prev) {
+                if (entryIndex == 0) {
+                    _vals[i] = 0;
+                    _valids[i] = 0;
+                    continue;
+                }
+
+                --entryIndex;
+            }
+
+            _valids[i] = func((*block.entries)[entryIndex], _vals[i]);
+        }
+    }
+
+    template <typename ValT>
+    static bool _setOpt(const boost::optional<ValT>& optVal, long long& val) noexcept
+    {
+        if (!optVal) {
+            val = 0;
+            return false;
+        }
+
+        val = static_cast<long long>(*optVal);
+        return true;
+    }
+
+private:
+    const Col _col;
+    const bool _prev;
+};
+
+void ColNode::eval(const Block& block)
+{
+    using Entry = PktIndexEntry;
+
+    // select the property once per block, not once per packet
+    switch (_col) {
+    case Col::INDEX:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = static_cast<long long>(entry.natIndexInDsFile());
+            return true;
+        });
+        break;
+
+    case Col::OFFSET_BYTES:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = static_cast<long long>(entry.offsetInDsFileBytes());
+            return true;
+        });
+        break;
+
+    case Col::TOTAL_LEN_BITS:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = static_cast<long long>(entry.effectiveTotalLen().bits());
+            return true;
+        });
+        break;
+
+    case Col::CONTENT_LEN_BITS:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = static_cast<long long>(entry.effectiveContentLen().bits());
+            return true;
+        });
+        break;
+
+    case Col::BEGIN_TS_CYCLES:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = entry.beginTs() ? static_cast<long long>(entry.beginTs()->cycles()) : 0;
+            return static_cast<bool>(entry.beginTs());
+        });
+        break;
+
+    case Col::BEGIN_TS_NS:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = entry.beginTs() ? entry.beginTs()->nsFromOrigin() : 0;
+            return static_cast<bool>(entry.beginTs());
+        });
+        break;
+
+    case Col::END_TS_CYCLES:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = entry.endTs() ? static_cast<long long>(entry.endTs()->cycles()) : 0;
+            return static_cast<bool>(entry.endTs());
+        });
+        break;
+
+    case Col::END_TS_NS:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = entry.endTs() ? entry.endTs()->nsFromOrigin() : 0;
+            return static_cast<bool>(entry.endTs());
+        });
+        break;
+
+    case Col::DURATION_CYCLES:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            if (!entry.beginTs() || !entry.endTs()) {
+                val = 0;
+                return false;
+            }
+
+            val = static_cast<long long>(entry.endTs()->cycles() - entry.beginTs()->cycles());
+            return true;
+        });
+        break;
+
+    case Col::DURATION_NS:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            if (!entry.beginTs() || !entry.endTs()) {
+                val = 0;
+                return false;
+            }
+
+            val = entry.endTs()->nsFromOrigin() - entry.beginTs()->nsFromOrigin();
+            return true;
+        });
+        break;
+
+    case Col::SEQ_NUM:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            return _setOpt(entry.seqNum(), val);
+        });
+        break;
+
+    case Col::DS_ID:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            return _setOpt(entry.dsId(), val);
+        });
+        break;
+
+    case Col::DST_ID:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = entry.dst() ? static_cast<long long>(entry.dst()->id()) : 0;
+            return entry.dst() != nullptr;
+        });
+        break;
+
+    case Col::DISC_ER_COUNTER:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            return _setOpt(entry.discErCounterSnap(), val);
+        });
+        break;
+
+    case Col::IS_INVALID:
+        this->_fill(block, [](const Entry& entry, long long& val) {
+            val = entry.isInvalid() ? 1 : 0;
+            return true;
+        });
+        break;
+
+    default:
+        std::abort();
+    }
+}
+
+class UnaryNode final :
+    public PktFilter::Node
+{
+public:
+    explicit UnaryNode(const UnaryOp op, std::unique_ptr<Node> operand) :
+        _op {op},
+        _operand {std::move(operand)}
+    {
+    }
+
+    void eval(const Block& block) override
+    {
+        _operand->eval(block);
+
+        const auto vals = _operand->vals();
+        const auto valids = _operand->valids();
+
+        if (_op == UnaryOp::NEG) {
+            for (Index i = 0; i < block.len; ++i) {
+                _vals[i] = static_cast<long long>(0ULL - static_cast<unsigned long long>(vals[i]));
+                _valids[i] = valids[i];
+            }
+        } else {
+            // missing is false
+            for (Index i = 0; i < block.len; ++i) {
+                _vals[i] = !(valids[i] && vals[i] != 0);
+                _valids[i] = 1;
+            }
+        }
+    }
+
+private:
+    const UnaryOp _op;
+    const std::unique_ptr<Node> _operand;
+};
+
+class BinNode final :
+    public PktFilter::Node
+{
+public:
+    explicit BinNode(const BinOp op, std::unique_ptr<Node> left, std::unique_ptr<Node> right) :
+        _op {op},
+        _left {std::move(left)},
+        _right {std::move(right)}
+    {
+    }
+
+    void eval(const Block& block) override;
+
+private:
+    /*
+     * Sets each value to `func(a, b)` and each validity to whether or
+     * not both operands exist.
+     */
+    template <typename FuncT>
+    void _apply(const Size len, FuncT&& func)
+    {
+        const auto a = _left->vals();
+        const auto b = _right->vals();
+        const auto aValids = _left->valids();
+        const auto bValids = _right->valids();
+
+        for (Index i = 0; i < len; ++i) {
+            _vals[i] = func(a[i], b[i]);
+            _valids[i] = aValids[i] & bValids[i];
+        }
+    }
+
+    // like _apply(), but for logical operators: missing is false
+    template <typename FuncT>
+    void _applyLogical(const Size len, FuncT&& func)
+    {
+        const auto a = _left->vals();
+        const auto b = _right->vals();
+        const auto aValids = _left->valids();
+        const auto bValids = _right->valids();
+
+        for (Index i = 0; i < len; ++i) {
+            _vals[i] = func(aValids[i] && a[i] != 0, bValids[i] && b[i] != 0);
+            _valids[i] = 1;
+        }
+    }
+
+    // like _apply(), but a zero divisor makes the value missing
+    template <typename FuncT>
+    void _applyDiv(const Size len, FuncT&& func)
+    {
+        const auto a = _left->vals();
+        const auto b = _right->vals();
+        const auto aValids = _left->valids();
+        const auto bValids = _right->valids();
+
+        for (Index i = 0; i < len; ++i) {
+            const auto divisorIsValid = b[i] != 0 &&
+                                        !(b[i] == -1 &&
+                                          a[i] == std::numeric_limits<long long>::min());
+
+            _vals[i] = divisorIsValid ? func(a[i], b[i]) : 0;
+            _valids[i] = aValids[i] & bValids[i] & divisorIsValid;
+        }
+    }
+
+    static long long _wrap(const unsigned long long val) noexcept
+    {
+        return static_cast<long long>(val);
+    }
+
+private:
+    const BinOp _op;
+    const std::unique_ptr<Node> _left;
+    const std::unique_ptr<Node> _right;
+};
+
+void BinNode::eval(const Block& block)
+{
+    using ULL = unsigned long long;
+
+    _left->eval(block);
+    _right->eval(block);
+
+    const auto len = block.len;
+
+    // wrap instead of overflowing
+    switch (_op) {
+    case BinOp::ADD:
+        this->_apply(len, [](const long long a, const long long b) {
+            return _wrap(static_cast<ULL>(a) + static_cast<ULL>(b));
+        });
+        break;
+
+    case BinOp::SUB:
+        this->_apply(len, [](const long long a, const long long b) {
+            return _wrap(static_cast<ULL>(a) - static_cast<ULL>(b));
+        });
+        break;
+
+    case BinOp::MUL:
+        this->_apply(len, [](const long long a, const long long b) {
+            return _wrap(static_cast<ULL>(a) * static_cast<ULL>(b));
+        });
+        break;
+
+    case BinOp::DIV:
+        this->_applyDiv(len, [](const long long a, const long long b) {
+            return a / b;
+        });
+        break;
+
+    case BinOp::MOD:
+        this->_applyDiv(len, [](const long long a, const long long b) {
+            return a % b;
+        });
+        break;
+
+    case BinOp::EQ:
+        this->_apply(len, [](const long long a, const long long b) {
+            return static_cast<long long>(a == b);
+        });
+        break;
+
+    case BinOp::NE:
+        this->_apply(len, [](const long long a, const long long b) {
+            return static_cast<long long>(a != b);
+        });
+        break;
+
+    case BinOp::LT:
+        this->_apply(len, [](const long long a, const long long b) {
+            return static_cast<long long>(a < b);
+        });
+        break;
+
+    case BinOp::LE:
+        this->_apply(len, [](const long long a, const long long b) {
+            return static_cast<long long>(a <= b);
+        });
+        break;
+
+    case BinOp::GT:
+        this->_apply(len, [](const long long a, const long long b) {
+            return static_cast<long long>(a > b);
+        });
+        break;
+
+    case BinOp::GE:
+        this->_apply(len, [](const long long a, const long long b) {
+            return static_cast<long long>(a >= b);
+        });
+        break;
+
+    case BinOp::AND:
+        this->_applyLogical(len, [](const bool a, const bool b) {
+            return static_cast<long long>(a && b);
+        });
+        break;
+
+    case BinOp::OR:
+        this->_applyLogical(len, [](const bool a, const bool b) {
+            return static_cast<long long>(a || b);
+        });
+        break;
+
+    default:
+        std::abort();
+    }
+}
+
+/*
+ * Recursive descent parser of packet filter expressions.
+ *
+ * Grammar, from the lowest to the highest precedence:
+ *
+ *     or:      and (("or" | "||") and)*
+ *     and:     not (("and" | "&&") not)*
+ *     not:     ("not" | "!") not | cmp
+ *     cmp:     add (("==" | "!=" | "<" | "<=" | ">" | ">=") add)?
+ *     add:     mul (("+" | "-") mul)*
+ *     mul:     unary (("*" | "/" | "%") unary)*
+ *     unary:   "-" unary | primary
+ *     primary: NUMBER ["ns" | "us" | "ms" | "s"] | PROPERTY |
+ *              "delta" "(" PROPERTY ")" | "(" or ")"
+ */
+class Parser final
+{
+public:
+    explicit Parser(const std::string& expr) :
+        _expr {&expr}
+    {
+    }
+
+    std::unique_ptr<PktFilter::Node> parse()
+    {
+        auto node = this->_parseOr();
+
+        this->_skipWs();
+
+        if (_at < _expr->size()) {
+            this->_throwUnexpected();
+        }
+
+        return node;
+    }
+
+private:
+    using _NodeUp = std::unique_ptr<PktFilter::Node>;
+
+private:
+    _NodeUp _parseOr();
+    _NodeUp _parseAnd();
+    _NodeUp _parseNot();
+    _NodeUp _parseCmp();
+    _NodeUp _parseAdd();
+    _NodeUp _parseMul();
+    _NodeUp _parseUnary();
+    _NodeUp _parsePrimary();
+    Col _parseCol();
+
+    void _skipWs()
+    {
+        while (_at < _expr->size() && std::isspace((*_expr)[_at])) {
+            ++_at;
+        }
+    }
+
+    /*
+     * Skips `token` if it's next; a word token must not be followed
+     * with an identifier character.
+     */
+    bool _tryToken(const char * const token)
+    {
+        this->_skipWs();
+
+        const auto len = std::strlen(token);
+
+        if (_expr->compare(_at, len, token) != 0) {
+            return false;
+        }
+
+        if (std::isalpha(token[0]) && _at + len < _expr->size() &&
+                isIdentChar((*_expr)[_at + len])) {
+            return false;
+        }
+
+        _at += len;
+        return true;
+    }
+
+    std::string _tryIdent()
+    {
+        this->_skipWs();
+
+        const auto begin = _at;
+
+        if (_at < _expr->size() && (std::isalpha((*_expr)[_at]) || (*_expr)[_at] == '_')) {
+            while (_at < _expr->size() && isIdentChar((*_expr)[_at])) {
+                ++_at;
+            }
+        }
+
+        return _expr->substr(begin, _at - begin);
+    }
+
+    static bool isIdentChar(const char ch) noexcept
+    {
+        return std::isalnum(ch) || ch == '_';
+    }
+
+    [[noreturn]] void _throwUnexpected() const
+    {
+        std::ostringstream ss;
+
+        if (_at >= _expr->size()) {
+            ss << "Unexpected end of expression.";
+        } else {
+            ss << "Unexpected `" << (*_expr)[_at] << "` at position " << _at + 1 << ".";
+        }
+
+        throw PktFilterError {ss.str()};
+    }
+
+private:
+    const std::string *_expr;
+    Index _at = 0;
+};
+
+Parser::_NodeUp Parser::_parseOr()
+{
+    auto node = this->_parseAnd();
+
+    while (this->_tryToken("or") || this->_tryToken("||")) {
+        node = std::make_unique<BinNode>(BinOp::OR, std::move(node), this->_parseAnd());
+    }
+
+    return node;
+}
+
+Parser::_NodeUp Parser::_parseAnd()
+{
+    auto node = this->_parseNot();
+
+    while (this->_tryToken("and") || this->_tryToken("&&")) {
+        node = std::make_unique<BinNode>(BinOp::AND, std::move(node), this->_parseNot());
+    }
+
+    return node;
+}
+
+Parser::_NodeUp Parser::_parseNot()
+{
+    // `!=` is a comparison operator, but it never begins an operand
+    if (this->_tryToken("not") || this->_tryToken("!")) {
+        return std::make_unique<UnaryNode>(UnaryOp::NOT, this->_parseNot());
+    }
+
+    return this->_parseCmp();
+}
+
+Parser::_NodeUp Parser::_parseCmp()
+{
+    auto node = this->_parseAdd();
+
+    // longest operators first
+    static constexpr std::pair<const char *, BinOp> ops[] = {
+        {"==", BinOp::EQ},
+        {"!=", BinOp::NE},
+        {"<=", BinOp::LE},
+        {">=", BinOp::GE},
+        {"<", BinOp::LT},
+        {">", BinOp::GT},
+    };
+
+    for (const auto& op : ops) {
+        if (this->_tryToken(op.first)) {
+            return std::make_unique<BinNode>(op.second, std::move(node), this->_parseAdd());
+        }
+    }
+
+    return node;
+}
+
+Parser::_NodeUp Parser::_parseAdd()
+{
+    auto node = this->_parseMul();
+
+    while (true) {
+        if (this->_tryToken("+")) {
+            node = std::make_unique<BinNode>(BinOp::ADD, std::move(node), this->_parseMul());
+        } else if (this->_tryToken("-")) {
+            node = std::make_unique<BinNode>(BinOp::SUB, std::move(node), this->_parseMul());
+        } else {
+            return node;
+        }
+    }
+}
+
+Parser::_NodeUp Parser::_parseMul()
+{
+    auto node = this->_parseUnary();
+
+    while (true) {
+        if (this->_tryToken("*")) {
+            node = std::make_unique<BinNode>(BinOp::MUL, std::move(node), this->_parseUnary());
+        } else if (this->_tryToken("/")) {
+            node = std::make_unique<BinNode>(BinOp::DIV, std::move(node), this->_parseUnary());
+        } else if (this->_tryToken("%")) {
+            node = std::make_unique<BinNode>(BinOp::MOD, std::move(node), this->_parseUnary());
+        } else {
+            return node;
+        }
+    }
+}
+
+Parser::_NodeUp Parser::_parseUnary()
+{
+    if (this->_tryToken("-")) {
+        return std::make_unique<UnaryNode>(UnaryOp::NEG, this->_parseUnary());
+    }
+
+    return this->_parsePrimary();
+}
+
+Col Parser::_parseCol()
+{
+    const auto begin = _at;
+    const auto name = this->_tryIdent();
+
+    for (const auto& colName : colNames) {
+        if (name == colName.name) {
+            return colName.col;
+        }
+    }
+
+    if (name.empty()) {
+        this->_throwUnexpected();
+    }
+
+    std::ostringstream ss;
+
+    ss << "Unknown packet property `" << name << "` at position " << begin + 1 << ".";
+    throw PktFilterError {ss.str()};
+}
+
+Parser::_NodeUp Parser::_parsePrimary()
+{
+    this->_skipWs();
+
+    if (this->_tryToken("(")) {
+        auto node = this->_parseOr();
+
+        if (!this->_tryToken(")")) {
+            this->_throwUnexpected();
+        }
+
+        return node;
+    }
+
+    if (_at < _expr->size() && std::isdigit((*_expr)[_at])) {
+        const auto begin = _at;
+        unsigned long long val = 0;
+
+        while (_at < _expr->size() && std::isdigit((*_expr)[_at])) {
+            const unsigned long long digit = (*_expr)[_at] - '0';
+
+            if (val > (std::numeric_limits<long long>::max() - digit) / 10) {
+                std::ostringstream ss;
+
+                ss << "Integer at position " << begin + 1 << " is too large.";
+                throw PktFilterError {ss.str()};
+            }
+
+            val = val * 10 + digit;
+            ++_at;
+        }
+
+        // duration suffix: value in nanoseconds
+        static constexpr std::pair<const char *, unsigned long long> suffixes[] = {
+            {"ns", 1},
+            {"us", 1000},
+            {"ms", 1000000},
+            {"s", 1000000000},
+        };
+
+        for (const auto& suffix : suffixes) {
+            const auto len = std::strlen(suffix.first);
+
+            if (_expr->compare(_at, len, suffix.first) == 0 &&
+                    (_at + len >= _expr->size() || !isIdentChar((*_expr)[_at + len]))) {
+                if (val > static_cast<unsigned long long>(std::numeric_limits<long long>::max()) /
+                        suffix.second) {
+                    std::ostringstream ss;
+
+                    ss << "Duration at position " << begin + 1 << " is too large.";
+                    throw PktFilterError {ss.str()};
+                }
+
+                val *= suffix.second;
+                _at += len;
+                break;
+            }
+        }
+
+        if (_at < _expr->size() && isIdentChar((*_expr)[_at])) {
+            this->_throwUnexpected();
+        }
+
+        return std::make_unique<ConstNode>(static_cast<long long>(val));
+    }
+
+    if (this->_tryToken("delta")) {
+        if (!this->_tryToken("(")) {
+            this->_throwUnexpected();
+        }
+
+        const auto col = this->_parseCol();
+
+        if (!this->_tryToken(")")) {
+            this->_throwUnexpected();
+        }
+
+        return std::make_unique<BinNode>(BinOp::SUB, std::make_unique<ColNode>(col, false),
+                                         std::make_unique<ColNode>(col, true));
+    }
+
+    return std::make_unique<ColNode>(this->_parseCol(), false);
+}
+
+} // namespace
+
+PktFilter::PktFilter(const std::string& expr) :
+    _root {Parser {expr}.parse()}
+{
+}
+
+PktFilter::~PktFilter()
+{
+}
+
+void PktFilter::filter(const std::vector<PktIndexEntry>& entries,
+                       std::vector<std::uint8_t>& matches) const
+{
+    matches.resize(entries.size());
+
+    for (Index begin = 0; begin < entries.size(); begin += blockSize) {
+        const Block block {&entries, begin, std::min<Size>(blockSize, entries.size() - begin)};
+
+        _root->eval(block);
+
+        const auto vals = _root->vals();
+        const auto valids = _root->valids();
+
+        for (Index i = 0; i < block.len; ++i) {
+            matches[begin + i] = valids[i] & (vals[i] != 0);
+        }
+    }
+}
+
+} // namespace jacques
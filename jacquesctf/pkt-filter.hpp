@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_PKT_FILTER_HPP
+#define _JACQUES_PKT_FILTER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+#include "data/pkt-index-entry.hpp"
+
+namespace jacques {
+
+class PktFilterError final :
+    public std::runtime_error
+{
+public:
+    explicit PktFilterError(const std::string& msg) :
+        std::runtime_error {msg}
+    {
+    }
+};
+
+/*
+ * Packet filter: a compiled expression over the properties of packet
+ * index entries, for example:
+ *
+ *     end_ts_ns - begin_ts_ns > 1ms and delta(disc_er_counter) > 0
+ *
+ * Values are signed 64-bit integers; a comparison or logical
+ * expression is 1 (true) or 0 (false). A value may also be missing
+ * (for example, the sequence number of a packet which has none, or
+ * the difference with the previous packet of the first packet): any
+ * arithmetic or comparison involving a missing value is also missing,
+ * while logical operators consider a missing value false. A packet
+ * matches when the expression is present and not zero.
+ *
+ * A filter evaluates the expression over blocks of consecutive packet
+ * index entries, one operation at a time: each node of the expression
+ * tree loops over contiguous arrays, without any per-packet dispatch.
+ *
+ * A filter is NOT thread-safe: it keeps its block buffers.
+ */
+class PktFilter final :
+    boost::noncopyable
+{
+public:
+    class Node;
+
+public:
+    /*
+     * Compiles `expr`.
+     *
+     * Throws `PktFilterError` if `expr` is invalid.
+     */
+    explicit PktFilter(const std::string& expr);
+
+    ~PktFilter();
+
+    /*
+     * Sets `matches` to one element per entry of `entries`: 1 if the
+     * packet satisfies the expression, or 0 otherwise.
+     *
+     * `entries` must be all the index entries of a data stream file,
+     * in order, for `delta()` to use the previous packet.
+     */
+    void filter(const std::vector<PktIndexEntry>& entries,
+                std::vector<std::uint8_t>& matches) const;
+
+private:
+    std::unique_ptr<Node> _root;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_PKT_FILTER_HPP
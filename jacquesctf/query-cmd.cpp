@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "cfg.hpp"
+#include "query-cmd.hpp"
+#include "cmd-error.hpp"
+#include "worker-pool.hpp"
+#include "utils.hpp"
+#include "inspect-common/app-state.hpp"
+#include "inspect-common/search-query.hpp"
+#include "data/byte-pattern-finder.hpp"
+#include "data/pkt-checkpoints-build-listener.hpp"
+
+namespace jacques {
+namespace {
+
+/*
+ * Application state without any user interface: the state of all the
+ * data stream files and their packets stays in memory between
+ * queries.
+ */
+class QueryAppState final :
+    public AppState
+{
+public:
+    explicit QueryAppState(const std::vector<boost::filesystem::path>& paths,
+                           PktCheckpointsBuildListener& pktCheckpointsBuildListener) :
+        AppState {paths, pktCheckpointsBuildListener}
+    {
+    }
+};
+
+/*
+ * Location of a query result.
+ */
+struct Location
+{
+    Index dsFileIndex;
+    boost::optional<Index> pktIndex;
+    boost::optional<Index> erIndexInPkt;
+    boost::optional<Index> offsetInDsFileBits;
+    boost::optional<Ts> ts;
+};
+
+class ResultWriter final
+{
+public:
+    explicit ResultWriter(const QueryCfg::Fmt fmt, const AppState& appState) :
+        _fmt {fmt},
+        _appState {&appState}
+    {
+    }
+
+    void writeLocation(const std::string& query, const Location& loc)
+    {
+        this->_write(query, "found", &loc);
+    }
+
+    void writeStatus(const std::string& query, const char * const status)
+    {
+        this->_write(query, status, nullptr);
+    }
+
+    void flush()
+    {
+        std::cout << _out;
+        std::cout.flush();
+        _out.clear();
+    }
+
+private:
+    void _write(const std::string& query, const char *status, const Location *loc);
+
+    template <typename ValT>
+    void _appendOpt(const boost::optional<ValT>& val, const char * const none)
+    {
+        if (val) {
+            utils::appendUInt(_out, *val);
+        } else {
+            _out += none;
+        }
+    }
+
+private:
+    const QueryCfg::Fmt _fmt;
+    const AppState *_appState;
+    std::string _out;
+};
+
+void ResultWriter::_write(const std::string& query, const char * const status,
+                          const Location * const loc)
+{
+    const auto isJson = _fmt == QueryCfg::Fmt::JSON_LINES;
+    const auto none = isJson ? "null" : "";
+
+    // indexes are natural (1-based), like in the search queries
+    auto natIndex = [](const boost::optional<Index>& index) {
+        return index ? boost::make_optional(*index + 1) : boost::none;
+    };
+
+    if (isJson) {
+        _out += "{\"query\":";
+        utils::appendJsonStr(_out, query);
+        _out += ",\"status\":\"";
+        _out += status;
+        _out += "\",\"path\":";
+    } else {
+        utils::appendCsvField(_out, query);
+        _out += ',';
+        _out += status;
+        _out += ',';
+    }
+
+    if (loc) {
+        const auto& path = _appState->dsFileState(loc->dsFileIndex).dsFile().path().string();
+
+        if (isJson) {
+            utils::appendJsonStr(_out, path);
+        } else {
+            utils::appendCsvField(_out, path);
+        }
+    } else {
+        _out += none;
+    }
+
+    _out += isJson ? ",\"packet-index\":" : ",";
+    this->_appendOpt(loc ? natIndex(loc->pktIndex) : boost::none, none);
+    _out += isJson ? ",\"event-record-index\":" : ",";
+    this->_appendOpt(loc ? natIndex(loc->erIndexInPkt) : boost::none, none);
+    _out += isJson ? ",\"offset-bits\":" : ",";
+    this->_appendOpt(loc ? loc->offsetInDsFileBits : boost::none, none);
+    _out += isJson ? ",\"ts-cycles\":" : ",";
+
+    if (loc && loc->ts) {
+        utils::appendUInt(_out, loc->ts->cycles());
+        _out += isJson ? ",\"ts-ns\":" : ",";
+        utils::appendInt(_out, loc->ts->nsFromOrigin());
+    } else {
+        _out += none;
+        _out += isJson ? ",\"ts-ns\":" : ",";
+        _out += none;
+    }
+
+    _out += isJson ? "}\n" : "\n";
+
+    if (_out.size() >= 1 << 20) {
+        this->flush();
+    }
+}
+
+/*
+ * Returns the current location of `appState`.
+ */
+Location curLocation(AppState& appState)
+{
+    Location loc;
+    auto& dsFileState = appState.activeDsFileState();
+
+    loc.dsFileIndex = appState.activeDsFileStateIndex();
+
+    if (!dsFileState.hasActivePktState()) {
+        return loc;
+    }
+
+    loc.pktIndex = dsFileState.activePktStateIndex();
+    loc.offsetInDsFileBits = dsFileState.curOffsetInDsFileBits();
+
+    if (const auto er = dsFileState.curEr()) {
+        loc.erIndexInPkt = er->indexInPkt();
+
+        if (er->ts()) {
+            loc.ts = *er->ts();
+        }
+    }
+
+    return loc;
+}
+
+/*
+ * Runs `query`, which goes to the next match from the current
+ * location, and writes the new location.
+ */
+void runQuery(QueryAppState& appState, const std::string& queryStr, const SearchQuery& query,
+              ResultWriter& writer)
+{
+    if (!appState.search(query)) {
+        writer.writeStatus(queryStr, "not-found");
+        return;
+    }
+
+    writer.writeLocation(queryStr, curLocation(appState));
+}
+
+/*
+ * Writes all the occurrences of the byte pattern of `query` within the
+ * active data stream file, each one with the packet containing it, if
+ * any.
+ *
+ * This only scans the raw data: it doesn't decode anything.
+ */
+void runFindAllBytePatternQuery(QueryAppState& appState, const std::string& queryStr,
+                                const BytePatternSearchQuery& query, ResultWriter& writer)
+{
+    const auto dsFileIndex = appState.activeDsFileStateIndex();
+    const auto& dsf = appState.dsFileState(dsFileIndex).dsFile();
+    Size matchCount = 0;
+
+    BytePatternFinder {dsf, query.pattern()}.forEachMatch(0, [&](const Index offsetBytes) {
+        Location loc;
+
+        loc.dsFileIndex = dsFileIndex;
+        loc.offsetInDsFileBits = offsetBytes * 8;
+
+        // the match could follow the last indexed packet
+        if (dsf.hasOffsetBits(*loc.offsetInDsFileBits)) {
+            const auto& entry = dsf.pktIndexEntryContainingOffsetBits(offsetBytes * 8);
+
+            loc.pktIndex = entry.indexInDsFile();
+        }
+
+        writer.writeLocation(queryStr, loc);
+        ++matchCount;
+        return true;
+    });
+
+    if (matchCount == 0) {
+        writer.writeStatus(queryStr, "not-found");
+    }
+}
+
+/*
+ * Writes all the event records matching `query`, within all the data
+ * stream files if it's trace-wide, or within the active one
+ * otherwise.
+ */
+void runFindAllQuery(QueryAppState& appState, const std::string& queryStr,
+                     const SearchQuery& query, ResultWriter& writer)
+{
+    if (const auto bpQuery = dynamic_cast<const BytePatternSearchQuery *>(&query)) {
+        runFindAllBytePatternQuery(appState, queryStr, *bpQuery, writer);
+        return;
+    }
+
+    std::vector<Index> dsFileIndexes;
+
+    if (query.isTraceWide()) {
+        for (Index index = 0; index < appState.dsFileStateCount(); ++index) {
+            dsFileIndexes.push_back(index);
+        }
+    } else {
+        dsFileIndexes.push_back(appState.activeDsFileStateIndex());
+    }
+
+    Size matchCount = 0;
+
+    for (const auto dsFileIndex : dsFileIndexes) {
+        const auto& dsFileState = appState.dsFileState(dsFileIndex);
+
+        // ErFinder decodes the packets in parallel and reports them in order
+        const auto ret = dsFileState.findAll(query, [&](const ErFinder::Result& result) {
+            const auto& indexEntry = dsFileState.dsFile().pktIndexEntries()[result.pktIndex];
+            Location loc;
+
+            loc.dsFileIndex = dsFileIndex;
+            loc.pktIndex = result.pktIndex;
+            loc.erIndexInPkt = result.erIndexInPkt;
+            loc.offsetInDsFileBits = indexEntry.offsetInDsFileBits() + result.erOffsetInPktBits;
+            loc.ts = result.erTs;
+            writer.writeLocation(queryStr, loc);
+            ++matchCount;
+            return true;
+        });
+
+        if (!ret && matchCount == 0) {
+            writer.writeStatus(queryStr, "unsupported");
+            return;
+        }
+    }
+
+    if (matchCount == 0) {
+        writer.writeStatus(queryStr, "not-found");
+    }
+}
+
+void runQueryStr(QueryAppState& appState, const QueryCfg& cfg, const std::string& queryStr,
+                 ResultWriter& writer)
+{
+    const auto query = parseSearchQuery(queryStr);
+
+    if (!query) {
+        writer.writeStatus(queryStr, "invalid");
+        return;
+    }
+
+    if (cfg.findAll()) {
+        runFindAllQuery(appState, queryStr, *query, writer);
+    } else {
+        runQuery(appState, queryStr, *query, writer);
+    }
+}
+
+void buildIndexes(QueryAppState& appState)
+{
+    auto& dsFileStates = appState.dsFileStates();
+    std::atomic<Index> nextIndex {0};
+
+    WorkerPool {}.run([&dsFileStates, &nextIndex](Index) {
+        while (true) {
+            const auto index = nextIndex++;
+
+            if (index >= dsFileStates.size()) {
+                return;
+            }
+
+            dsFileStates[index]->dsFile().buildIndex();
+        }
+    }, dsFileStates.size());
+}
+
+} // namespace
+
+void queryCmd(const QueryCfg& cfg)
+{
+    NullPktCheckpointsBuildListener pktCheckpointsBuildListener;
+    QueryAppState appState {cfg.paths(), pktCheckpointsBuildListener};
+
+    if (appState.dsFileStates().empty()) {
+        throw CmdError {"All data stream files to query are empty."};
+    }
+
+    buildIndexes(appState);
+
+    if (appState.activeDsFileState().dsFile().pktCount() > 0) {
+        appState.gotoPkt(0);
+    }
+
+    ResultWriter writer {cfg.format(), appState};
+
+    if (!cfg.queries().empty()) {
+        for (const auto& queryStr : cfg.queries()) {
+            runQueryStr(appState, cfg, queryStr, writer);
+        }
+
+        writer.flush();
+        return;
+    }
+
+    // one query per line; flush after each one for interactive scripts
+    std::string queryStr;
+
+    while (std::getline(std::cin, queryStr)) {
+        if (queryStr.find_first_not_of(" \t") == std::string::npos) {
+            continue;
+        }
+
+        runQueryStr(appState, cfg, queryStr, writer);
+        writer.flush();
+    }
+}
+
+} // namespace jacques
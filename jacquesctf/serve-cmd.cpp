@@ -0,0 +1,915 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <boost/optional.hpp>
+#include <boost/variant.hpp>
+#include <boost/core/noncopyable.hpp>
+
+#include "cfg.hpp"
+#include "serve-cmd.hpp"
+#include "cmd-error.hpp"
+#include "ds-file-set.hpp"
+#include "payload-json-formatter.hpp"
+#include "utils.hpp"
+#include "data/content-pkt-region.hpp"
+#include "data/ds-file.hpp"
+#include "data/er-field-pred.hpp"
+#include "data/er-finder.hpp"
+#include "data/error-pkt-region.hpp"
+#include "data/padding-pkt-region.hpp"
+#include "data/pkt-checkpoints-build-listener.hpp"
+#include "data/pkt-decoder.hpp"
+#include "inspect-common/search-query.hpp"
+
+namespace jacques {
+namespace {
+
+// maximum length of a request frame
+constexpr Size maxReqLen = 1 << 20;
+
+/*
+ * Error caused by a request: the server sends it back to the client
+ * and keeps going.
+ */
+class ReqError final :
+    public std::runtime_error
+{
+public:
+    explicit ReqError(const std::string& msg) :
+        std::runtime_error {msg}
+    {
+    }
+};
+
+/*
+ * Packets which DsFile::pktAtIndex() created and which the server
+ * keeps in memory to answer the next requests quickly.
+ *
+ * When the total size of the hot packets exceeds the memory budget,
+ * the least recently used ones are destroyed. The size of a packet is
+ * approximated by its total length, which is what its memory mapping
+ * and, roughly, its checkpoints and caches cost.
+ *
+ * A hot packet set is NOT thread-safe: lock mutex() to create or use
+ * hot packets. DsFile::pktAtIndex() also modifies packet index
+ * entries: lock mutex() to read their event record counts.
+ */
+class HotPkts final :
+    boost::noncopyable
+{
+public:
+    explicit HotPkts(const Size memBudget) :
+        _memBudget {memBudget}
+    {
+    }
+
+    /*
+     * Returns the packet at index `pktIndex` within `dsf`, creating it
+     * if needed.
+     *
+     * The returned packet remains valid until the next call.
+     */
+    Pkt& pkt(DsFile& dsf, Index pktIndex);
+
+    std::mutex& mutex() noexcept
+    {
+        return _mutex;
+    }
+
+private:
+    struct _Entry
+    {
+        DsFile *dsFile;
+        Index pktIndex;
+        Size size;
+    };
+
+    using _Lru = std::list<_Entry>;
+
+private:
+    const Size _memBudget;
+    std::mutex _mutex;
+    NullPktCheckpointsBuildListener _buildListener;
+
+    // most recently used first
+    _Lru _lru;
+
+    std::map<std::pair<const DsFile *, Index>, _Lru::iterator> _entries;
+    Size _size = 0;
+};
+
+Pkt& HotPkts::pkt(DsFile& dsf, const Index pktIndex)
+{
+    const auto entryIt = _entries.find({&dsf, pktIndex});
+
+    if (entryIt != _entries.end()) {
+        _lru.splice(_lru.begin(), _lru, entryIt->second);
+        return dsf.pktAtIndex(pktIndex, _buildListener);
+    }
+
+    const auto size = dsf.pktIndexEntry(pktIndex).effectiveTotalLen().bytes();
+
+    // always keep the requested packet, even if it exceeds the budget
+    while (!_lru.empty() && _size + size > _memBudget) {
+        const auto& victim = _lru.back();
+
+        victim.dsFile->discardPkt(victim.pktIndex);
+        _size -= victim.size;
+        _entries.erase({victim.dsFile, victim.pktIndex});
+        _lru.pop_back();
+    }
+
+    auto& pkt = dsf.pktAtIndex(pktIndex, _buildListener);
+
+    _lru.push_front({&dsf, pktIndex, size});
+    _entries[{&dsf, pktIndex}] = _lru.begin();
+    _size += size;
+    return pkt;
+}
+
+const char *scopeName(const yactfr::Scope scope) noexcept
+{
+    switch (scope) {
+    case yactfr::Scope::PACKET_HEADER:
+        return "packet-header";
+
+    case yactfr::Scope::PACKET_CONTEXT:
+        return "packet-context";
+
+    case yactfr::Scope::EVENT_RECORD_HEADER:
+        return "event-record-header";
+
+    case yactfr::Scope::EVENT_RECORD_COMMON_CONTEXT:
+        return "event-record-common-context";
+
+    case yactfr::Scope::EVENT_RECORD_SPECIFIC_CONTEXT:
+        return "event-record-specific-context";
+
+    case yactfr::Scope::EVENT_RECORD_PAYLOAD:
+        return "event-record-payload";
+
+    default:
+        std::abort();
+    }
+}
+
+/*
+ * Appends the JSON line of an event record.
+ */
+void appendErJsonLine(std::string& out, const PktIndexEntry& pktIndexEntry,
+                      const Index indexInPkt, const Index offsetInPktBits,
+                      const yactfr::EventRecordType * const ert, const boost::optional<Ts>& ts,
+                      const std::string * const payloadJson)
+{
+    out += "{\"packet-index\":";
+    utils::appendUInt(out, pktIndexEntry.natIndexInDsFile());
+    out += ",\"index\":";
+    utils::appendUInt(out, indexInPkt + 1);
+    out += ",\"offset-bits\":";
+    utils::appendUInt(out, pktIndexEntry.offsetInDsFileBits() + offsetInPktBits);
+    out += ",\"type-id\":";
+
+    if (ert) {
+        utils::appendUInt(out, ert->id());
+    } else {
+        out += "null";
+    }
+
+    out += ",\"type-name\":";
+
+    if (ert && ert->name()) {
+        utils::appendJsonStr(out, *ert->name());
+    } else {
+        out += "null";
+    }
+
+    utils::appendJsonTs(out, "ts", ts);
+
+    if (payloadJson) {
+        out += ",\"payload\":";
+        out += payloadJson->empty() ? "null" : *payloadJson;
+    }
+
+    out += "}\n";
+}
+
+/*
+ * Appends the JSON line of the packet region `region` of `pkt`.
+ */
+void appendRegionJsonLine(std::string& out, const Pkt& pkt, const PktRegion& region)
+{
+    static constexpr const char *hexDigits = "0123456789abcdef";
+    const auto& seg = region.segment();
+    const auto contentRegion = dynamic_cast<const ContentPktRegion *>(&region);
+
+    out += "{\"kind\":\"";
+
+    if (contentRegion) {
+        out += "content";
+    } else if (dynamic_cast<const PaddingPktRegion *>(&region)) {
+        out += "padding";
+    } else {
+        assert(dynamic_cast<const ErrorPktRegion *>(&region));
+        out += "error";
+    }
+
+    out += "\",\"offset-in-packet-bits\":";
+    utils::appendUInt(out, seg.offsetInPktBits());
+    out += ",\"length-bits\":";
+
+    if (seg.len()) {
+        utils::appendUInt(out, seg.len()->bits());
+    } else {
+        out += "null";
+    }
+
+    out += ",\"scope\":";
+
+    if (region.scope()) {
+        out += '"';
+        out += scopeName(region.scope()->scope());
+        out += '"';
+    } else {
+        out += "null";
+    }
+
+    out += ",\"value\":";
+
+    const auto val = contentRegion ? contentRegion->val().get_ptr() : nullptr;
+
+    if (!val) {
+        out += "null";
+    } else if (const auto bVal = boost::get<bool>(val)) {
+        out += *bVal ? "true" : "false";
+    } else if (const auto uIntVal = boost::get<unsigned long long>(val)) {
+        utils::appendUInt(out, *uIntVal);
+    } else if (const auto sIntVal = boost::get<long long>(val)) {
+        utils::appendInt(out, *sIntVal);
+    } else if (const auto dVal = boost::get<double>(val)) {
+        utils::appendJsonDouble(out, *dVal);
+    } else if (const auto strVal = boost::get<std::string>(val)) {
+        utils::appendJsonStr(out, *strVal);
+    } else {
+        out += "null";
+    }
+
+    // bytes which contain the region, as is
+    out += ",\"data\":\"";
+
+    if (seg.len() && seg.len()->bits() > 0) {
+        const auto firstByte = seg.offsetInPktBits() / 8;
+        const auto endByte = (*seg.endOffsetInPktBits() + 7) / 8;
+        const auto data = pkt.data(firstByte);
+
+        for (Index i = 0; i < endByte - firstByte; ++i) {
+            out += hexDigits[data[i] >> 4];
+            out += hexDigits[data[i] & 0xf];
+        }
+    }
+
+    out += "\"}\n";
+}
+
+/*
+ * Server state shared by all the client threads.
+ *
+ * The data stream files and their packet indexes never change once
+ * the server starts: the request handlers may read them concurrently.
+ */
+class Server final :
+    boost::noncopyable
+{
+public:
+    explicit Server(const ServeCfg& cfg, const DsFileSet& dsFileSet) :
+        _dsFiles {dsFileSet.dsFiles()},
+        _hotPkts {cfg.memBudget()}
+    {
+    }
+
+    /*
+     * Handles the request `req` and returns the response body (JSON
+     * lines).
+     *
+     * Throws `ReqError` on request error.
+     */
+    std::string handleReq(const std::string& req);
+
+private:
+    using _Args = std::vector<std::string>;
+
+private:
+    void _handleInfo(const _Args& args, std::string& out);
+    void _handlePkts(const _Args& args, std::string& out);
+    void _handleSearch(const _Args& args, const std::string& query, std::string& out);
+    void _handleEr(const _Args& args, std::string& out);
+    void _handleRegions(const _Args& args, std::string& out);
+    DsFile& _dsFileArg(const _Args& args, Index argIndex) const;
+    Index _pktIndexArg(const DsFile& dsf, const _Args& args, Index argIndex) const;
+
+    static Index _uIntArg(const _Args& args, Index argIndex, const char *what);
+    static void _checkArgCount(const _Args& args, Size min, Size max);
+
+private:
+    const std::vector<DsFile *>& _dsFiles;
+    HotPkts _hotPkts;
+};
+
+std::string Server::handleReq(const std::string& req)
+{
+    _Args args;
+    std::istringstream ss {req};
+    std::string arg;
+
+    while (ss >> arg) {
+        args.push_back(std::move(arg));
+    }
+
+    if (args.empty()) {
+        throw ReqError {"Empty request."};
+    }
+
+    std::string out;
+    const auto& name = args.front();
+
+    if (name == "info") {
+        this->_handleInfo(args, out);
+    } else if (name == "packets") {
+        this->_handlePkts(args, out);
+    } else if (name == "search") {
+        if (args.size() < 3) {
+            throw ReqError {"Missing data stream file index or search query."};
+        }
+
+        // search query: rest of the request after the index argument
+        const auto argPos = req.find(args[1], req.find(name) + name.size());
+        const auto queryPos = req.find_first_not_of(" \t\n", argPos + args[1].size());
+
+        this->_handleSearch(args, req.substr(queryPos), out);
+    } else if (name == "event-record") {
+        this->_handleEr(args, out);
+    } else if (name == "regions") {
+        this->_handleRegions(args, out);
+    } else {
+        std::ostringstream ss;
+
+        ss << "Unknown request `" << name << "`.";
+        throw ReqError {ss.str()};
+    }
+
+    return out;
+}
+
+void Server::_checkArgCount(const _Args& args, const Size min, const Size max)
+{
+    // first "argument" is the request name
+    const auto count = args.size() - 1;
+
+    if (count < min || count > max) {
+        std::ostringstream ss;
+
+        ss << "Wrong argument count for request `" << args.front() << "`.";
+        throw ReqError {ss.str()};
+    }
+}
+
+Index Server::_uIntArg(const _Args& args, const Index argIndex, const char * const what)
+{
+    const auto& arg = args[argIndex];
+
+    if (arg.empty() || arg.find_first_not_of("0123456789") != std::string::npos) {
+        std::ostringstream ss;
+
+        ss << "Invalid " << what << " `" << arg << "`.";
+        throw ReqError {ss.str()};
+    }
+
+    try {
+        return std::stoull(arg);
+    } catch (const std::out_of_range&) {
+        std::ostringstream ss;
+
+        ss << "Invalid " << what << " `" << arg << "`.";
+        throw ReqError {ss.str()};
+    }
+}
+
+DsFile& Server::_dsFileArg(const _Args& args, const Index argIndex) const
+{
+    // natural (1-based) index
+    const auto index = _uIntArg(args, argIndex, "data stream file index");
+
+    if (index == 0 || index > _dsFiles.size()) {
+        std::ostringstream ss;
+
+        ss << "No data stream file " << index << ".";
+        throw ReqError {ss.str()};
+    }
+
+    return *_dsFiles[index - 1];
+}
+
+Index Server::_pktIndexArg(const DsFile& dsf, const _Args& args, const Index argIndex) const
+{
+    // natural (1-based) index
+    const auto index = _uIntArg(args, argIndex, "packet index");
+
+    if (index == 0 || index > dsf.pktCount()) {
+        std::ostringstream ss;
+
+        ss << "No packet " << index << " in data stream file `" << dsf.path().string() << "`.";
+        throw ReqError {ss.str()};
+    }
+
+    return index - 1;
+}
+
+void Server::_handleInfo(const _Args& args, std::string& out)
+{
+    _checkArgCount(args, 0, 0);
+
+    for (Index index = 0; index < _dsFiles.size(); ++index) {
+        const auto& dsf = *_dsFiles[index];
+
+        out += "{\"index\":";
+        utils::appendUInt(out, index + 1);
+        out += ",\"path\":";
+        utils::appendJsonStr(out, dsf.path().string());
+        out += ",\"size-bytes\":";
+        utils::appendUInt(out, dsf.fileLen().bytes());
+        out += ",\"packet-count\":";
+        utils::appendUInt(out, dsf.pktCount());
+        out += "}\n";
+    }
+}
+
+void Server::_handlePkts(const _Args& args, std::string& out)
+{
+    _checkArgCount(args, 1, 3);
+
+    const auto& dsf = this->_dsFileArg(args, 1);
+    Index firstIndex = 0;
+    auto count = dsf.pktCount();
+
+    if (args.size() >= 3) {
+        firstIndex = this->_pktIndexArg(dsf, args, 2);
+    }
+
+    if (args.size() >= 4) {
+        count = _uIntArg(args, 3, "packet count");
+    }
+
+    const auto endIndex = firstIndex + std::min(count, dsf.pktCount() - firstIndex);
+
+    // hot packet creation modifies the event record counts
+    std::lock_guard<std::mutex> lock {_hotPkts.mutex()};
+
+    for (auto index = firstIndex; index < endIndex; ++index) {
+        const auto& entry = dsf.pktIndexEntry(index);
+
+        out += "{\"index\":";
+        utils::appendUInt(out, entry.natIndexInDsFile());
+        out += ",\"offset-bytes\":";
+        utils::appendUInt(out, entry.offsetInDsFileBytes());
+        out += ",\"total-length-bits\":";
+        utils::appendUInt(out, entry.effectiveTotalLen().bits());
+        out += ",\"content-length-bits\":";
+        utils::appendUInt(out, entry.effectiveContentLen().bits());
+        utils::appendJsonOptUInt(out, "seq-num", entry.seqNum());
+        utils::appendJsonOptUInt(out, "data-stream-id", entry.dsId());
+        utils::appendJsonTs(out, "begin-ts", entry.beginTs());
+        utils::appendJsonTs(out, "end-ts", entry.endTs());
+        utils::appendJsonOptUInt(out, "discarded-event-record-counter", entry.discErCounterSnap());
+        utils::appendJsonOptUInt(out, "event-record-count", entry.erCount());
+        out += ",\"is-invalid\":";
+        out += entry.isInvalid() ? "true" : "false";
+        out += "}\n";
+    }
+}
+
+void Server::_handleSearch(const _Args& args, const std::string& queryStr, std::string& out)
+{
+    const auto& dsf = this->_dsFileArg(args, 1);
+    const auto query = parseSearchQuery(queryStr);
+
+    if (!query) {
+        std::ostringstream ss;
+
+        ss << "Invalid search query `" << queryStr << "`.";
+        throw ReqError {ss.str()};
+    }
+
+    const auto pred = erPredFromSearchQuery(*query, dsf.metadata());
+    const auto fieldQuery = dynamic_cast<const ErFieldSearchQuery *>(query.get());
+    boost::optional<ErFieldPred> fieldPred;
+
+    if (fieldQuery) {
+        fieldPred.emplace(dsf.metadata(), fieldQuery->path(), fieldQuery->cond());
+    } else if (!pred) {
+        throw ReqError {"Only event record search queries are supported."};
+    }
+
+    // the finder decodes the packets without creating hot packets
+    ErFinder {dsf}.findAll(pred, [&dsf, &out](const ErFinder::Result& result) {
+        appendErJsonLine(out, dsf.pktIndexEntry(result.pktIndex), result.erIndexInPkt,
+                         result.erOffsetInPktBits, result.ert, result.erTs, nullptr);
+        return true;
+    }, nullptr, fieldPred.get_ptr());
+}
+
+void Server::_handleEr(const _Args& args, std::string& out)
+{
+    _checkArgCount(args, 3, 3);
+
+    const auto& dsf = this->_dsFileArg(args, 1);
+    const auto& pktIndexEntry = dsf.pktIndexEntry(this->_pktIndexArg(dsf, args, 2));
+
+    // natural (1-based) index
+    const auto reqIndex = _uIntArg(args, 3, "event record index");
+    PayloadJsonFormatter payloadFormatter;
+    auto found = false;
+
+    PktDecoder {dsf}.forEachEr(pktIndexEntry, [&](const Er& er) {
+        if (er.indexInPkt() + 1 != reqIndex) {
+            payloadFormatter.reset();
+            return true;
+        }
+
+        appendErJsonLine(out, pktIndexEntry, er.indexInPkt(), er.segment().offsetInPktBits(),
+                         er.type(), er.ts(), &payloadFormatter.json());
+        found = true;
+        return false;
+    }, [&payloadFormatter](const yactfr::Element& elem) {
+        payloadFormatter.feed(elem);
+    });
+
+    if (!found) {
+        std::ostringstream ss;
+
+        ss << "No event record " << reqIndex << " in packet " <<
+              pktIndexEntry.natIndexInDsFile() << ".";
+        throw ReqError {ss.str()};
+    }
+}
+
+void Server::_handleRegions(const _Args& args, std::string& out)
+{
+    _checkArgCount(args, 2, 4);
+
+    auto& dsf = this->_dsFileArg(args, 1);
+    const auto pktIndex = this->_pktIndexArg(dsf, args, 2);
+    const auto pktLenBits = dsf.pktIndexEntry(pktIndex).effectiveTotalLen().bits();
+    Index offsetInPktBits = 0;
+    auto endOffsetInPktBits = pktLenBits;
+
+    if (args.size() >= 4) {
+        offsetInPktBits = _uIntArg(args, 3, "offset");
+    }
+
+    if (args.size() >= 5) {
+        endOffsetInPktBits = std::min(offsetInPktBits + _uIntArg(args, 4, "length"),
+                                      pktLenBits);
+    }
+
+    if (offsetInPktBits >= endOffsetInPktBits) {
+        throw ReqError {"Empty or out of bounds packet region range."};
+    }
+
+    std::lock_guard<std::mutex> lock {_hotPkts.mutex()};
+    auto& pkt = _hotPkts.pkt(dsf, pktIndex);
+    std::vector<PktRegion::SPC> regions;
+
+    pkt.appendRegions(regions, offsetInPktBits, endOffsetInPktBits);
+
+    for (const auto& region : regions) {
+        appendRegionJsonLine(out, pkt, *region);
+    }
+}
+
+/*
+ * Reads exactly `len` bytes from `fd` into `buf`.
+ *
+ * Returns `false` if the peer closed the connection or on error.
+ */
+bool readAll(const int fd, void * const buf, const Size len)
+{
+    auto data = static_cast<std::uint8_t *>(buf);
+    Size readLen = 0;
+
+    while (readLen < len) {
+        const auto ret = ::read(fd, data + readLen, len - readLen);
+
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (ret <= 0) {
+            return false;
+        }
+
+        readLen += static_cast<Size>(ret);
+    }
+
+    return true;
+}
+
+bool writeAll(const int fd, const void * const buf, const Size len)
+{
+    auto data = static_cast<const std::uint8_t *>(buf);
+    Size writtenLen = 0;
+
+    while (writtenLen < len) {
+        // don't get `SIGPIPE` when the client is gone
+        const auto ret = ::send(fd, data + writtenLen, len - writtenLen, MSG_NOSIGNAL);
+
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (ret <= 0) {
+            return false;
+        }
+
+        writtenLen += static_cast<Size>(ret);
+    }
+
+    return true;
+}
+
+bool writeFrame(const int fd, const std::string& body)
+{
+    const auto len = static_cast<std::uint32_t>(body.size());
+    const std::uint8_t lenBuf[] = {
+        static_cast<std::uint8_t>(len),
+        static_cast<std::uint8_t>(len >> 8),
+        static_cast<std::uint8_t>(len >> 16),
+        static_cast<std::uint8_t>(len >> 24),
+    };
+
+    return writeAll(fd, lenBuf, sizeof(lenBuf)) && writeAll(fd, body.data(), body.size());
+}
+
+/*
+ * Serves the requests of the client connected to `fd` until it
+ * disconnects.
+ */
+void serveClient(Server& server, const int fd)
+{
+    while (true) {
+        std::uint8_t lenBuf[4];
+
+        if (!readAll(fd, lenBuf, sizeof(lenBuf))) {
+            return;
+        }
+
+        const Size len = static_cast<Size>(lenBuf[0]) |
+                         (static_cast<Size>(lenBuf[1]) << 8) |
+                         (static_cast<Size>(lenBuf[2]) << 16) |
+                         (static_cast<Size>(lenBuf[3]) << 24);
+
+        if (len > maxReqLen) {
+            writeFrame(fd, "error\nRequest is too large.");
+            return;
+        }
+
+        std::string req(len, '\0');
+
+        if (!readAll(fd, &req[0], len)) {
+            return;
+        }
+
+        std::string resp;
+
+        try {
+            resp = "ok\n" + server.handleReq(req);
+        } catch (const ReqError& exc) {
+            resp = std::string {"error\n"} + exc.what();
+        } catch (const std::exception& exc) {
+            // decoding or metadata error, for example
+            resp = std::string {"error\n"} + exc.what();
+        }
+
+        if (resp.size() > std::numeric_limits<std::uint32_t>::max()) {
+            resp = "error\nResponse is too large.";
+        }
+
+        if (!writeFrame(fd, resp)) {
+            return;
+        }
+    }
+}
+
+/*
+ * Creates, binds, and starts listening with a Unix domain socket at
+ * `path`, returning its file descriptor.
+ */
+int listenUnixSocket(const boost::filesystem::path& path)
+{
+    sockaddr_un addr;
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path.string().size() >= sizeof(addr.sun_path)) {
+        std::ostringstream ss;
+
+        ss << "Socket path `" << path.string() << "` is too long.";
+        throw CmdError {ss.str()};
+    }
+
+    std::strcpy(addr.sun_path, path.string().c_str());
+
+    // replace a stale socket, but nothing else
+    struct stat st;
+
+    if (::lstat(addr.sun_path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            std::ostringstream ss;
+
+            ss << "`" << path.string() << "` exists and is not a socket.";
+            throw CmdError {ss.str()};
+        }
+
+        ::unlink(addr.sun_path);
+    }
+
+    const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        throw CmdError {"Cannot create socket."};
+    }
+
+    if (::bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            ::listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+
+        std::ostringstream ss;
+
+        ss << "Cannot listen with socket `" << path.string() << "`: " <<
+              std::strerror(errno) << ".";
+        throw CmdError {ss.str()};
+    }
+
+    return fd;
+}
+
+} // namespace
+
+void serveCmd(const ServeCfg& cfg)
+{
+    DsFileSet dsFileSet {cfg.paths()};
+
+    dsFileSet.buildIndexes();
+
+    Server server {cfg, dsFileSet};
+    const auto listenFd = listenUnixSocket(cfg.socketPath());
+
+    /*
+     * Receive the stop signals through a signal file descriptor which
+     * the accept loop polls with the listening socket: a signal can't
+     * arrive between checking a flag and blocking in accept().
+     *
+     * Block them before starting any client thread, so that client
+     * threads inherit the blocked signals.
+     */
+    sigset_t stopSignals;
+    sigset_t origSignals;
+
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &origSignals);
+
+    const auto sigFd = ::signalfd(-1, &stopSignals, SFD_CLOEXEC);
+
+    if (sigFd < 0) {
+        pthread_sigmask(SIG_SETMASK, &origSignals, nullptr);
+        ::close(listenFd);
+        throw CmdError {"Cannot create signal file descriptor."};
+    }
+
+    struct Client
+    {
+        std::thread thread;
+        std::atomic<bool> isDone {false};
+    };
+
+    std::mutex clientsMutex;
+    std::set<int> clientFds;
+    std::list<Client> clients;
+
+    // joins the threads of the clients which are done
+    const auto joinDoneClients = [&clients] {
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (it->isDone) {
+                it->thread.join();
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+
+    while (true) {
+        std::array<pollfd, 2> pollFds {{{listenFd, POLLIN, 0}, {sigFd, POLLIN, 0}}};
+
+        if (::poll(pollFds.data(), pollFds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        if (pollFds[1].revents != 0) {
+            // stop signal
+            signalfd_siginfo info;
+
+            static_cast<void>(::read(sigFd, &info, sizeof(info)));
+            break;
+        }
+
+        if (pollFds[0].revents == 0) {
+            continue;
+        }
+
+        const auto fd = ::accept(listenFd, nullptr, nullptr);
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            break;
+        }
+
+        joinDoneClients();
+
+        std::lock_guard<std::mutex> lock {clientsMutex};
+
+        clientFds.insert(fd);
+        clients.emplace_back();
+
+        auto& client = clients.back();
+
+        client.thread = std::thread {[&server, &clientsMutex, &clientFds, &client, fd] {
+            serveClient(server, fd);
+
+            std::lock_guard<std::mutex> lock {clientsMutex};
+
+            clientFds.erase(fd);
+            ::close(fd);
+            client.isDone = true;
+        }};
+    }
+
+    ::close(listenFd);
+    ::unlink(cfg.socketPath().string().c_str());
+
+    {
+        // wake up the clients which are waiting for a request
+        std::lock_guard<std::mutex> lock {clientsMutex};
+
+        for (const auto fd : clientFds) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    for (auto& client : clients) {
+        client.thread.join();
+    }
+
+    ::close(sigFd);
+    pthread_sigmask(SIG_SETMASK, &origSignals, nullptr);
+}
+
+} // namespace jacques
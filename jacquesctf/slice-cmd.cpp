@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <atomic>
+#include <set>
+#include <vector>
+
+#include "cfg.hpp"
+#include "slice-cmd.hpp"
+#include "cmd-error.hpp"
+#include "ds-file-set.hpp"
+#include "file-range-copier.hpp"
+#include "lttng-index.hpp"
+#include "worker-pool.hpp"
+#include "data/trace.hpp"
+#include "data/ds-file.hpp"
+
+namespace jacques {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+bool pktOverlapsRange(const PktIndexEntry& indexEntry, const SliceCfg& cfg) noexcept
+{
+    if (!indexEntry.beginTs() || !indexEntry.endTs()) {
+        // can't tell
+        return false;
+    }
+
+    if (cfg.unit() == SliceCfg::Unit::CYCLES) {
+        const auto begin = static_cast<unsigned long long>(cfg.begin());
+        const auto end = static_cast<unsigned long long>(cfg.end());
+
+        return indexEntry.beginTs()->cycles() <= end && indexEntry.endTs()->cycles() >= begin;
+    }
+
+    return indexEntry.beginTs()->nsFromOrigin() <= cfg.end() &&
+           indexEntry.endTs()->nsFromOrigin() >= cfg.begin();
+}
+
+/*
+ * Returns the deepest common ancestor of the directories `dirs`.
+ */
+bfs::path commonAncestorDir(const std::set<bfs::path>& dirs)
+{
+    assert(!dirs.empty());
+
+    auto ancestor = *dirs.begin();
+
+    for (const auto& dir : dirs) {
+        bfs::path newAncestor;
+        auto ancestorIt = ancestor.begin();
+        auto dirIt = dir.begin();
+
+        while (ancestorIt != ancestor.end() && dirIt != dir.end() && *ancestorIt == *dirIt) {
+            newAncestor /= *ancestorIt;
+            ++ancestorIt;
+            ++dirIt;
+        }
+
+        ancestor = newAncestor;
+    }
+
+    return ancestor;
+}
+
+/*
+ * Returns `path` relative to its ancestor `ancestor`.
+ */
+bfs::path relPath(const bfs::path& path, const bfs::path& ancestor)
+{
+    bfs::path rel;
+    auto it = path.begin();
+
+    for (auto ancestorIt = ancestor.begin(); ancestorIt != ancestor.end(); ++ancestorIt) {
+        assert(it != path.end() && *it == *ancestorIt);
+        ++it;
+    }
+
+    for (; it != path.end(); ++it) {
+        rel /= *it;
+    }
+
+    return rel;
+}
+
+/*
+ * Packets of a data stream file to copy to a destination data stream
+ * file.
+ */
+struct DsFileSlice
+{
+    const DsFile *dsFile;
+    bfs::path dstPath;
+    std::vector<FileRange> ranges;
+    std::vector<LttngIndexPkt> lttngIndexPkts;
+};
+
+} // namespace
+
+void sliceCmd(const SliceCfg& cfg)
+{
+    DsFileSet dsFileSet {cfg.paths()};
+
+    dsFileSet.buildIndexes();
+
+    /*
+     * Keep the layout of the traces (for example, the `kernel` and
+     * `ust/uid/...` subdirectories of an LTTng trace) relative to
+     * their deepest common ancestor.
+     */
+    std::set<bfs::path> traceDirs;
+
+    for (const auto dsf : dsFileSet.dsFiles()) {
+        traceDirs.insert(bfs::canonical(dsf->path().parent_path()));
+    }
+
+    const auto srcRootDir = commonAncestorDir(traceDirs);
+    std::vector<DsFileSlice> slices;
+    std::set<bfs::path> slicedTraceDirs;
+
+    for (const auto dsf : dsFileSet.dsFiles()) {
+        const auto traceDir = bfs::canonical(dsf->path().parent_path());
+        DsFileSlice slice;
+
+        slice.dsFile = dsf;
+        slice.dstPath = cfg.dstDir() / relPath(traceDir, srcRootDir) / dsf->path().filename();
+
+        for (const auto& indexEntry : dsf->pktIndexEntries()) {
+            if (!pktOverlapsRange(indexEntry, cfg)) {
+                continue;
+            }
+
+            const FileRange range {
+                indexEntry.offsetInDsFileBytes(), indexEntry.effectiveTotalLen().bytes()
+            };
+
+            // packets are copied back to back
+            Index dstOffsetBytes = 0;
+
+            if (!slice.lttngIndexPkts.empty()) {
+                const auto& lastPkt = slice.lttngIndexPkts.back();
+
+                dstOffsetBytes = lastPkt.offsetInDsFileBytes +
+                                 lastPkt.pktIndexEntry->effectiveTotalLen().bytes();
+            }
+
+            appendFileRange(slice.ranges, range);
+            slice.lttngIndexPkts.push_back({&indexEntry, dstOffsetBytes});
+        }
+
+        if (slice.ranges.empty()) {
+            // nothing in this time range
+            continue;
+        }
+
+        slicedTraceDirs.insert(traceDir);
+        slices.push_back(std::move(slice));
+    }
+
+    if (slices.empty()) {
+        throw CmdError {"No packets within this time range."};
+    }
+
+    // create destination trace directories with their metadata stream
+    for (const auto& traceDir : slicedTraceDirs) {
+        const auto dstTraceDir = cfg.dstDir() / relPath(traceDir, srcRootDir);
+
+        bfs::create_directories(dstTraceDir);
+        bfs::copy_file(traceDir / "metadata", dstTraceDir / "metadata");
+    }
+
+    // copy packets and create LTTng indexes in parallel
+    std::atomic<Index> nextIndex {0};
+
+    WorkerPool {}.run([&slices, &nextIndex](Index) {
+        while (true) {
+            const auto index = nextIndex++;
+
+            if (index >= slices.size()) {
+                return;
+            }
+
+            const auto& slice = slices[index];
+            FileRangeCopier copier {slice.dstPath};
+
+            copier.copy(slice.dsFile->path(), slice.ranges);
+            copier.close();
+            writeLttngIndexFile(slice.dstPath, slice.lttngIndexPkts);
+        }
+    }, slices.size());
+}
+
+} // namespace jacques
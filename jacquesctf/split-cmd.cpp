@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "cfg.hpp"
+#include "split-cmd.hpp"
+#include "cmd-error.hpp"
+#include "file-range-copier.hpp"
+#include "lttng-index.hpp"
+#include "worker-pool.hpp"
+#include "data/trace.hpp"
+#include "data/ds-file.hpp"
+
+namespace jacques {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/*
+ * Consecutive packets of the source data stream file to copy to a
+ * destination data stream file.
+ */
+struct SplitPart
+{
+    bfs::path dstPath;
+    std::vector<FileRange> ranges;
+    std::vector<LttngIndexPkt> lttngIndexPkts;
+    Size lenBytes = 0;
+};
+
+/*
+ * Returns whether or not the packet `indexEntry` may be appended to
+ * `part` without exceeding the limits of `cfg`.
+ */
+bool pktFitsPart(const SplitPart& part, const PktIndexEntry& indexEntry, const SplitCfg& cfg)
+{
+    if (part.lttngIndexPkts.empty()) {
+        // always at least one packet, however large
+        return true;
+    }
+
+    if (cfg.maxSizeBytes() &&
+            part.lenBytes + indexEntry.effectiveTotalLen().bytes() > *cfg.maxSizeBytes()) {
+        return false;
+    }
+
+    if (cfg.maxPktCount() && part.lttngIndexPkts.size() >= *cfg.maxPktCount()) {
+        return false;
+    }
+
+    if (cfg.maxDurationNs()) {
+        const auto& firstEntry = *part.lttngIndexPkts.front().pktIndexEntry;
+
+        if (indexEntry.endTs()->nsFromOrigin() - firstEntry.beginTs()->nsFromOrigin() >
+                *cfg.maxDurationNs()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Returns the parts of `dsf`, without their destination path.
+ */
+std::vector<SplitPart> splitParts(const DsFile& dsf, const SplitCfg& cfg)
+{
+    std::vector<SplitPart> parts;
+
+    for (const auto& indexEntry : dsf.pktIndexEntries()) {
+        if (cfg.maxDurationNs() && (!indexEntry.beginTs() || !indexEntry.endTs())) {
+            std::ostringstream ss;
+
+            ss << "Cannot split by duration: packet " << indexEntry.natIndexInDsFile() <<
+                  " has no beginning or end timestamp.";
+            throw CmdError {ss.str()};
+        }
+
+        if (parts.empty() || !pktFitsPart(parts.back(), indexEntry, cfg)) {
+            parts.emplace_back();
+        }
+
+        auto& part = parts.back();
+
+        // packets are copied back to back
+        part.lttngIndexPkts.push_back({&indexEntry, part.lenBytes});
+        appendFileRange(part.ranges, {
+            indexEntry.offsetInDsFileBytes(), indexEntry.effectiveTotalLen().bytes()
+        });
+        part.lenBytes += indexEntry.effectiveTotalLen().bytes();
+    }
+
+    return parts;
+}
+
+} // namespace
+
+void splitCmd(const SplitCfg& cfg)
+{
+    Trace trace {{cfg.srcPath()}};
+    auto& dsf = *trace.dsFiles().front();
+
+    dsf.buildIndex();
+
+    if (dsf.pktCount() == 0) {
+        throw CmdError {"File is empty."};
+    }
+
+    auto parts = splitParts(dsf, cfg);
+
+    /*
+     * Name the destination data stream files `NAME-N`, N being the
+     * natural index of the part, padded so that they sort naturally.
+     */
+    const auto indexWidth = static_cast<int>(std::to_string(parts.size()).size());
+
+    for (Index i = 0; i < parts.size(); ++i) {
+        std::ostringstream ss;
+
+        ss << cfg.srcPath().filename().string() << '-' << std::setfill('0') <<
+              std::setw(indexWidth) << i + 1;
+        parts[i].dstPath = cfg.dstDir() / ss.str();
+    }
+
+    // keep a readable trace when the source has a metadata stream
+    const auto metadataPath = cfg.srcPath().parent_path() / "metadata";
+
+    bfs::create_directories(cfg.dstDir());
+
+    if (bfs::is_regular_file(metadataPath)) {
+        bfs::copy_file(metadataPath, cfg.dstDir() / "metadata");
+    }
+
+    // copy packets and create LTTng indexes in parallel
+    std::atomic<Index> nextIndex {0};
+
+    WorkerPool {}.run([&cfg, &parts, &nextIndex](Index) {
+        while (true) {
+            const auto index = nextIndex++;
+
+            if (index >= parts.size()) {
+                return;
+            }
+
+            const auto& part = parts[index];
+            FileRangeCopier copier {part.dstPath};
+
+            copier.copy(cfg.srcPath(), part.ranges);
+            copier.close();
+            assert(copier.dstLenBytes() == part.lenBytes);
+            writeLttngIndexFile(part.dstPath, part.lttngIndexPkts);
+        }
+    }, parts.size());
+}
+
+} // namespace jacques
@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_SPLIT_CMD_HPP
+#define _JACQUES_SPLIT_CMD_HPP
+
+#include "cfg.hpp"
+
+namespace jacques {
+
+void splitCmd(const SplitCfg& cfg);
+
+} // namespace jacques
+
+#endif // _JACQUES_SPLIT_CMD_HPP
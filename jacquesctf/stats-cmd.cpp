@@ -0,0 +1,487 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cfg.hpp"
+#include "stats-cmd.hpp"
+#include "ds-file-set.hpp"
+#include "worker-pool.hpp"
+#include "utils.hpp"
+#include "data/trace.hpp"
+#include "data/ds-file.hpp"
+#include "data/pkt-decoder.hpp"
+
+namespace jacques {
+namespace {
+
+struct ErtStats
+{
+    Size count = 0;
+    Size totalSizeBits = 0;
+    Size maxSizeBits = 0;
+
+    void add(const ErtStats& other) noexcept
+    {
+        count += other.count;
+        totalSizeBits += other.totalSizeBits;
+        maxSizeBits = std::max(maxSizeBits, other.maxSizeBits);
+    }
+};
+
+// `nullptr` key: event records of which the type is unknown
+using ErtStatsTable = std::unordered_map<const yactfr::EventRecordType *, ErtStats>;
+
+/*
+ * Statistics of a data stream file or of a trace.
+ */
+struct ScopeStats
+{
+    bool isTrace;
+    std::string path;
+    Size dsFileCount = 0;
+    Size pktCount = 0;
+    Size sampledPktCount = 0;
+    ErtStatsTable table;
+    boost::optional<long long> beginNsFromOrigin;
+    boost::optional<long long> endNsFromOrigin;
+
+    void addTimeRange(const boost::optional<long long>& beginNs,
+                      const boost::optional<long long>& endNs)
+    {
+        if (beginNs) {
+            beginNsFromOrigin = beginNsFromOrigin ? std::min(*beginNsFromOrigin, *beginNs) :
+                                *beginNs;
+        }
+
+        if (endNs) {
+            endNsFromOrigin = endNsFromOrigin ? std::max(*endNsFromOrigin, *endNs) : *endNs;
+        }
+    }
+
+    // time span in seconds, or 0 if unknown
+    double spanS() const noexcept
+    {
+        if (!beginNsFromOrigin || !endNsFromOrigin ||
+                *endNsFromOrigin <= *beginNsFromOrigin) {
+            return 0.;
+        }
+
+        return static_cast<double>(*endNsFromOrigin - *beginNsFromOrigin) / 1e9;
+    }
+};
+
+/*
+ * Decodes the packets of `dsFiles` (one out of `sampleStep` of each
+ * data stream file) in parallel and returns one event record type
+ * statistics table per data stream file.
+ *
+ * Each worker aggregates into its own tables, which this function
+ * merges at the end, so that the workers never share a table.
+ *
+ * Appends to `errorMsgs`, in packet order, an error message for each
+ * packet which can't be fully decoded (its event records up to the
+ * error are still counted).
+ */
+std::vector<ErtStatsTable> decodeErtStats(const std::vector<DsFile *>& dsFiles,
+                                          const Size sampleStep,
+                                          std::vector<std::string>& errorMsgs)
+{
+    struct Unit
+    {
+        Index dsFileIndex;
+        const PktIndexEntry *pktIndexEntry;
+    };
+
+    std::vector<Unit> units;
+
+    for (Index dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+        const auto& entries = dsFiles[dsFileIndex]->pktIndexEntries();
+
+        for (Index pktIndex = 0; pktIndex < entries.size(); pktIndex += sampleStep) {
+            units.push_back({dsFileIndex, &entries[pktIndex]});
+        }
+    }
+
+    std::vector<ErtStatsTable> tables(dsFiles.size());
+
+    // unit index and message of each decoding error
+    std::vector<std::pair<Index, std::string>> errors;
+    std::mutex tablesMutex;
+    std::atomic<Index> nextUnitIndex {0};
+
+    WorkerPool {}.run([&](Index) {
+        /*
+         * Units are ordered by data stream file, so a worker mostly
+         * gets consecutive packets of the same data stream file: only
+         * keep the decoder of the current one.
+         */
+        std::unique_ptr<PktDecoder> decoder;
+        std::vector<ErtStatsTable> workerTables(dsFiles.size());
+        std::vector<std::pair<Index, std::string>> workerErrors;
+
+        while (true) {
+            const auto unitIndex = nextUnitIndex++;
+
+            if (unitIndex >= units.size()) {
+                break;
+            }
+
+            const auto& unit = units[unitIndex];
+            const auto& dsf = *dsFiles[unit.dsFileIndex];
+            auto& table = workerTables[unit.dsFileIndex];
+
+            if (!decoder || &decoder->dsFile() != &dsf) {
+                decoder = std::make_unique<PktDecoder>(dsf);
+            }
+
+            decoder->forEachEr(*unit.pktIndexEntry, [&table](const Er& er) {
+                auto& stats = table[er.type()];
+                const auto sizeBits = er.segment().len() ? er.segment().len()->bits() : 0;
+
+                ++stats.count;
+                stats.totalSizeBits += sizeBits;
+                stats.maxSizeBits = std::max(stats.maxSizeBits, sizeBits);
+                return true;
+            });
+
+            if (const auto& error = decoder->lastDecodingError()) {
+                std::ostringstream ss;
+
+                ss << "Cannot decode packet " << unit.pktIndexEntry->natIndexInDsFile() <<
+                      " of data stream file `" << dsf.path().string() << "` at offset " <<
+                      error->offset() << " bits: " << error->reason();
+                workerErrors.emplace_back(unitIndex, ss.str());
+            }
+        }
+
+        // merge
+        std::lock_guard<std::mutex> lock {tablesMutex};
+
+        for (Index dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+            for (const auto& ertStatsPair : workerTables[dsFileIndex]) {
+                tables[dsFileIndex][ertStatsPair.first].add(ertStatsPair.second);
+            }
+        }
+
+        std::move(workerErrors.begin(), workerErrors.end(), std::back_inserter(errors));
+    }, units.size());
+
+    std::sort(errors.begin(), errors.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    for (auto& error : errors) {
+        errorMsgs.push_back(std::move(error.second));
+    }
+
+    return tables;
+}
+
+/*
+ * Extrapolates the statistics of `table`, which come from
+ * `sampledPktCount` packets out of `pktCount`.
+ *
+ * Maximum sizes stay the observed ones.
+ */
+void extrapolate(ErtStatsTable& table, const Size pktCount, const Size sampledPktCount)
+{
+    if (sampledPktCount == 0 || sampledPktCount == pktCount) {
+        return;
+    }
+
+    const auto factor = static_cast<double>(pktCount) / static_cast<double>(sampledPktCount);
+
+    for (auto& ertStatsPair : table) {
+        auto& stats = ertStatsPair.second;
+
+        const auto scale = [factor](const Size val) {
+            return static_cast<Size>(std::llround(static_cast<double>(val) * factor));
+        };
+
+        stats.count = scale(stats.count);
+        stats.totalSizeBits = scale(stats.totalSizeBits);
+    }
+}
+
+std::string fmtDouble(const double val, const char * const fmt = "%.3f")
+{
+    char buf[64];
+
+    std::snprintf(buf, sizeof(buf), fmt, val);
+    return buf;
+}
+
+std::vector<std::string> statsRow(const std::string& ertId, const std::string& ertName,
+                                  const ErtStats& stats, const double spanS, const bool forText)
+{
+    std::vector<std::string> row {ertId, ertName};
+
+    if (forText) {
+        const auto totalSize = utils::formatLen(stats.totalSizeBits);
+
+        row.push_back(utils::sepNumber(stats.count, ','));
+        row.push_back(totalSize.first + " " + totalSize.second);
+    } else {
+        row.push_back(std::to_string(stats.count));
+        row.push_back(fmtDouble(static_cast<double>(stats.totalSizeBits) / 8, "%.1f"));
+    }
+
+    if (stats.count > 0) {
+        row.push_back(fmtDouble(static_cast<double>(stats.totalSizeBits) / 8 /
+                                static_cast<double>(stats.count), "%.1f"));
+    } else {
+        row.push_back("");
+    }
+
+    row.push_back(fmtDouble(static_cast<double>(stats.maxSizeBits) / 8, "%.1f"));
+
+    if (spanS > 0.) {
+        row.push_back(fmtDouble(static_cast<double>(stats.count) / spanS));
+    } else {
+        row.push_back("");
+    }
+
+    return row;
+}
+
+/*
+ * Returns the rows of `scopeStats`: one per event record type, sorted
+ * by type ID, followed with the total.
+ */
+std::vector<std::vector<std::string>> scopeRows(const ScopeStats& scopeStats, const bool forText)
+{
+    std::vector<std::pair<const yactfr::EventRecordType *, const ErtStats *>> sorted;
+    ErtStats total;
+
+    for (const auto& ertStatsPair : scopeStats.table) {
+        sorted.push_back({ertStatsPair.first, &ertStatsPair.second});
+        total.add(ertStatsPair.second);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        if (!a.first || !b.first) {
+            // unknown type last
+            return a.first && !b.first;
+        }
+
+        return a.first->id() < b.first->id();
+    });
+
+    std::vector<std::vector<std::string>> rows;
+    const auto spanS = scopeStats.spanS();
+
+    for (const auto& ertStatsPair : sorted) {
+        const auto ert = ertStatsPair.first;
+        std::string id;
+        std::string name;
+
+        if (ert) {
+            id = std::to_string(ert->id());
+
+            if (ert->name()) {
+                name = *ert->name();
+            }
+        } else if (forText) {
+            name = "(unknown)";
+        }
+
+        rows.push_back(statsRow(id, name, *ertStatsPair.second, spanS, forText));
+    }
+
+    rows.push_back(statsRow("", forText ? "(total)" : "", total, spanS, forText));
+    return rows;
+}
+
+void printText(const std::vector<ScopeStats>& scopes, const bool isSampled)
+{
+    const std::vector<std::string> header {
+        "ID", "Name", "Count", "Total size", "Mean size (B)", "Max size (B)", "Rate (ER/s)"
+    };
+
+    for (const auto& scopeStats : scopes) {
+        std::cout << (scopeStats.isTrace ? "Trace" : "Data stream file") << " `" <<
+                     scopeStats.path << "`";
+
+        if (scopeStats.isTrace) {
+            std::cout << " (" << scopeStats.dsFileCount << " data stream files)";
+        }
+
+        std::cout << ": " << scopeStats.pktCount << " packets";
+
+        if (isSampled) {
+            std::cout << " (" << scopeStats.sampledPktCount << " sampled)";
+        }
+
+        const auto spanS = scopeStats.spanS();
+
+        if (spanS > 0.) {
+            std::cout << ", " << fmtDouble(spanS, "%.9f") << " s";
+        }
+
+        std::cout << "\n\n";
+
+        auto rows = scopeRows(scopeStats, true);
+
+        rows.insert(rows.begin(), header);
+
+        std::vector<Size> widths(header.size(), 0);
+
+        for (const auto& row : rows) {
+            for (Index col = 0; col < row.size(); ++col) {
+                widths[col] = std::max(widths[col], static_cast<Size>(row[col].size()));
+            }
+        }
+
+        for (const auto& row : rows) {
+            std::cout << " ";
+
+            for (Index col = 0; col < row.size(); ++col) {
+                const auto pad = std::string(widths[col] - row[col].size(), ' ');
+
+                // names are left-aligned, numbers are right-aligned
+                std::cout << " " << (col == 1 ? row[col] + pad : pad + row[col]);
+            }
+
+            std::cout << '\n';
+        }
+
+        std::cout << '\n';
+    }
+
+    std::cout.flush();
+}
+
+void printCsv(const std::vector<ScopeStats>& scopes)
+{
+    std::string out = "Scope,Path,Event record type ID,Event record type name,Count,"
+                      "Total size (bytes),Mean size (bytes),Max size (bytes),"
+                      "Rate (event records/s)\n";
+
+    for (const auto& scopeStats : scopes) {
+        for (const auto& row : scopeRows(scopeStats, false)) {
+            out += scopeStats.isTrace ? "trace," : "data stream file,";
+            utils::appendCsvField(out, scopeStats.path);
+
+            for (const auto& field : row) {
+                out += ',';
+                utils::appendCsvField(out, field);
+            }
+
+            out += '\n';
+        }
+    }
+
+    std::cout << out;
+    std::cout.flush();
+}
+
+} // namespace
+
+bool statsCmd(const StatsCfg& cfg)
+{
+    DsFileSet dsFileSet {cfg.paths()};
+
+    dsFileSet.buildIndexes();
+
+    const auto& dsFiles = dsFileSet.dsFiles();
+    std::vector<std::string> errorMsgs;
+    auto tables = decodeErtStats(dsFiles, cfg.sampleStep(), errorMsgs);
+
+    /*
+     * Data stream file scopes, each one followed with its trace scope
+     * once all the data stream files of this trace are done (the data
+     * stream files of a given trace are contiguous).
+     */
+    std::vector<ScopeStats> scopes;
+    boost::optional<ScopeStats> traceScope;
+    const Trace *curTrace = nullptr;
+
+    for (Index dsFileIndex = 0; dsFileIndex < dsFiles.size(); ++dsFileIndex) {
+        const auto& dsf = *dsFiles[dsFileIndex];
+
+        if (&dsf.trace() != curTrace) {
+            if (traceScope) {
+                scopes.push_back(std::move(*traceScope));
+            }
+
+            curTrace = &dsf.trace();
+            traceScope = ScopeStats {};
+            traceScope->isTrace = true;
+            traceScope->path = dsf.path().parent_path().string();
+        }
+
+        ScopeStats scopeStats;
+
+        scopeStats.isTrace = false;
+        scopeStats.path = dsf.path().string();
+        scopeStats.dsFileCount = 1;
+        scopeStats.pktCount = dsf.pktCount();
+        scopeStats.sampledPktCount = (dsf.pktCount() + cfg.sampleStep() - 1) / cfg.sampleStep();
+        scopeStats.table = std::move(tables[dsFileIndex]);
+        extrapolate(scopeStats.table, scopeStats.pktCount, scopeStats.sampledPktCount);
+
+        for (const auto& indexEntry : dsf.pktIndexEntries()) {
+            boost::optional<long long> beginNs, endNs;
+
+            if (indexEntry.beginTs()) {
+                beginNs = indexEntry.beginTs()->nsFromOrigin();
+            }
+
+            if (indexEntry.endTs()) {
+                endNs = indexEntry.endTs()->nsFromOrigin();
+            }
+
+            scopeStats.addTimeRange(beginNs, endNs);
+        }
+
+        ++traceScope->dsFileCount;
+        traceScope->pktCount += scopeStats.pktCount;
+        traceScope->sampledPktCount += scopeStats.sampledPktCount;
+        traceScope->addTimeRange(scopeStats.beginNsFromOrigin, scopeStats.endNsFromOrigin);
+
+        for (const auto& ertStatsPair : scopeStats.table) {
+            traceScope->table[ertStatsPair.first].add(ertStatsPair.second);
+        }
+
+        scopes.push_back(std::move(scopeStats));
+    }
+
+    if (traceScope) {
+        scopes.push_back(std::move(*traceScope));
+    }
+
+    if (cfg.format() == StatsCfg::Fmt::CSV) {
+        printCsv(scopes);
+    } else {
+        printText(scopes, cfg.sampleStep() > 1);
+    }
+
+    std::cout.flush();
+
+    for (const auto& errorMsg : errorMsgs) {
+        utils::error() << errorMsg << std::endl;
+    }
+
+    return errorMsgs.empty();
+}
+
+} // namespace jacques
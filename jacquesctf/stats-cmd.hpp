@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_STATS_CMD_HPP
+#define _JACQUES_STATS_CMD_HPP
+
+#include "cfg.hpp"
+
+namespace jacques {
+
+/*
+ * Returns `false` if a decoded packet couldn't be fully decoded.
+ */
+bool statsCmd(const StatsCfg& cfg);
+
+} // namespace jacques
+
+#endif // _JACQUES_STATS_CMD_HPP
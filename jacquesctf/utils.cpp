@@ -5,6 +5,7 @@
  * prohibited. Proprietary and confidential.
  */
 
+#include <cmath>
 #include <cstring>
 #include <cstdio>
 #include <array>
@@ -17,6 +18,7 @@
 
 #include "utils.hpp"
 #include "cfg.hpp"
+#include "data/ts.hpp"
 
 namespace jacques {
 namespace utils {
@@ -451,6 +453,137 @@ std::string escapeStr(const std::string& str)
     return outStr;
 }
 
+void appendUInt(std::string& out, unsigned long long val)
+{
+    char buf[24];
+    auto it = std::end(buf);
+
+    do {
+        --it;
+        *it = static_cast<char>('0' + val % 10);
+        val /= 10;
+    } while (val != 0);
+
+    out.append(it, std::end(buf));
+}
+
+void appendInt(std::string& out, const long long val)
+{
+    if (val < 0) {
+        out += '-';
+
+        // avoid overflowing with the lowest value
+        appendUInt(out, 0ULL - static_cast<unsigned long long>(val));
+        return;
+    }
+
+    appendUInt(out, static_cast<unsigned long long>(val));
+}
+
+void appendJsonStrContent(std::string& out, const char * const begin, const char * const end)
+{
+    for (auto it = begin; it != end; ++it) {
+        const auto ch = *it;
+
+        switch (ch) {
+        case '"':
+            out += "\\\"";
+            break;
+
+        case '\\':
+            out += "\\\\";
+            break;
+
+        case '\n':
+            out += "\\n";
+            break;
+
+        case '\r':
+            out += "\\r";
+            break;
+
+        case '\t':
+            out += "\\t";
+            break;
+
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                char buf[8];
+
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(ch));
+                out += buf;
+            } else {
+                out += ch;
+            }
+
+            break;
+        }
+    }
+}
+
+void appendJsonStr(std::string& out, const std::string& str)
+{
+    out += '"';
+    appendJsonStrContent(out, str.data(), str.data() + str.size());
+    out += '"';
+}
+
+void appendJsonDouble(std::string& out, const double val)
+{
+    if (!std::isfinite(val)) {
+        out += "null";
+        return;
+    }
+
+    char buf[32];
+
+    std::snprintf(buf, sizeof(buf), "%.17g", val);
+    out += buf;
+}
+
+void appendJsonTs(std::string& out, const char * const key, const boost::optional<Ts>& ts)
+{
+    out += ",\"";
+    out += key;
+    out += "-cycles\":";
+
+    if (ts) {
+        appendUInt(out, ts->cycles());
+    } else {
+        out += "null";
+    }
+
+    out += ",\"";
+    out += key;
+    out += "-ns\":";
+
+    if (ts) {
+        appendInt(out, ts->nsFromOrigin());
+    } else {
+        out += "null";
+    }
+}
+
+void appendCsvField(std::string& out, const std::string& str)
+{
+    if (str.find_first_of(",\"\r\n") == std::string::npos) {
+        out += str;
+        return;
+    }
+
+    out += '"';
+
+    for (const auto ch : str) {
+        if (ch == '"') {
+            out += '"';
+        }
+
+        out += ch;
+    }
+
+    out += '"';
+}
+
 bool isHiddenFile(const bfs::path& path)
 {
     return !path.filename().string().empty() && path.filename().string()[0] == '.';
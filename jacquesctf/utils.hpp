@@ -25,6 +25,9 @@
 #include "cfg.hpp"
 
 namespace jacques {
+
+class Ts;
+
 namespace utils {
 
 /*
@@ -78,6 +81,61 @@ std::string escapeStr(const std::string& str);
 std::string sepNumber(long long val, char sep = ' ');
 std::string sepNumber(unsigned long long val, char sep = ' ');
 
+/*
+ * Appends the decimal representation of `val` to `out`, without going
+ * through a stream or a locale.
+ */
+void appendUInt(std::string& out, unsigned long long val);
+void appendInt(std::string& out, long long val);
+
+/*
+ * Appends the JSON-escaped characters of [`begin`, `end`[ to `out`,
+ * without quotes.
+ */
+void appendJsonStrContent(std::string& out, const char *begin, const char *end);
+
+/*
+ * Appends `str` to `out` as a JSON string (escaped, with quotes).
+ */
+void appendJsonStr(std::string& out, const std::string& str);
+
+/*
+ * Appends `val` to `out` as a JSON number, or `null` if `val` is not
+ * finite (not representable).
+ */
+void appendJsonDouble(std::string& out, double val);
+
+/*
+ * Appends `,"KEY":VAL` to `out`, where KEY is `key` and VAL is `*val`,
+ * or `null` if `val` is not set.
+ */
+template <typename ValT>
+void appendJsonOptUInt(std::string& out, const char * const key,
+                       const boost::optional<ValT>& val)
+{
+    out += ",\"";
+    out += key;
+    out += "\":";
+
+    if (val) {
+        appendUInt(out, *val);
+    } else {
+        out += "null";
+    }
+}
+
+/*
+ * Appends `,"KEY-cycles":CYCLES,"KEY-ns":NS` to `out`, where KEY is
+ * `key`, and CYCLES and NS are the cycles and nanoseconds from origin
+ * of `*ts`, or `null` if `ts` is not set.
+ */
+void appendJsonTs(std::string& out, const char *key, const boost::optional<Ts>& ts);
+
+/*
+ * Appends `str` to `out` as a CSV field, quoting it only if needed.
+ */
+void appendCsvField(std::string& out, const std::string& str);
+
 /*
  * Returns whether or not the path `path` identifies a hidden
  * file/directory.
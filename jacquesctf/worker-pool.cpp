@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#include <cassert>
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "worker-pool.hpp"
+
+namespace jacques {
+
+WorkerPool::WorkerPool(const Size workerCount) :
+    _workerCount {workerCount == 0 ? WorkerPool::defaultWorkerCount() : workerCount}
+{
+}
+
+Size WorkerPool::defaultWorkerCount() noexcept
+{
+    const auto count = std::thread::hardware_concurrency();
+
+    // std::thread::hardware_concurrency() may return 0 if unknown
+    return count == 0 ? 1 : static_cast<Size>(count);
+}
+
+void WorkerPool::run(const WorkFunc& func) const
+{
+    this->run(func, _workerCount);
+}
+
+void WorkerPool::run(const WorkFunc& func, const Size maxWorkerCount) const
+{
+    const auto workerCount = std::max(std::min(_workerCount, maxWorkerCount), 1ULL);
+
+    if (workerCount == 1) {
+        // no need for another thread
+        func(0);
+        return;
+    }
+
+    std::exception_ptr exc;
+    std::mutex excMutex;
+    std::vector<std::thread> threads;
+
+    threads.reserve(workerCount);
+
+    for (Index workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+        threads.emplace_back([&func, &exc, &excMutex, workerIndex] {
+            try {
+                func(workerIndex);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock {excMutex};
+
+                if (!exc) {
+                    exc = std::current_exception();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (exc) {
+        std::rethrow_exception(exc);
+    }
+}
+
+} // namespace jacques
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2019 Philippe Proulx <eepp.ca> - All Rights Reserved
+ *
+ * Unauthorized copying of this file, via any medium, is strictly
+ * prohibited. Proprietary and confidential.
+ */
+
+#ifndef _JACQUES_WORKER_POOL_HPP
+#define _JACQUES_WORKER_POOL_HPP
+
+#include <functional>
+#include <boost/core/noncopyable.hpp>
+
+#include "aliases.hpp"
+
+namespace jacques {
+
+/*
+ * A pool of worker threads.
+ *
+ * WorkerPool::run() starts the workers, each one calling the given
+ * function with its own worker index, and waits for all of them to
+ * finish. If any worker throws, WorkerPool::run() rethrows the first
+ * caught exception once all the workers are done.
+ *
+ * The work distribution is up to the caller: a common pattern is to
+ * share an atomic "next item index" counter between the workers.
+ */
+class WorkerPool final :
+    boost::noncopyable
+{
+public:
+    using WorkFunc = std::function<void (Index)>;
+
+public:
+    /*
+     * Builds a worker pool of `workerCount` workers, or of as many
+     * workers as there are hardware threads if `workerCount` is 0.
+     */
+    explicit WorkerPool(Size workerCount = 0);
+
+    void run(const WorkFunc& func) const;
+
+    /*
+     * Like run(), but starts at most `maxWorkerCount` workers (at
+     * least one).
+     */
+    void run(const WorkFunc& func, Size maxWorkerCount) const;
+
+    Size workerCount() const noexcept
+    {
+        return _workerCount;
+    }
+
+    static Size defaultWorkerCount() noexcept;
+
+private:
+    Size _workerCount;
+};
+
+} // namespace jacques
+
+#endif // _JACQUES_WORKER_POOL_HPP